@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Parallel layout benchmark - frame time vs layout threads
+ *
+ * Builds BENCH_SURFACES independent surfaces (an operator console of
+ * panes), each holding rows of bordered containers with text, and forces
+ * every surface to lay out each frame via cel_clay_layout_invalidate().
+ * The mean frame time is printed for 1, 2, 4, 8 and 16 layout threads
+ * together with the speedup over one thread.
+ *
+ * Build with CELS_CLAY_PARALLEL_LAYOUT=ON; otherwise every row reports
+ * serial timings. Headless: only Clay_Engine is registered.
+ */
+
+/* clock_gettime under strict -std */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <cels/cels.h>
+#include <cels-clay/clay_engine.h>
+#include <cels-clay/clay_layout.h>
+#include <cels-clay/clay_primitives.h>
+#include <flecs.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_SURFACES 16
+#define BENCH_ROWS 200
+#define BENCH_FRAMES 100
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static ecs_entity_t add_container(ecs_world_t* world, ecs_entity_t parent,
+                                  Clay_LayoutDirection direction) {
+    ecs_entity_t e = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_set_id(world, e, ClayContainerConfig_id, sizeof(ClayContainerConfig),
+               &(ClayContainerConfig){
+                   .direction = direction,
+                   .width = CLAY_SIZING_GROW(0),
+                   .gap = 1
+               });
+    return e;
+}
+
+static void add_text(ecs_world_t* world, ecs_entity_t parent, const char* text) {
+    ecs_entity_t e = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_set_id(world, e, ClayTextConfig_id, sizeof(ClayTextConfig),
+               &(ClayTextConfig){
+                   .text = text,
+                   .color = {200, 200, 200, 255},
+                   .font_size = 16,
+                   .wrap = CLAY_TEXT_WRAP_WORDS
+               });
+}
+
+static void build_surface(ecs_world_t* world) {
+    ecs_entity_t surface = ecs_new(world);
+    ecs_set_id(world, surface, ClaySurfaceConfig_id, sizeof(ClaySurfaceConfig),
+               &(ClaySurfaceConfig){ .width = 160.0f, .height = 50.0f });
+
+    ecs_entity_t column = add_container(world, surface, CLAY_TOP_TO_BOTTOM);
+    for (int r = 0; r < BENCH_ROWS; r++) {
+        ecs_entity_t row = add_container(world, column, CLAY_LEFT_TO_RIGHT);
+        add_text(world, row, "node-17");
+        add_text(world, row, "cpu 42% mem 1.3G");
+        add_text(world, row, "healthy: last probe answered in 3ms, no restarts");
+    }
+}
+
+static void run_bench(void) {
+    ecs_world_t* world = cels_get_world(cels_get_context());
+
+    for (int s = 0; s < BENCH_SURFACES; s++) {
+        build_surface(world);
+    }
+    cels_step(0);  /* Absorb the construction */
+
+    printf("%8s %14s %10s %12s\n", "threads", "frame_us", "speedup", "passes");
+
+    double serial_us = 0.0;
+    for (uint32_t threads = 1; threads <= 16; threads *= 2) {
+        cel_clay_set_layout_threads(threads);
+
+        /* Warm up (starts the workers) */
+        cel_clay_layout_invalidate();
+        cels_step(0);
+
+        ClayLayoutStats before = cel_clay_get_layout_stats();
+        double t0 = now_seconds();
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            cel_clay_layout_invalidate();
+            cels_step(0);
+        }
+        double frame_us = (now_seconds() - t0) * 1e6 / BENCH_FRAMES;
+        ClayLayoutStats after = cel_clay_get_layout_stats();
+
+        if (threads == 1) serial_us = frame_us;
+        printf("%8u %14.2f %9.2fx %12llu\n", cel_clay_get_layout_threads(),
+               frame_us, serial_us / frame_us,
+               (unsigned long long)(after.passes_executed - before.passes_executed));
+    }
+}
+
+CEL_Compose(BenchApp) {
+}
+
+cels_main() {
+    cels_register(Clay_Engine);
+
+    cels_session(BenchApp) {
+        run_bench();
+    }
+}
@@ -0,0 +1,345 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Layout benchmark suite - cels-clay-bench
+ *
+ * Builds synthetic trees of row, column, text and spacer entities and runs
+ * a full frame on each for a fixed number of frames (every frame forced
+ * through layout with cel_clay_layout_invalidate()):
+ *
+ *   deep       A chain of 200 nested columns, one text per level
+ *   wide       One column of 50,000 text siblings
+ *   text       1,000 wrapped paragraphs of 100 words (100,000 words)
+ *   dashboard  Header, sidebar menu, card grid, log panel and footer
+ *
+ * Each frame's walk (tree walk + root close), Clay layout (EndLayout) and
+ * dispatch come from the frame profiler, which this target always
+ * compiles in (CELS_CLAY_PROFILE). Every frame's commands are also drawn
+ * onto a headless cell grid, timed here.
+ *
+ * Output: a table on stderr and one JSON object per suite on stdout
+ * (JSON lines), keyed by suite and cels-clay version, for tracking
+ * regressions across versions:
+ *
+ *   {"bench":"cels-clay","version":"0.6.0","suite":"deep","elements":400,
+ *    "frames":200,"fps":...,"frame_p50_us":...,"frame_p99_us":...,
+ *    "walk_ns_per_element":...,"layout_ns_per_element":...,
+ *    "dispatch_ns_per_element":...,"render_ns_per_element":...}
+ *
+ * Trees are built with raw flecs calls on the components behind
+ * ClayRow / ClayColumn / ClayText / ClaySpacer, so construction stays out
+ * of the measured frames.
+ */
+
+/* clock_gettime under strict -std */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <cels/cels.h>
+#include <cels-clay/clay_engine.h>
+#include <cels-clay/clay_layout.h>
+#include <cels-clay/clay_primitives.h>
+#include <cels-clay/clay_render.h>
+#include <cels-clay/clay_headless_renderer.h>
+#include <cels-clay/clay_profile.h>
+#include <flecs.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef CELS_CLAY_PROFILE
+#error "cels-clay-bench needs CELS_CLAY_PROFILE (its CMake target defines it)"
+#endif
+
+#ifndef CELS_CLAY_VERSION
+#define CELS_CLAY_VERSION "unknown"
+#endif
+
+#define BENCH_FRAMES 200   /* Within CEL_CLAY_PROFILE_HISTORY */
+#define BENCH_WARMUP 3
+#define BENCH_COLUMNS 200
+#define BENCH_ROWS 60
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* ============================================================================
+ * Tree Builders
+ * ============================================================================ */
+
+static ecs_world_t* g_world;
+static int32_t g_elements;
+
+static ecs_entity_t add_container(ecs_entity_t parent, Clay_LayoutDirection direction,
+                                  Clay_SizingAxis width, Clay_SizingAxis height) {
+    ecs_entity_t e = ecs_new_w_pair(g_world, EcsChildOf, parent);
+    ecs_set_id(g_world, e, ClayContainerConfig_id, sizeof(ClayContainerConfig),
+               &(ClayContainerConfig){
+                   .direction = direction,
+                   .width = width,
+                   .height = height
+               });
+    g_elements++;
+    return e;
+}
+
+static ecs_entity_t add_row(ecs_entity_t parent) {
+    return add_container(parent, CLAY_LEFT_TO_RIGHT, CLAY_SIZING_GROW(0), (Clay_SizingAxis){0});
+}
+
+static ecs_entity_t add_column(ecs_entity_t parent) {
+    return add_container(parent, CLAY_TOP_TO_BOTTOM, CLAY_SIZING_GROW(0), (Clay_SizingAxis){0});
+}
+
+static void add_text(ecs_entity_t parent, const char* text, Clay_TextElementConfigWrapMode wrap) {
+    ecs_entity_t e = ecs_new_w_pair(g_world, EcsChildOf, parent);
+    ecs_set_id(g_world, e, ClayTextConfig_id, sizeof(ClayTextConfig),
+               &(ClayTextConfig){
+                   .text = text,
+                   .stable = true,
+                   .color = {200, 200, 200, 255},
+                   .font_size = 16,
+                   .wrap = wrap
+               });
+    g_elements++;
+}
+
+static void add_spacer(ecs_entity_t parent) {
+    ecs_entity_t e = ecs_new_w_pair(g_world, EcsChildOf, parent);
+    ecs_set_id(g_world, e, ClaySpacerConfig_id, sizeof(ClaySpacerConfig),
+               &(ClaySpacerConfig){0});
+    g_elements++;
+}
+
+static void build_deep(ecs_entity_t surface) {
+    ecs_entity_t parent = surface;
+    for (int d = 0; d < 200; d++) {
+        parent = add_column(parent);
+        add_text(parent, "level", CLAY_TEXT_WRAP_NONE);
+    }
+}
+
+static void build_wide(ecs_entity_t surface) {
+    ecs_entity_t column = add_column(surface);
+    for (int i = 0; i < 50000; i++) {
+        add_text(column, "sibling row", CLAY_TEXT_WRAP_NONE);
+    }
+}
+
+/* 100 words per paragraph from a small vocabulary; the paragraphs differ
+ * by rotation so word measurement still sees varied text */
+static char* g_paragraphs;
+
+static void build_text(ecs_entity_t surface) {
+    static const char* words[] = {
+        "layout", "entity", "surface", "render", "command", "measure",
+        "column", "row", "spacer", "frame", "cell", "terminal", "widget"
+    };
+    const int vocab = (int)(sizeof(words) / sizeof(words[0]));
+    const size_t stride = 100 * 10;
+
+    g_paragraphs = (char*)malloc(stride * 1000);
+    if (!g_paragraphs) return;
+
+    ecs_entity_t column = add_column(surface);
+    for (int p = 0; p < 1000; p++) {
+        char* out = g_paragraphs + stride * (size_t)p;
+        size_t len = 0;
+        for (int w = 0; w < 100; w++) {
+            const char* word = words[(p + w * 7) % vocab];
+            size_t n = strlen(word);
+            if (w > 0) out[len++] = ' ';
+            memcpy(out + len, word, n);
+            len += n;
+        }
+        out[len] = '\0';
+        add_text(column, out, CLAY_TEXT_WRAP_WORDS);
+    }
+}
+
+static void build_dashboard(ecs_entity_t surface) {
+    ecs_entity_t root = add_column(surface);
+
+    ecs_entity_t header = add_row(root);
+    add_text(header, "cels-clay dashboard", CLAY_TEXT_WRAP_NONE);
+    add_spacer(header);
+    add_text(header, "12:00:00", CLAY_TEXT_WRAP_NONE);
+
+    ecs_entity_t body = add_container(root, CLAY_LEFT_TO_RIGHT,
+                                      CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0));
+
+    ecs_entity_t sidebar = add_container(body, CLAY_TOP_TO_BOTTOM,
+                                         CLAY_SIZING_FIXED(24), CLAY_SIZING_GROW(0));
+    for (int i = 0; i < 30; i++) add_text(sidebar, "menu item", CLAY_TEXT_WRAP_NONE);
+    add_spacer(sidebar);
+
+    ecs_entity_t main_area = add_column(body);
+    for (int r = 0; r < 3; r++) {
+        ecs_entity_t cards = add_row(main_area);
+        for (int c = 0; c < 4; c++) {
+            ecs_entity_t card = add_column(cards);
+            add_text(card, "service", CLAY_TEXT_WRAP_NONE);
+            ecs_entity_t metrics = add_row(card);
+            add_text(metrics, "cpu 42%", CLAY_TEXT_WRAP_NONE);
+            add_spacer(metrics);
+            add_text(metrics, "mem 1.3G", CLAY_TEXT_WRAP_NONE);
+            add_text(card, "healthy: last probe answered in 3ms", CLAY_TEXT_WRAP_WORDS);
+        }
+    }
+
+    ecs_entity_t log = add_container(main_area, CLAY_TOP_TO_BOTTOM,
+                                     CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0));
+    for (int i = 0; i < 200; i++) {
+        add_text(log, "2026-01-01 00:00:00 INFO  request handled in 1.2ms",
+                 CLAY_TEXT_WRAP_NONE);
+    }
+
+    ecs_entity_t footer = add_row(root);
+    add_text(footer, "q quit", CLAY_TEXT_WRAP_NONE);
+    add_spacer(footer);
+    add_text(footer, "200 lines", CLAY_TEXT_WRAP_NONE);
+}
+
+/* ============================================================================
+ * Runner
+ * ============================================================================ */
+
+typedef struct BenchSuite {
+    const char* name;
+    void (*build)(ecs_entity_t surface);
+} BenchSuite;
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Draw every surface's commands onto the grid */
+static void render_headless(ClayHeadlessGrid* grid) {
+    cel_clay_headless_grid_clear(grid);
+    for (int32_t i = 0; i < cel_clay_surface_count(); i++) {
+        cel_clay_headless_render(grid, cel_clay_get_surface_render_data(i)->render_commands, NULL);
+    }
+}
+
+static void run_suite(const BenchSuite* suite, ClayHeadlessGrid* grid) {
+    ecs_entity_t surface = ecs_new(g_world);
+    ecs_set_id(g_world, surface, ClaySurfaceConfig_id, sizeof(ClaySurfaceConfig),
+               &(ClaySurfaceConfig){ .width = (float)BENCH_COLUMNS / 2.0f,
+                                     .height = (float)BENCH_ROWS });
+    g_elements = 0;
+    suite->build(surface);
+
+    /* Absorb construction and any Clay limit growth */
+    for (int w = 0; w < BENCH_WARMUP; w++) {
+        cel_clay_layout_invalidate();
+        cels_step(0);
+        render_headless(grid);
+    }
+
+    static double frame_us[BENCH_FRAMES];
+    double render_total = 0.0;
+    double t_all = now_seconds();
+    cel_clay_profile_reset();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        double t0 = now_seconds();
+        cel_clay_layout_invalidate();
+        cels_step(0);
+        double t1 = now_seconds();
+        render_headless(grid);
+        double t2 = now_seconds();
+        render_total += t2 - t1;
+        frame_us[f] = (t2 - t0) * 1e6;
+    }
+    double elapsed = now_seconds() - t_all;
+
+    ClayProfileSummary phases[CEL_CLAY_PHASE_COUNT];
+    cel_clay_profile_summarize(phases);
+    qsort(frame_us, BENCH_FRAMES, sizeof(double), compare_double);
+
+    double elements = g_elements > 0 ? (double)g_elements : 1.0;
+    double fps = BENCH_FRAMES / elapsed;
+    double p50 = frame_us[BENCH_FRAMES / 2];
+    double p99 = frame_us[(BENCH_FRAMES * 99) / 100];
+    double walk = (double)(phases[CEL_CLAY_PHASE_WALK].mean_ns +
+                           phases[CEL_CLAY_PHASE_CLOSE].mean_ns) / elements;
+    double layout = (double)phases[CEL_CLAY_PHASE_END_LAYOUT].mean_ns / elements;
+    double dispatch = (double)phases[CEL_CLAY_PHASE_DISPATCH].mean_ns / elements;
+    double render = render_total * 1e9 / BENCH_FRAMES / elements;
+
+    fprintf(stderr, "%-10s %9d %10.1f %10.1f %10.1f %9.2f %9.2f %9.2f %9.2f\n",
+            suite->name, g_elements, fps, p50, p99, walk, layout, dispatch, render);
+    printf("{\"bench\":\"cels-clay\",\"version\":\"%s\",\"suite\":\"%s\","
+           "\"elements\":%d,\"frames\":%d,\"fps\":%.2f,"
+           "\"frame_p50_us\":%.2f,\"frame_p99_us\":%.2f,"
+           "\"walk_ns_per_element\":%.3f,\"layout_ns_per_element\":%.3f,"
+           "\"dispatch_ns_per_element\":%.3f,\"render_ns_per_element\":%.3f}\n",
+           CELS_CLAY_VERSION, suite->name, g_elements, BENCH_FRAMES, fps,
+           p50, p99, walk, layout, dispatch, render);
+    fflush(stdout);
+
+    ecs_delete(g_world, surface);
+    cels_step(0);
+    free(g_paragraphs);
+    g_paragraphs = NULL;
+}
+
+static void run_bench(void) {
+    static const BenchSuite suites[] = {
+        { "deep", build_deep },
+        { "wide", build_wide },
+        { "text", build_text },
+        { "dashboard", build_dashboard },
+    };
+
+    g_world = cels_get_world(cels_get_context());
+    ClayHeadlessGrid* grid = cel_clay_headless_grid_create(BENCH_COLUMNS, BENCH_ROWS);
+    if (!grid) {
+        fprintf(stderr, "cels-clay-bench: out of memory\n");
+        return;
+    }
+
+    fprintf(stderr, "%-10s %9s %10s %10s %10s %9s %9s %9s %9s\n", "suite", "elements",
+            "fps", "p50_us", "p99_us", "walk_ns", "layout_ns", "disp_ns", "render_ns");
+    for (size_t s = 0; s < sizeof(suites) / sizeof(suites[0]); s++) {
+        run_suite(&suites[s], grid);
+    }
+
+    cel_clay_headless_grid_destroy(grid);
+}
+
+CEL_Compose(BenchApp) {
+}
+
+cels_main() {
+    /* Size the Clay arenas for the largest suite up front */
+    Clay_Engine_configure(&(ClayEngineConfig){
+        .max_elements = 131072,
+        .max_measure_words = 262144
+    });
+    cels_register(Clay_Engine);
+
+    cels_session(BenchApp) {
+        run_bench();
+    }
+}
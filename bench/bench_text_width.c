@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Text width microbenchmark - word measurement throughput
+ *
+ * Clay measures text one word at a time, so each corpus is split into
+ * words and every word is measured BENCH_ROUNDS times with:
+ *   legacy: the original ncurses measure path -- copy to a NUL-terminated
+ *           buffer, mbstowcs twice, wcwidth per code point
+ *   kernel: _cel_clay_text_extent on the slice in place
+ * Prints ns/word and MB/s per corpus (pure ASCII, mixed ASCII/CJK, CJK),
+ * and the number of words where the two disagree.
+ *
+ * Standalone: no ECS world, only the text width kernel.
+ */
+
+#define _XOPEN_SOURCE 700
+#include <cels-clay/clay_text_width.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+
+#define BENCH_ROUNDS 2000
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* The measure callback as it was before the kernel (width only) */
+static int legacy_measure(const char* chars, int length) {
+    char buf_stack[512];
+    char* buf = buf_stack;
+    if (length >= (int)sizeof(buf_stack)) {
+        buf = (char*)malloc((size_t)length + 1);
+        if (!buf) return 0;
+    }
+    memcpy(buf, chars, (size_t)length);
+    buf[length] = '\0';
+
+    wchar_t wbuf_stack[256];
+    wchar_t* wbuf = wbuf_stack;
+    size_t needed = mbstowcs(NULL, buf, 0);
+    if (needed == (size_t)-1) {
+        if (buf != buf_stack) free(buf);
+        return length;
+    }
+    if (needed >= 256) {
+        wbuf = (wchar_t*)malloc((needed + 1) * sizeof(wchar_t));
+        if (!wbuf) {
+            if (buf != buf_stack) free(buf);
+            return 0;
+        }
+    }
+    mbstowcs(wbuf, buf, needed + 1);
+
+    int max_width = 0, line_width = 0;
+    for (size_t i = 0; i < needed; i++) {
+        if (wbuf[i] == L'\n') {
+            if (line_width > max_width) max_width = line_width;
+            line_width = 0;
+        } else {
+            int cw = wcwidth(wbuf[i]);
+            if (cw > 0) line_width += cw;
+        }
+    }
+    if (line_width > max_width) max_width = line_width;
+
+    if (wbuf != wbuf_stack) free(wbuf);
+    if (buf != buf_stack) free(buf);
+    return max_width;
+}
+
+typedef struct {
+    const char* name;
+    const char* text;
+} Corpus;
+
+static const Corpus k_corpora[] = {
+    { "ascii",
+      "The layout system only runs a Clay pass for a surface when one of its "
+      "inputs changed since the previous frame; idle surfaces reuse their "
+      "previous render commands. request_id=42 latency=1.2ms status=OK" },
+    { "mixed",
+      "Status \xe7\x8a\xb6\xe6\x80\x81: OK  \xe8\x8a\x82\xe7\x82\xb9 node-17 "
+      "cpu 42% \xe5\x86\x85\xe5\xad\x98 1.3G  \xe3\x83\xad\xe3\x82\xb0 log "
+      "rotated \xe6\x88\x90\xe5\x8a\x9f  caf\xc3\xa9 na\xc3\xafve r\xc3\xa9sum\xc3\xa9 "
+      "\xed\x95\x9c\xea\xb5\xad\xec\x96\xb4 text mixed with ASCII words" },
+    { "cjk",
+      "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe6\x96\x87\xe7\xab\xa0 "
+      "\xe4\xb8\xad\xe6\x96\x87\xe6\x96\x87\xe6\x9c\xac \xed\x95\x9c\xea\xb5\xad"
+      "\xec\x96\xb4 \xe6\xbc\xa2\xe5\xad\x97\xe3\x81\xa8\xe4\xbb\xae\xe5\x90\x8d "
+      "\xe3\x83\xac\xe3\x82\xa4\xe3\x82\xa2\xe3\x82\xa6\xe3\x83\x88 \xe6\xb8\xac"
+      "\xe5\xae\x9a \xe5\xb9\x85\xe3\x81\xae\xe8\xa8\x88\xe7\xae\x97" },
+};
+
+typedef struct {
+    const char* chars;
+    int length;
+} Word;
+
+static int split_words(const char* text, Word* words, int max_words) {
+    int count = 0;
+    const char* p = text;
+    while (*p && count < max_words) {
+        while (*p == ' ') p++;
+        const char* start = p;
+        while (*p && *p != ' ') p++;
+        if (p > start) words[count++] = (Word){ start, (int)(p - start) };
+    }
+    return count;
+}
+
+int main(void) {
+    if (!setlocale(LC_ALL, "C.UTF-8") && !setlocale(LC_ALL, "en_US.UTF-8")) {
+        fprintf(stderr, "no UTF-8 locale: legacy timings are not comparable\n");
+    }
+
+    printf("%-8s %8s %14s %14s %12s %12s %8s %10s\n", "corpus", "words",
+           "legacy_ns/w", "kernel_ns/w", "legacy_MB/s", "kernel_MB/s",
+           "speedup", "mismatch");
+
+    for (size_t c = 0; c < sizeof(k_corpora) / sizeof(k_corpora[0]); c++) {
+        Word words[256];
+        int count = split_words(k_corpora[c].text, words, 256);
+        size_t bytes = 0;
+        int mismatch = 0;
+        for (int w = 0; w < count; w++) {
+            bytes += (size_t)words[w].length;
+            if (legacy_measure(words[w].chars, words[w].length) !=
+                _cel_clay_text_extent(words[w].chars, words[w].length).columns) {
+                mismatch++;
+            }
+        }
+
+        volatile long sink = 0;
+        double t0 = now_seconds();
+        for (int r = 0; r < BENCH_ROUNDS; r++) {
+            for (int w = 0; w < count; w++) {
+                sink += legacy_measure(words[w].chars, words[w].length);
+            }
+        }
+        double legacy = now_seconds() - t0;
+
+        t0 = now_seconds();
+        for (int r = 0; r < BENCH_ROUNDS; r++) {
+            for (int w = 0; w < count; w++) {
+                sink += _cel_clay_text_extent(words[w].chars, words[w].length).columns;
+            }
+        }
+        double kernel = now_seconds() - t0;
+
+        double measured = (double)count * BENCH_ROUNDS;
+        double total_mb = (double)bytes * BENCH_ROUNDS / 1e6;
+        printf("%-8s %8d %14.1f %14.1f %12.1f %12.1f %7.1fx %10d\n",
+               k_corpora[c].name, count,
+               legacy * 1e9 / measured, kernel * 1e9 / measured,
+               total_mb / legacy, total_mb / kernel,
+               legacy / kernel, mismatch);
+        (void)sink;
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Virtual list benchmark - layout cost of a windowed container vs N
+ *
+ * Builds one surface holding a windowed column (child_limit = 50) and
+ * grows it to 10^3 .. 10^6 text rows with raw flecs calls. At each size
+ * the column is scrolled for a fixed number of frames (child_offset
+ * changes every frame, so every frame runs a full layout pass) and the
+ * mean frame time is printed. With the indexed child store the per-frame
+ * time stays flat in N; row insertion is amortized O(1) (append).
+ *
+ * Headless: only Clay_Engine is registered, no renderer.
+ */
+
+/* clock_gettime under strict -std */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <cels/cels.h>
+#include <cels-clay/clay_engine.h>
+#include <cels-clay/clay_layout.h>
+#include <cels-clay/clay_primitives.h>
+#include <flecs.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_WINDOW 50
+#define BENCH_FRAMES 200
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void add_rows(ecs_world_t* world, ecs_entity_t list, int count) {
+    ClayTextConfig row = {
+        .text = "2026-01-01 00:00:00 INFO  request handled in 1.2ms",
+        .color = {200, 200, 200, 255},
+        .font_size = 16
+    };
+    for (int i = 0; i < count; i++) {
+        ecs_entity_t e = ecs_new_w_pair(world, EcsChildOf, list);
+        ecs_set_id(world, e, ClayTextConfig_id, sizeof(ClayTextConfig), &row);
+    }
+}
+
+static void scroll_to(ecs_world_t* world, ecs_entity_t list, uint32_t offset) {
+    ClayContainerConfig* config = (ClayContainerConfig*)
+        ecs_get_mut_id(world, list, ClayContainerConfig_id);
+    config->child_offset = offset;
+    ecs_modified_id(world, list, ClayContainerConfig_id);
+}
+
+static void run_bench(void) {
+    ecs_world_t* world = cels_get_world(cels_get_context());
+
+    ecs_entity_t surface = ecs_new(world);
+    ecs_set_id(world, surface, ClaySurfaceConfig_id, sizeof(ClaySurfaceConfig),
+               &(ClaySurfaceConfig){ .width = 120.0f, .height = 60.0f });
+
+    ecs_entity_t list = ecs_new_w_pair(world, EcsChildOf, surface);
+    ecs_set_id(world, list, ClayContainerConfig_id, sizeof(ClayContainerConfig),
+               &(ClayContainerConfig){
+                   .direction = CLAY_TOP_TO_BOTTOM,
+                   .width = CLAY_SIZING_GROW(0),
+                   .height = CLAY_SIZING_GROW(0),
+                   .child_limit = BENCH_WINDOW
+               });
+
+    printf("%10s %14s %14s %12s\n", "children", "insert_ns/row", "frame_us", "passes");
+
+    int total = 0;
+    for (int target = 1000; target <= 1000000; target *= 10) {
+        double t0 = now_seconds();
+        add_rows(world, list, target - total);
+        double insert = now_seconds() - t0;
+        int added = target - total;
+        total = target;
+
+        cels_step(0);  /* Absorb the insertions */
+
+        ClayLayoutStats before = cel_clay_get_layout_stats();
+        t0 = now_seconds();
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            scroll_to(world, list, (uint32_t)((f * 7919) % (total - BENCH_WINDOW)));
+            cels_step(0);
+        }
+        double frames = now_seconds() - t0;
+        ClayLayoutStats after = cel_clay_get_layout_stats();
+
+        printf("%10d %14.1f %14.2f %12llu\n", total,
+               insert * 1e9 / added,
+               frames * 1e6 / BENCH_FRAMES,
+               (unsigned long long)(after.passes_executed - before.passes_executed));
+    }
+}
+
+CEL_Compose(BenchApp) {
+}
+
+cels_main() {
+    cels_register(Clay_Engine);
+
+    cels_session(BenchApp) {
+        run_bench();
+    }
+}
@@ -68,26 +68,26 @@ static inline void build_ui(void) {
                    .gap = 0,
                    .bg = UI_BG_SIDEBAR) {
 
-            ClayText(.text = "MENU", .color = UI_ACCENT) {}
+            ClayText(.text = "MENU", .stable = true, .color = UI_ACCENT) {}
             ClaySpacer(.height = CLAY_SIZING_FIT(1)) {}
 
             /* Navigation items */
             ClayRow(.width = CLAY_SIZING_GROW(0),
                     .padding = {.left = 1, .right = 1}) {
-                ClayText(.text = "Dashboard", .color = UI_FG_TITLE) {}
+                ClayText(.text = "Dashboard", .stable = true, .color = UI_FG_TITLE) {}
             }
             ClayRow(.width = CLAY_SIZING_GROW(0),
                     .padding = {.left = 1, .right = 1}) {
-                ClayText(.text = "Settings", .color = UI_FG_TEXT) {}
+                ClayText(.text = "Settings", .stable = true, .color = UI_FG_TEXT) {}
             }
             ClayRow(.width = CLAY_SIZING_GROW(0),
                     .padding = {.left = 1, .right = 1}) {
-                ClayText(.text = "About", .color = UI_FG_DIM) {}
+                ClayText(.text = "About", .stable = true, .color = UI_FG_DIM) {}
             }
 
             /* Push version label to bottom */
             ClaySpacer() {}
-            ClayText(.text = "v0.6", .color = UI_FG_DIM) {}
+            ClayText(.text = "v0.6", .stable = true, .color = UI_FG_DIM) {}
         }
 
         /* Content area: grows to fill remaining space */
@@ -97,16 +97,16 @@ static inline void build_ui(void) {
                    .gap = 1,
                    .bg = UI_BG_CONTENT) {
 
-            ClayText(.text = "Dashboard", .color = UI_FG_TITLE) {}
+            ClayText(.text = "Dashboard", .stable = true, .color = UI_FG_TITLE) {}
 
             /* Welcome card */
             ClayColumn(.width = CLAY_SIZING_GROW(0),
                        .padding = {.left = 1, .right = 1, .top = 1, .bottom = 1},
                        .gap = 0,
                        .bg = UI_BG_CARD) {
-                ClayText(.text = "Welcome", .color = UI_ACCENT) {}
+                ClayText(.text = "Welcome", .stable = true, .color = UI_ACCENT) {}
                 ClayText(.text = "This is a minimal cels-clay example rendering"
-                         " on both NCurses and SDL3 backends.",
+                         " on both NCurses and SDL3 backends.", .stable = true,
                          .color = UI_FG_TEXT) {}
             }
 
@@ -129,7 +129,7 @@ static inline void build_ui(void) {
 
             /* Push footer to bottom */
             ClaySpacer() {}
-            ClayText(.text = "cels-clay v0.6 -- Entity-Based UI + Dual Renderers",
+            ClayText(.text = "cels-clay v0.6 -- Entity-Based UI + Dual Renderers", .stable = true,
                      .color = UI_FG_DIM) {}
         }
     }
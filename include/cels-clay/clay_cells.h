@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Cells - Layout-to-cell mapping shared by the cell-grid renderers
+ *
+ * The ncurses and headless renderers rasterize the same render commands
+ * onto a grid of character cells. Both go through these helpers so a
+ * headless frame matches what the terminal shows cell for cell.
+ *
+ * Coordinate mapping: Clay lays out in units where one unit is one cell
+ * tall and 1 / cell_aspect_ratio cells wide (terminal cells are taller
+ * than wide). Horizontal values are scaled by the aspect ratio and every
+ * edge is rounded to the nearest cell; non-empty boxes cover at least
+ * one cell.
+ *
+ * Internal to cels-clay: used by clay_ncurses_renderer.c and
+ * clay_headless_renderer.c. Not for direct consumer use.
+ */
+
+#ifndef CELS_CLAY_CELLS_H
+#define CELS_CLAY_CELLS_H
+
+#include "clay.h"
+#include <stdint.h>
+
+typedef struct _CelClayCellRect {
+    int x;
+    int y;
+    int w;
+    int h;
+} _CelClayCellRect;
+
+/* Every command type. Text needs no mapping of its own: the measure
+ * callback reports columns / aspect ratio, so scaling the width back gives
+ * exactly the measured cell columns. */
+extern _CelClayCellRect _cel_clay_bbox_to_cells(Clay_BoundingBox bbox, float aspect_ratio);
+
+/* Background color of the nearest opaque parent RECTANGLE containing
+ * command `index` (alpha 0 if none). Text, borders and border decorations
+ * draw on it so their cells blend with the fill. */
+extern Clay_Color _cel_clay_find_parent_bg(Clay_RenderCommandArray commands, int32_t index);
+
+#endif /* CELS_CLAY_CELLS_H */
@@ -40,6 +40,9 @@
 #define CELS_CLAY_ENGINE_H
 
 #include <cels/cels.h>
+#include "clay.h"
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* ===========================================
@@ -49,19 +52,77 @@
  * Configuration for Clay_Engine_configure().
  * Pass arena_size = 0 to use Clay_MinMemorySize() default.
  * Pass initial_width/height = 0 to defer dimensions until ClaySurface.
+ * Pass frame_arena_size = 0 for 16KB initial frame arenas (they grow on
+ * demand; see ClayFrameArenaStats).
+ * max_elements / max_measure_words size each Clay context's arena. Small
+ * UIs can start low: when a pass exceeds a limit, the limit doubles, the
+ * context is rebuilt with a larger arena and the pass runs again within
+ * the same frame.
+ * lazy_arena reserves each Clay arena with mmap so only touched pages
+ * become resident; see ClayArenaFootprint and cel_clay_trim_arenas.
+ * render_buffers = 2 or 3 makes the render bridge snapshot every frame
+ * into self-contained buffers a render thread can draw from while the next
+ * layout runs (see ClayRenderSnapshot); 0 = off.
+ *
+ * layout_threads > 1 lays out changed ClaySurfaces concurrently (the
+ * calling thread plus layout_threads - 1 workers), joined before OnStore.
+ * Requires building with CELS_CLAY_PARALLEL_LAYOUT and a thread-safe text
+ * measurement function; the SDL3 renderer's (SDL3_ttf) is not, so it
+ * keeps layout serial.
  */
 typedef struct ClayEngineConfig {
     uint32_t arena_size;    /* Override arena capacity in bytes (0 = default) */
     float initial_width;    /* Initial layout width (0 = not set until ClaySurface) */
     float initial_height;   /* Initial layout height (0 = not set until ClaySurface) */
+    uint32_t layout_threads; /* Threads laying out surfaces in parallel (0/1 = serial) */
+    uint32_t frame_arena_size; /* Initial per-surface frame arena bytes (0 = 16KB) */
+    uint32_t max_elements;  /* Initial Clay element capacity (0 = 8192) */
+    uint32_t max_measure_words; /* Initial measured-word cache capacity (0 = 16384) */
+    bool lazy_arena;        /* Reserve Clay arenas with mmap, commit on touch */
+    uint32_t render_buffers; /* Render snapshot buffers (0 = off, 2-3) */
 } ClayEngineConfig;
 
 /* Module declaration */
 CEL_Module(Clay_Engine);
 
+/* ============================================================================
+ * Engine Statistics
+ * ============================================================================
+ *
+ * Memory and cache figures for sizing ClayEngineConfig, refreshed at the
+ * end of every layout system run from counters the passes keep anyway --
+ * reading them costs nothing beyond cel_read(ClayEngineState).
+ *
+ * Per-surface figures (arena, elements, words) are those of each surface's
+ * last pass, summed over live surfaces; surfaces that skipped this frame
+ * still count. text_lookups / text_misses count text elements since init:
+ * a miss is an element whose words the measure function had to measure
+ * (Clay caches measurements per text element). Misses are only seen when
+ * the measure function was installed with
+ * cel_clay_set_measure_text_function.
+ */
+typedef struct ClayEngineStats {
+    size_t arena_bytes_used;    /* Clay arena bytes in use, all contexts */
+    size_t arena_bytes_peak;    /* High-water mark of arena_bytes_used */
+    size_t arena_capacity;      /* Clay arena bytes available, all contexts */
+    uint32_t elements;          /* Layout elements, all surfaces */
+    uint32_t elements_peak;     /* Most elements one surface pass used */
+    uint32_t max_elements;      /* Current per-context element limit */
+    uint32_t measure_words;     /* Cached measured words, all contexts */
+    uint32_t max_measure_words; /* Current per-context word limit */
+    float measure_hit_rate;     /* 1 - text_misses / text_lookups (1 if none) */
+    uint64_t text_lookups;      /* Text elements laid out */
+    uint64_t text_misses;       /* Of those, measured rather than cached */
+    size_t frame_arena_peak;    /* ClayFrameArenaStats.peak_bytes */
+    uint32_t render_commands;   /* Render commands, all surfaces */
+    uint32_t surfaces;          /* Live ClaySurfaces */
+    uint32_t surfaces_laid_out; /* Surfaces that ran a pass this frame */
+} ClayEngineStats;
+
 /* State singleton -- cross-TU accessible via cel_read(ClayEngineState) */
 CEL_Define_State(ClayEngineState) {
     bool initialized;
+    ClayEngineStats stats;
 };
 
 /* Configure Clay engine before module registration.
@@ -69,4 +130,88 @@ CEL_Define_State(ClayEngineState) {
  * Pass NULL to use all defaults. */
 extern void Clay_Engine_configure(const ClayEngineConfig* config);
 
+/* ============================================================================
+ * Arena Footprint
+ * ============================================================================
+ *
+ * reserved: bytes allocated for all Clay arenas (primary + surfaces).
+ * committed: bytes of those actually resident. With lazy_arena this is
+ *   measured with mincore; malloc'd arenas count as fully committed.
+ *
+ * cel_clay_trim_arenas: each surface returns the pages of its per-pass
+ *   memory to the OS (madvise) right before its next pass rebuilds it;
+ *   pages the pass still needs are committed again on touch. Only affects
+ *   lazy_arena arenas. Suited to a periodic idle or low-memory hook.
+ */
+typedef struct ClayArenaFootprint {
+    size_t reserved;
+    size_t committed;
+    uint32_t contexts;
+} ClayArenaFootprint;
+
+extern ClayArenaFootprint cel_clay_get_arena_footprint(void);
+extern void cel_clay_trim_arenas(void);
+
+/* ============================================================================
+ * Context Management (internal)
+ * ============================================================================
+ *
+ * Used by the layout system to give each ClaySurface its own Clay context.
+ * Not for direct consumer use.
+ *
+ * _cel_clay_context_create: Allocate an arena and initialize a context in
+ *   it (made current). *out_memory receives the allocation to pass to
+ *   _cel_clay_context_destroy.
+ * _cel_clay_primary_context: Context created at module init -- the one
+ *   renderers configure and the first surface lays out in.
+ * _cel_clay_engine_config: Config stored by Clay_Engine_configure.
+ * _cel_clay_context_take_overflow: CEL_CLAY_OVERFLOW_* bits the context
+ *   allocated at `memory` raised since the last call (then cleared).
+ * _cel_clay_grow_limits: Double the limits named by the overflow bits for
+ *   contexts created from now on.
+ * _cel_clay_primary_context_recreate: Replace the primary context with a
+ *   fresh one at the current limits (scroll state is lost).
+ * _cel_clay_context_trim: Drop the resident pages of a context's per-pass
+ *   memory. Only between passes of that context.
+ * _cel_clay_context_footprint: Add a context's reserved/committed bytes.
+ * _cel_clay_trim_generation: Bumped by cel_clay_trim_arenas.
+ * _cel_clay_context_ephemeral_offset: Start of the per-pass region in a
+ *   context's arena (clay_impl.c).
+ * _cel_clay_context_usage: Add a context's arena, element and cached word
+ *   usage as of its last pass (clay_impl.c).
+ * _cel_clay_last_element_index / _cel_clay_text_element_lines: Locate a
+ *   text element's TEXT commands after its pass, for paint-only patches
+ *   (clay_impl.c).
+ * _cel_clay_engine_stats_publish: Store the layout system's statistics in
+ *   ClayEngineState (limits and arena peak are filled in).
+ */
+#define CEL_CLAY_OVERFLOW_ELEMENTS (1u << 0)
+#define CEL_CLAY_OVERFLOW_WORDS    (1u << 1)
+#define CEL_CLAY_OVERFLOW_ARENA    (1u << 2)
+
+extern Clay_Context* _cel_clay_context_create(Clay_Dimensions dimensions, void** out_memory);
+extern void _cel_clay_context_destroy(void* memory);
+extern Clay_Context* _cel_clay_primary_context(void);
+extern const ClayEngineConfig* _cel_clay_engine_config(void);
+extern uint32_t _cel_clay_context_take_overflow(void* memory);
+extern void _cel_clay_grow_limits(uint32_t overflow);
+extern Clay_Context* _cel_clay_primary_context_recreate(Clay_Dimensions dimensions);
+extern void* _cel_clay_primary_context_memory(void);
+extern void _cel_clay_context_trim(void* memory);
+extern void _cel_clay_context_footprint(void* memory, size_t* reserved, size_t* committed);
+extern uint32_t _cel_clay_trim_generation(void);
+extern size_t _cel_clay_context_ephemeral_offset(Clay_Context* context);
+
+typedef struct _CelClayContextUsage {
+    size_t arena_used;
+    size_t arena_capacity;
+    uint32_t elements;
+    uint32_t measured_words;
+} _CelClayContextUsage;
+
+extern void _cel_clay_context_usage(Clay_Context* context, _CelClayContextUsage* usage);
+extern int32_t _cel_clay_last_element_index(void);
+extern int32_t _cel_clay_text_element_lines(int32_t element_index, uint32_t* out_id);
+extern void _cel_clay_engine_stats_publish(const ClayEngineStats* stats);
+
 #endif /* CELS_CLAY_ENGINE_H */
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Headless Renderer Module - In-memory cell grid for Clay render commands
+ *
+ * Rasterizes Clay_RenderCommandArray into a grid of character cells
+ * without a terminal: each cell holds a code point, foreground and
+ * background colors and text attributes. Cells are produced the way the
+ * ncurses renderer draws them -- same aspect-ratio mapping, parent
+ * background resolution, border styles and border decorations -- so a
+ * grid is a faithful stand-in for the terminal in CI: hash it, dump it,
+ * or compare it against a golden file, and time rendering without any
+ * terminal I/O.
+ *
+ * The renderer handles the same command types as the ncurses renderer:
+ *   RECTANGLE     -> filled cells (or a CelClayBorderDecor box)
+ *   TEXT          -> code points, clipped to the measured width
+ *   BORDER        -> single, double or rounded box-drawing characters
+ *   SCISSOR_START -> nested clip regions
+ *   SCISSOR_END   -> restore parent clip
+ *
+ * Usage as a module (replaces Clay_NCurses; do not register both):
+ *
+ *   CEL_Build(App) {
+ *       Clay_Headless_configure(&(ClayHeadlessConfig){ .columns = 120, .rows = 40 });
+ *       cels_register(Clay_Engine, Clay_Headless);
+ *   }
+ *   ... after a frame ...
+ *   uint64_t hash = cel_clay_headless_grid_hash(cel_clay_headless_grid());
+ *
+ * Standalone (no ECS): create a grid and call cel_clay_headless_render
+ * with any command array, e.g. a replayed frame (clay_record.h).
+ */
+
+#ifndef CELS_CLAY_HEADLESS_RENDERER_H
+#define CELS_CLAY_HEADLESS_RENDERER_H
+
+#include <cels/cels.h>
+#include "clay.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* ============================================================================
+ * Cell Grid
+ * ============================================================================
+ *
+ * Colors are 0xRRGGBB, or CLAY_HEADLESS_COLOR_DEFAULT for the terminal's
+ * default color. Attributes use the bit layout of the packed text
+ * attributes carried in text userData (bold, dim, underline, reverse,
+ * italic). A wide character occupies two cells: the second holds code
+ * point 0. Cells are stored row-major.
+ */
+#define CLAY_HEADLESS_COLOR_DEFAULT 0xFF000000u
+
+#define CLAY_HEADLESS_ATTR_BOLD      0x01u
+#define CLAY_HEADLESS_ATTR_DIM       0x02u
+#define CLAY_HEADLESS_ATTR_UNDERLINE 0x04u
+#define CLAY_HEADLESS_ATTR_REVERSE   0x08u
+#define CLAY_HEADLESS_ATTR_ITALIC    0x10u
+
+typedef struct ClayHeadlessCell {
+    uint32_t codepoint;
+    uint32_t fg;
+    uint32_t bg;
+    uint32_t attrs;
+} ClayHeadlessCell;
+
+typedef struct ClayHeadlessGrid {
+    int32_t columns;
+    int32_t rows;
+    ClayHeadlessCell* cells;
+} ClayHeadlessGrid;
+
+/* ============================================================================
+ * ClayHeadlessConfig
+ * ============================================================================
+ *
+ * columns/rows:      Grid size in cells. Default 80 x 24.
+ * cell_aspect_ratio: Horizontal scale from layout units to cells, as in
+ *                    ClayNcursesTheme. Default 2.0.
+ * alpha_as_dim:      Rectangles with alpha < 128 get the dim attribute,
+ *                    as in ClayNcursesTheme.
+ *
+ * Zero fields take the defaults; alpha_as_dim is on only for a NULL
+ * config (matching CLAY_NCURSES_THEME_DEFAULT).
+ */
+typedef struct ClayHeadlessConfig {
+    int32_t columns;
+    int32_t rows;
+    float cell_aspect_ratio;
+    bool alpha_as_dim;
+} ClayHeadlessConfig;
+
+/* ============================================================================
+ * Module Declaration
+ * ============================================================================ */
+
+CEL_Module(Clay_Headless);
+
+/* Configure the module before cels_register(Clay_Headless). Pass NULL for
+ * the defaults. */
+extern void Clay_Headless_configure(const ClayHeadlessConfig* config);
+
+/* The module's grid: every surface of the last dispatch, in surface order.
+ * Redrawn only on frames with a dirty surface. NULL before the first frame. */
+extern const ClayHeadlessGrid* cel_clay_headless_grid(void);
+
+/* ============================================================================
+ * Grid API
+ * ============================================================================
+ *
+ * cel_clay_headless_grid_create / destroy: A blank grid (spaces, default
+ *   colors). NULL if out of memory.
+ * cel_clay_headless_grid_clear: Reset every cell to blank.
+ * cel_clay_headless_render: Draw one surface's commands onto the grid
+ *   (over what is there; clear first for a fresh frame). NULL config =
+ *   defaults.
+ * cel_clay_headless_grid_hash: 64-bit hash of size and every cell.
+ * cel_clay_headless_grid_dump: Write the code points as UTF-8, one line
+ *   per row. With `styles`, each row is followed by a line of
+ *   "col:fg/bg/attrs" entries for every cell whose style differs from the
+ *   previous cell of the row (hex, first cell always listed).
+ * cel_clay_headless_grid_save / load: Binary golden file of the whole
+ *   grid. load returns a grid to destroy, or NULL.
+ * cel_clay_headless_grid_diff: Number of cells that differ (every cell of
+ *   either grid when their sizes differ); the first differing cell's
+ *   position in *out_column / *out_row when not NULL (-1 when none).
+ */
+extern ClayHeadlessGrid* cel_clay_headless_grid_create(int32_t columns, int32_t rows);
+extern void cel_clay_headless_grid_destroy(ClayHeadlessGrid* grid);
+extern void cel_clay_headless_grid_clear(ClayHeadlessGrid* grid);
+extern void cel_clay_headless_render(ClayHeadlessGrid* grid, Clay_RenderCommandArray commands,
+                                     const ClayHeadlessConfig* config);
+extern uint64_t cel_clay_headless_grid_hash(const ClayHeadlessGrid* grid);
+extern bool cel_clay_headless_grid_dump(const ClayHeadlessGrid* grid, FILE* out, bool styles);
+extern bool cel_clay_headless_grid_save(const ClayHeadlessGrid* grid, const char* path);
+extern ClayHeadlessGrid* cel_clay_headless_grid_load(const char* path);
+extern int32_t cel_clay_headless_grid_diff(const ClayHeadlessGrid* a, const ClayHeadlessGrid* b,
+                                           int32_t* out_column, int32_t* out_row);
+
+#endif /* CELS_CLAY_HEADLESS_RENDERER_H */
@@ -46,7 +46,9 @@
 
 #include <cels/cels.h>
 #include "clay.h"
+#include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* ============================================================================
  * ClaySurfaceConfig Component
@@ -172,6 +174,7 @@ static void ClaySurface_impl(ClaySurface_props props) {
  *
  * Creates a Clay_String from a dynamic buffer by copying into the per-frame
  * arena. The copy survives until the renderer reads it after EndLayout.
+ * The arena grows as needed; strings never move once copied.
  * Use with CLAY_TEXT for dynamic (snprintf) strings.
  *
  * Example:
@@ -183,6 +186,94 @@ static void ClaySurface_impl(ClaySurface_props props) {
 #define CEL_Clay_Text(buf, len) \
     _cel_clay_frame_arena_string((buf), (len))
 
+/* ============================================================================
+ * Layout Change Tracking
+ * ============================================================================
+ *
+ * The layout system only runs a Clay pass for a surface when one of its
+ * inputs changed since the previous frame: a Clay property component
+ * (ClayContainerConfig, ClayTextConfig, ClaySpacerConfig, ClayImageConfig,
+ * ClayBorderStyle) in its subtree, its hierarchy or sibling order, or its
+ * ClaySurfaceConfig. Idle surfaces reuse their previous render commands.
+ *
+ * Changes that only touch colors -- ClayContainerConfig.bg (staying
+ * opaque or transparent) or ClayTextConfig.color -- skip the pass too: the
+ * previous commands are recolored in place.
+ *
+ * Changes the observers cannot see -- e.g. editing one of the components
+ * above in place (ecs_get_mut without ecs_modified), rewriting the
+ * characters behind a ClayTextConfig.text pointer in place, or feeding
+ * scroll deltas through Clay_UpdateScrollContainers directly -- must call
+ * cel_clay_layout_invalidate() to force the next pass (of every surface,
+ * with every component reloaded).
+ */
+typedef struct ClayLayoutStats {
+    uint64_t passes_executed;  /* Surface passes that ran BeginLayout..EndLayout */
+    uint64_t passes_skipped;   /* Surface passes that reused previous commands */
+    uint64_t passes_painted;   /* Of those, recolored in place (paint-only) */
+    uint64_t subtrees_replayed; /* Cacheable subtrees replayed from cache */
+    uint64_t subtrees_recorded; /* Cacheable subtrees (re)recorded */
+} ClayLayoutStats;
+
+extern void cel_clay_layout_invalidate(void);
+extern ClayLayoutStats cel_clay_get_layout_stats(void);
+
+/* Each surface's Clay context caches word measurements across frames and
+ * resizes. Call this when the measure function would now return different
+ * sizes for the same text -- font loaded or changed, theme or cell aspect
+ * ratio changed. Every surface drops its cache and lays out again on the
+ * next frame. */
+extern void cel_clay_invalidate_text_measurements(void);
+
+/* ============================================================================
+ * Text Measurement Function
+ * ============================================================================
+ *
+ * Installs the text measurement function used by every surface's Clay
+ * context. Use this instead of Clay_SetMeasureTextFunction: the layout
+ * system wraps the function to count measure-cache misses
+ * (ClayEngineStats) and drops cached measurements taken with the previous
+ * function. Defaults to one unit per character, one per line.
+ */
+extern void cel_clay_set_measure_text_function(
+    Clay_Dimensions (*measure)(Clay_StringSlice text,
+                               Clay_TextElementConfig* config,
+                               void* user_data),
+    void* user_data);
+
+/* ============================================================================
+ * Frame Arena Stats
+ * ============================================================================
+ *
+ * Usage of the per-surface frame arenas behind CEL_Clay_Text, updated at
+ * the end of every layout system run. Arenas grow in chunks without moving
+ * earlier strings and shrink back after sustained low use; the initial
+ * size is ClayEngineConfig.frame_arena_size.
+ */
+typedef struct ClayFrameArenaStats {
+    size_t bytes_used;      /* Live string bytes across surfaces this frame */
+    size_t peak_bytes;      /* High-water mark of bytes_used */
+    size_t capacity;        /* Bytes reserved by all chunks */
+    uint32_t chunk_count;   /* Chunks held across surfaces */
+} ClayFrameArenaStats;
+
+extern ClayFrameArenaStats cel_clay_get_frame_arena_stats(void);
+
+/* ============================================================================
+ * Parallel Layout
+ * ============================================================================
+ *
+ * Surfaces that need a pass in the same frame are independent (own Clay
+ * context, frame arena and commands) and can be laid out concurrently.
+ * cel_clay_set_layout_threads(n) uses the layout system's thread plus
+ * n - 1 worker threads; all passes complete before the system returns.
+ * Initialized from ClayEngineConfig.layout_threads. Only effective when
+ * built with CELS_CLAY_PARALLEL_LAYOUT, and ignored (reported as 1) when a
+ * renderer's text measurement is not thread-safe.
+ */
+extern void cel_clay_set_layout_threads(uint32_t threads);
+extern uint32_t cel_clay_get_layout_threads(void);
+
 /* ============================================================================
  * Internal Function Declarations
  * ============================================================================
@@ -198,6 +289,30 @@ extern bool _cel_clay_layout_active(void);
 extern Clay_RenderCommandArray _cel_clay_get_render_commands(void);
 extern Clay_Dimensions _cel_clay_get_layout_dimensions(void);
 
+/* ============================================================================
+ * Per-Surface Output (internal)
+ * ============================================================================
+ *
+ * One entry per live ClaySurface, in surface order: the render commands of
+ * the surface's last layout pass and the dimensions it was laid out at.
+ * Valid until the next layout pass. Consumed by the render bridge.
+ *
+ * revision changes whenever the commands may have changed (a layout pass
+ * or a paint patch). Frames skipped by the layout keep their revision, so
+ * the bridge only rehashes surfaces that were touched.
+ */
+typedef struct _CelClaySurfaceOutput {
+    cels_entity_t surface;
+    Clay_RenderCommandArray commands;
+    Clay_Dimensions dimensions;
+    uint32_t revision;
+} _CelClaySurfaceOutput;
+
+extern int32_t _cel_clay_surface_count(void);
+extern const _CelClaySurfaceOutput* _cel_clay_surface_output(int32_t index);
+/* Allocation holding the surface's Clay context (see clay_engine.h) */
+extern void* _cel_clay_surface_context_memory(int32_t index);
+
 /* ============================================================================
  * Layout Subsystem Lifecycle
  * ============================================================================
@@ -209,4 +324,7 @@ extern void _cel_clay_layout_init(void);
 extern void _cel_clay_layout_cleanup(void);
 extern void _cel_clay_layout_system_register(void);
 
+/* Called by renderers whose measure function must stay on one thread */
+extern void _cel_clay_layout_require_serial(void);
+
 #endif /* CELS_CLAY_LAYOUT_H */
@@ -64,7 +64,21 @@
 
 /* ClayContainerConfig -- shared by Row, Column, and Box.
  * The direction field determines layout axis:
- *   CLAY_LEFT_TO_RIGHT for Row, CLAY_TOP_TO_BOTTOM for Column/Box. */
+ *   CLAY_LEFT_TO_RIGHT for Row, CLAY_TOP_TO_BOTTOM for Column/Box.
+ *
+ * Child window: when child_limit > 0, only the children
+ * [child_offset, child_offset + child_limit) in sibling order are laid
+ * out. Windowed containers keep their children out of the cached layout
+ * tree, so a pass costs O(child_limit + log N) regardless of the child
+ * count N -- use it for long lists (logs, tables) and scroll by moving
+ * child_offset.
+ *
+ * Cacheable: set `cacheable` on static islands (sidebars, headers, help
+ * panes). While nothing in the container's subtree changes and it lays
+ * out at the same size, a pass replays the container's previous render
+ * commands at its new position instead of walking and laying out the
+ * subtree again. Elements inside a replayed subtree are not known to Clay
+ * that pass (Clay_GetElementData, hover). */
 typedef struct ClayContainerConfig {
     Clay_LayoutDirection direction;
     uint16_t gap;
@@ -74,11 +88,25 @@ typedef struct ClayContainerConfig {
     Clay_ChildAlignment alignment;
     Clay_Color bg;
     bool clip;
+    uint32_t child_offset;
+    uint32_t child_limit;   /* 0 = lay out all children */
+    bool cacheable;         /* Replay commands while the subtree is unchanged */
 } ClayContainerConfig;
 
-/* ClayTextConfig -- text content and styling properties. */
+/* ClayTextConfig -- text content and styling properties.
+ *
+ * By default the characters behind `text` are copied into the frame arena
+ * every layout pass, so the buffer may be rewritten between frames (call
+ * cel_clay_layout_invalidate() when it is). Set `stable` when `text` points
+ * at storage that never changes while the component holds it -- string
+ * literals, interned labels: the string is then handed to Clay directly
+ * (isStaticallyAllocated, no copy), and its length is measured once when
+ * the component is set. `length` gives the byte length up front (0 =
+ * strlen). */
 typedef struct ClayTextConfig {
     const char* text;
+    int32_t length;         /* Bytes of text (0 = NUL-terminated) */
+    bool stable;            /* text is immutable: no per-frame copy */
     Clay_Color color;
     uint16_t font_size;
     uint16_t font_id;
@@ -162,6 +190,9 @@ typedef struct ClayRow_props {
     Clay_ChildAlignment alignment;
     Clay_Color bg;
     bool clip;
+    uint32_t child_offset;
+    uint32_t child_limit;
+    bool cacheable;
 } ClayRow_props;
 
 static void ClayRow_impl(ClayRow_props props);
@@ -179,7 +210,10 @@ static void ClayRow_impl(ClayRow_props props) {
         .height = props.height,
         .alignment = props.alignment,
         .bg = props.bg,
-        .clip = props.clip
+        .clip = props.clip,
+        .child_offset = props.child_offset,
+        .child_limit = props.child_limit,
+        .cacheable = props.cacheable
     );
 }
 
@@ -199,6 +233,9 @@ typedef struct ClayColumn_props {
     Clay_ChildAlignment alignment;
     Clay_Color bg;
     bool clip;
+    uint32_t child_offset;
+    uint32_t child_limit;
+    bool cacheable;
 } ClayColumn_props;
 
 static void ClayColumn_impl(ClayColumn_props props);
@@ -216,7 +253,10 @@ static void ClayColumn_impl(ClayColumn_props props) {
         .height = props.height,
         .alignment = props.alignment,
         .bg = props.bg,
-        .clip = props.clip
+        .clip = props.clip,
+        .child_offset = props.child_offset,
+        .child_limit = props.child_limit,
+        .cacheable = props.cacheable
     );
 }
 
@@ -240,6 +280,9 @@ typedef struct ClayBox_props {
     Clay_BorderElementConfig border;
     Clay_CornerRadius corner_radius;
     bool clip;
+    uint32_t child_offset;
+    uint32_t child_limit;
+    bool cacheable;
 } ClayBox_props;
 
 static void ClayBox_impl(ClayBox_props props);
@@ -256,7 +299,10 @@ static void ClayBox_impl(ClayBox_props props) {
         .height = props.height,
         .alignment = props.alignment,
         .bg = props.bg,
-        .clip = props.clip
+        .clip = props.clip,
+        .child_offset = props.child_offset,
+        .child_limit = props.child_limit,
+        .cacheable = props.cacheable
     );
     /* Attach border style only if any border width is non-zero */
     if (props.border.width.top || props.border.width.right ||
@@ -274,12 +320,15 @@ static void ClayBox_impl(ClayBox_props props) {
  * ClayText -- text element
  * --------------------------------------------------------------------------
  * Defaults: color white (255,255,255,255), font_size 16 if not specified.
+ * Pass .stable = true for literal text: ClayText(.text = "Menu", .stable = true)
  */
 
 typedef struct ClayText_props {
     cels_lifecycle_def_t* lifecycle;
     const char* id;
     const char* text;
+    int32_t length;
+    bool stable;
     Clay_Color color;
     uint16_t font_size;
     uint16_t font_id;
@@ -297,6 +346,8 @@ static void ClayText_factory(void* _raw_props) {
 static void ClayText_impl(ClayText_props props) {
     cel_has(ClayTextConfig,
         .text = props.text,
+        .length = props.length,
+        .stable = props.stable,
         .color = (props.color.r || props.color.g || props.color.b || props.color.a)
             ? props.color : (Clay_Color){255, 255, 255, 255},
         .font_size = props.font_size ? props.font_size : 16,
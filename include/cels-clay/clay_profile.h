@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Profile - Per-phase frame timing
+ *
+ * Monotonic timestamps around each phase of a frame, kept in a ring of the
+ * last CEL_CLAY_PROFILE_HISTORY frames:
+ *
+ *   WALK        Tree walk emitting Clay elements (all surfaces)
+ *   CLOSE       Closing each surface's root element
+ *   END_LAYOUT  Clay_EndLayout: sizing, positioning, command generation
+ *   DISPATCH    ClayRenderDispatch: hashing, diffing, publishing
+ *   DRAW        Backend drawing the published commands
+ *   PRESENT     Backend presenting the frame (ncurses doupdate). The SDL3
+ *               renderer does not present -- wrap SDL_RenderPresent with
+ *               CEL_CLAY_PROFILE_BEGIN/END to record it.
+ *   FRAME       Wall time from one layout system run to the next
+ *
+ * Layout phases add up across surfaces; with parallel layout they are the
+ * sum over worker threads, not wall time. A frame's record is completed
+ * when the next frame's layout starts.
+ *
+ * Build with -DCELS_CLAY_PROFILE=ON. When off, the macros expand to
+ * nothing and none of the API below exists -- guard callers with
+ * #ifdef CELS_CLAY_PROFILE.
+ */
+
+#ifndef CELS_CLAY_PROFILE_H
+#define CELS_CLAY_PROFILE_H
+
+#include <stdint.h>
+
+#ifdef CELS_CLAY_PROFILE
+
+#ifndef CEL_CLAY_PROFILE_HISTORY
+#define CEL_CLAY_PROFILE_HISTORY 256
+#endif
+
+typedef enum ClayProfilePhase {
+    CEL_CLAY_PHASE_WALK = 0,
+    CEL_CLAY_PHASE_CLOSE,
+    CEL_CLAY_PHASE_END_LAYOUT,
+    CEL_CLAY_PHASE_DISPATCH,
+    CEL_CLAY_PHASE_DRAW,
+    CEL_CLAY_PHASE_PRESENT,
+    CEL_CLAY_PHASE_FRAME,
+    CEL_CLAY_PHASE_COUNT
+} ClayProfilePhase;
+
+typedef struct ClayProfileFrame {
+    uint32_t frame;                             /* Sequence number, from 1 */
+    uint64_t start_ns;                          /* Monotonic start of the frame */
+    uint64_t phase_ns[CEL_CLAY_PHASE_COUNT];
+} ClayProfileFrame;
+
+typedef struct ClayProfileSummary {
+    uint32_t samples;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    uint64_t mean_ns;
+} ClayProfileSummary;
+
+/* ============================================================================
+ * Profile API
+ * ============================================================================
+ *
+ * cel_clay_profile_history: Copy up to `max` completed frames into `out`,
+ *   oldest first. Returns the number copied.
+ * cel_clay_profile_summarize: Percentiles of every phase over the frames
+ *   in the ring (out has CEL_CLAY_PHASE_COUNT entries).
+ * cel_clay_profile_phase_name: "walk", "close", ... for reports.
+ * cel_clay_profile_reset: Drop the history.
+ */
+extern int32_t cel_clay_profile_history(ClayProfileFrame* out, int32_t max);
+extern void cel_clay_profile_summarize(ClayProfileSummary* out);
+extern const char* cel_clay_profile_phase_name(ClayProfilePhase phase);
+extern void cel_clay_profile_reset(void);
+
+/* Internal: monotonic clock, phase accumulation (any thread), frame
+ * boundary (layout system, main thread) */
+extern uint64_t _cel_clay_profile_now(void);
+extern void _cel_clay_profile_add(ClayProfilePhase phase, uint64_t ns);
+extern void _cel_clay_profile_frame_begin(void);
+
+#define CEL_CLAY_PROFILE_BEGIN(name) \
+    uint64_t _cel_clay_profile_start_##name = _cel_clay_profile_now()
+#define CEL_CLAY_PROFILE_END(name, phase) \
+    _cel_clay_profile_add((phase), _cel_clay_profile_now() - _cel_clay_profile_start_##name)
+#define CEL_CLAY_PROFILE_FRAME_BEGIN() _cel_clay_profile_frame_begin()
+
+#else
+
+#define CEL_CLAY_PROFILE_BEGIN(name) ((void)0)
+#define CEL_CLAY_PROFILE_END(name, phase) ((void)0)
+#define CEL_CLAY_PROFILE_FRAME_BEGIN() ((void)0)
+
+#endif /* CELS_CLAY_PROFILE */
+
+#endif /* CELS_CLAY_PROFILE_H */
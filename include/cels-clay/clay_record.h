@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Render Recording - Capture and replay render bridge frames
+ *
+ * The recorder sits on the render bridge: while active, every dispatched
+ * frame is appended to a binary file -- each surface's render commands
+ * (bounding boxes, render data), the bytes of its text commands, its
+ * layout dimensions, and the frame number and delta time. The replayer
+ * memory-maps such a file and decodes frames back into ClayRenderSnapshot
+ * form, so renderers can be driven with production frames without the
+ * entity tree or layout:
+ *
+ *   cel_clay_record_start("session.clayrec");
+ *   ... run the app ...
+ *   cel_clay_record_stop();
+ *
+ *   ClayReplay* replay = cel_clay_replay_open("session.clayrec", 0);
+ *   ClayRenderSnapshot frame;
+ *   for (int32_t i = 0; i < cel_clay_replay_frame_count(replay); i++) {
+ *       cel_clay_replay_frame(replay, i, &frame);
+ *       ... draw frame.surfaces, or hand it to the ECS backends with
+ *           cel_clay_render_publish_snapshot(&frame) ...
+ *   }
+ *   cel_clay_replay_close(replay);
+ *
+ * File format (native byte order; a file from a machine of the other
+ * endianness is rejected): a 16-byte header, then one record per frame.
+ * A frame record is a header with its total size, then per surface a
+ * surface header, its fixed-size command records and its text bytes,
+ * each section padded to 8 bytes. The file is append-only: recording to
+ * an existing file adds frames after the ones it holds. A frame cut short
+ * by a crash is ignored on replay, and cut off before new frames are
+ * appended.
+ *
+ * Pointer fields (userData, imageData, customData) are recorded as their
+ * values. They only mean something inside the recording process, so the
+ * replayer clears them unless CEL_CLAY_REPLAY_KEEP_POINTERS is passed --
+ * for in-process replay, or userData holding packed flags (such as the
+ * ncurses text attributes) rather than an address.
+ */
+
+#ifndef CELS_CLAY_RECORD_H
+#define CELS_CLAY_RECORD_H
+
+#include "cels-clay/clay_render.h"
+#include "clay.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ============================================================================
+ * Recorder
+ * ============================================================================
+ *
+ * cel_clay_record_start: Append every following dispatch to `path`
+ *   (created if missing). Stops a recording in progress first. A
+ *   trailing incomplete frame is truncated away. False if the file cannot
+ *   be opened or is not a recording.
+ * cel_clay_record_stop: Flush and close the recording. Also called when
+ *   the engine shuts down.
+ * cel_clay_recording: Whether a recording is in progress.
+ */
+extern bool cel_clay_record_start(const char* path);
+extern void cel_clay_record_stop(void);
+extern bool cel_clay_recording(void);
+
+/* ============================================================================
+ * Replayer
+ * ============================================================================
+ *
+ * cel_clay_replay_open: Map a recording and index its frames. NULL if the
+ *   file cannot be read or is not a recording. Falls back to reading the
+ *   file into memory where mmap is unavailable.
+ * cel_clay_replay_frame: Decode frame `index` into *out. The commands are
+ *   owned by the replay and valid until the next call on it; text points
+ *   into the mapped file. False for an out-of-range index.
+ * cel_clay_replay_close: Unmap the file and free decoded frames.
+ */
+#define CEL_CLAY_REPLAY_KEEP_POINTERS 0x1u
+
+typedef struct ClayReplay ClayReplay;
+
+extern ClayReplay* cel_clay_replay_open(const char* path, uint32_t flags);
+extern int32_t cel_clay_replay_frame_count(const ClayReplay* replay);
+extern bool cel_clay_replay_frame(ClayReplay* replay, int32_t index,
+                                  ClayRenderSnapshot* out);
+extern void cel_clay_replay_close(ClayReplay* replay);
+
+/* ============================================================================
+ * Render Bridge Hook (internal)
+ * ============================================================================
+ *
+ * _cel_clay_record_frame: Called by the render dispatch with the data it
+ *   just published. No-op unless recording.
+ */
+extern void _cel_clay_record_frame(const ClayRenderableData* surfaces, int32_t count);
+
+#endif /* CELS_CLAY_RECORD_H */
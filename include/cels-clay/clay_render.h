@@ -23,10 +23,21 @@
  * commands each frame.
  *
  * Backend renderers register their systems via cels_system_declare() and
- * read ClayRenderableData from the singleton entity.
+ * draw every surface's ClayRenderableData in surface order:
  *
- * Advanced users (custom systems):
+ *   for (int32_t i = 0; i < cel_clay_surface_count(); i++) {
+ *       const ClayRenderableData* data = cel_clay_get_surface_render_data(i);
+ *       ... draw data->render_commands ...
+ *   }
+ *
+ * Incremental backends read data->diff and redraw only its damage.
+ *
+ * Advanced users (custom systems, single surface):
  *   Clay_RenderCommandArray cmds = cel_clay_get_render_commands();
+ *
+ * Render thread (ClayEngineConfig.render_buffers = 2 or 3):
+ *   const ClayRenderSnapshot* snap = cel_clay_snapshot_acquire();
+ *   if (snap) { ... draw snap->surfaces ...; cel_clay_snapshot_release(snap); }
  */
 
 #ifndef CELS_CLAY_RENDER_H
@@ -37,14 +48,87 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/* ============================================================================
+ * Render Diff
+ * ============================================================================
+ *
+ * Published with every ClayRenderableData: how the surface's commands
+ * changed since the previous frame, matched by element id and command
+ * type. added/moved/restyled carry the command's index in this frame's
+ * render_commands; removed commands are gone (index -1) and carry their
+ * last bounds. A moved command's previous_bounds is where it was drawn.
+ * Restyled covers any other change -- color, text, corner radius -- and a
+ * command that now draws before one it used to follow.
+ *
+ * damage is a short list of rectangles (layout units, possibly
+ * overlapping) covering every pixel that may differ; damage_bounds
+ * encloses them all. A backend that keeps its last frame can repaint
+ * incrementally: clip to each damage rectangle, clear it, and redraw --
+ * in order -- every command of every surface that intersects it.
+ *
+ * full: There is no usable previous frame (first frame, resize, surfaces
+ *   added, removed or reordered); damage is the whole layout area and the
+ *   change lists are empty. Repaint everything.
+ *
+ * A clean surface (dirty == false) has an empty diff. The lists are valid
+ * until the next dispatch.
+ */
+typedef enum ClayRenderChangeKind {
+    CLAY_RENDER_CHANGE_ADDED = 0,
+    CLAY_RENDER_CHANGE_REMOVED,
+    CLAY_RENDER_CHANGE_MOVED,
+    CLAY_RENDER_CHANGE_RESTYLED,
+} ClayRenderChangeKind;
+
+typedef struct ClayRenderChange {
+    uint32_t id;                        /* Render command id */
+    Clay_RenderCommandType command_type;
+    int32_t index;                      /* Index in render_commands, -1 if removed */
+    Clay_BoundingBox bounds;
+    Clay_BoundingBox previous_bounds;   /* Moved: bounds in the previous frame */
+} ClayRenderChange;
+
+typedef struct ClayRenderDiff {
+    bool full;
+    const ClayRenderChange* added;
+    int32_t added_count;
+    const ClayRenderChange* removed;
+    int32_t removed_count;
+    const ClayRenderChange* moved;
+    int32_t moved_count;
+    const ClayRenderChange* restyled;
+    int32_t restyled_count;
+    const Clay_BoundingBox* damage;
+    int32_t damage_count;
+    Clay_BoundingBox damage_bounds;
+} ClayRenderDiff;
+
 /* ============================================================================
  * ClayRenderableData Component
  * ============================================================================
  *
- * Attached to the singleton ClayRenderTarget entity. Updated each frame by
- * the render dispatch system with current render commands, layout dimensions,
- * frame metadata, and dirty flag. Backend renderers read this component
- * from the singleton entity.
+ * Published per ClaySurface each frame by the render dispatch system with
+ * the surface's render commands, layout dimensions, frame metadata, and
+ * dirty flag. The first surface's data is also attached to the singleton
+ * ClayRenderTarget entity.
+ *
+ * content_hash covers every command field that affects drawing, including
+ * the bytes of text commands. dirty is set when it (or the surface's
+ * layout dimensions) differ from the surface's previous frame, so a
+ * backend may skip drawing a surface -- or the whole frame -- that is not
+ * dirty, provided its last output is still on screen.
+ *
+ * render_commands is culled: commands whose bounding box lies outside the
+ * surface or outside the active scissor clip are dropped, and so are
+ * SCISSOR_START/END ranges whose clip is empty, with everything between
+ * them. culled_commands counts the commands dropped from this frame's
+ * list, culled_ranges the scissor ranges dropped whole. Indices in diff
+ * refer to the culled list.
+ *
+ * The singleton is updated in place: ecs_modified (OnSet observers,
+ * change detection) fires only when the first surface is dirty or the
+ * surface set changed. frame_number and delta_time are refreshed every
+ * frame regardless.
  */
 typedef struct ClayRenderableData {
     Clay_RenderCommandArray render_commands;
@@ -52,7 +136,12 @@ typedef struct ClayRenderableData {
     float layout_height;
     uint32_t frame_number;
     float delta_time;
-    bool dirty;
+    bool dirty;                 /* Content changed since the previous frame */
+    cels_entity_t surface;      /* ClaySurface entity the commands belong to */
+    uint64_t content_hash;      /* Hash of render_commands and their text */
+    const ClayRenderDiff* diff; /* Changes since the previous frame (NULL = unknown) */
+    int32_t culled_commands;    /* Commands culled from render_commands */
+    int32_t culled_ranges;      /* Fully clipped scissor ranges culled */
 } ClayRenderableData;
 
 extern cels_entity_t ClayRenderableData_id;
@@ -62,10 +151,60 @@ extern void ClayRenderableData_register(void);
  * Public Getter API
  * ============================================================================
  *
- * For advanced users who want raw render commands. Returns the most recent
- * Clay_RenderCommandArray from the layout pass.
+ * cel_clay_get_render_commands: Most recent Clay_RenderCommandArray of the
+ *   first surface.
+ * cel_clay_surface_count / cel_clay_get_surface_render_data: Per-surface
+ *   data published by the last dispatch, in surface order. The pointer is
+ *   valid until the next dispatch; NULL for an out-of-range index.
+ * cel_clay_render_publish_snapshot: Make the next dispatch publish
+ *   `snapshot` -- e.g. a replayed frame (clay_record.h) -- instead of the
+ *   layout output, so backends draw it like any other frame. It must stay
+ *   valid until that dispatch has run. Declared after ClayRenderSnapshot.
  */
 extern Clay_RenderCommandArray cel_clay_get_render_commands(void);
+extern int32_t cel_clay_surface_count(void);
+extern const ClayRenderableData* cel_clay_get_surface_render_data(int32_t index);
+
+/* ============================================================================
+ * Render Snapshots
+ * ============================================================================
+ *
+ * ClayRenderableData and cel_clay_get_render_commands are views into each
+ * Clay context's command array and the frame arena, both rebuilt by the
+ * next layout pass -- they must be drawn before it. With
+ * ClayEngineConfig.render_buffers set, the dispatch additionally copies
+ * every frame into one of 2-3 snapshot buffers that own their commands
+ * and text, so a render thread can draw frame N while layout builds N+1.
+ *
+ * cel_clay_snapshot_acquire: Latest complete snapshot, held until released
+ *   (NULL if snapshots are off or none was published yet). Compare
+ *   frame_number to skip frames already drawn. Any thread.
+ * cel_clay_snapshot_release: Return a snapshot to the ring. Release before
+ *   acquiring the next one, and before the engine shuts down.
+ *
+ * The dispatch never writes into a held buffer. With 3 buffers a frame is
+ * published every dispatch even while the render thread holds one; with
+ * 2, the unread latest snapshot is overwritten, and a frame is dropped
+ * while the reader holds the only other buffer. userData, imageData and
+ * customData pointers are copied as-is.
+ */
+typedef struct ClayRenderSnapshotSurface {
+    cels_entity_t surface;
+    Clay_RenderCommandArray render_commands;   /* Owned by the snapshot */
+    float layout_width;
+    float layout_height;
+} ClayRenderSnapshotSurface;
+
+typedef struct ClayRenderSnapshot {
+    uint32_t frame_number;
+    float delta_time;
+    int32_t surface_count;
+    const ClayRenderSnapshotSurface* surfaces;
+} ClayRenderSnapshot;
+
+extern const ClayRenderSnapshot* cel_clay_snapshot_acquire(void);
+extern void cel_clay_snapshot_release(const ClayRenderSnapshot* snapshot);
+extern void cel_clay_render_publish_snapshot(const ClayRenderSnapshot* snapshot);
 
 /* ============================================================================
  * Render Bridge Lifecycle
@@ -76,9 +215,12 @@ extern Clay_RenderCommandArray cel_clay_get_render_commands(void);
  *
  * _cel_clay_render_init: Creates singleton entity, registers component.
  * _cel_clay_render_system_register: Registers dispatch system at OnStore phase.
+ * _cel_clay_render_cleanup: Frees per-surface data and snapshot buffers,
+ *   stops a recording in progress.
  */
 extern void _cel_clay_render_init(void);
 extern void _cel_clay_render_system_register(void);
+extern void _cel_clay_render_cleanup(void);
 
 /* ============================================================================
  * CelClayBorderDecor - Renderer-drawn border decoration
@@ -71,11 +71,15 @@ CEL_Module(Clay_SDL3);
  * window:    SDL_Window* to create the renderer for. Required.
  * font_path: Path to a .ttf font file for text rendering.
  *            Required -- text rendering fails without a font.
- * font_size: Font size in points. Default: 16 if 0. */
+ * font_size: Font size in points. Default: 16 if 0.
+ * retained:  Draw into a persistent canvas texture and repaint only the
+ *            damage of each frame's render diff; the canvas is copied to
+ *            the render target every frame. Default: false (redraw all). */
 typedef struct ClaySDL3Config {
     SDL_Window* window;
     const char* font_path;
     int font_size;
+    bool retained;
 } ClaySDL3Config;
 
 /* ============================================================================
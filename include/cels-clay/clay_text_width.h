@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Text Width - Terminal column width of UTF-8 text
+ *
+ * Measures UTF-8 slices in place (no copy, no NUL terminator, no locale):
+ * runs of printable ASCII are skipped 16 or 32 bytes at a time with SSE2 or
+ * AVX2 (when the compiler targets them, scalar loop otherwise), and every
+ * other code point is looked up in a generated two-stage width table built
+ * into the library -- O(1), and identical on every host regardless of libc
+ * version or locale.
+ *
+ * Widths follow wcwidth conventions: 2 for East Asian Wide/Fullwidth,
+ * 0 for combining marks, format and control characters, 1 otherwise.
+ * Invalid UTF-8 bytes count as one column each.
+ *
+ * Internal to cels-clay: used by the ncurses renderer. Not for direct
+ * consumer use.
+ */
+
+#ifndef CELS_CLAY_TEXT_WIDTH_H
+#define CELS_CLAY_TEXT_WIDTH_H
+
+#include <stdint.h>
+
+/* Column extent of a text slice: widest line and number of lines */
+typedef struct _CelClayTextExtent {
+    int32_t columns;
+    int32_t lines;      /* 1 + number of '\n' (0 for empty text) */
+} _CelClayTextExtent;
+
+/* Width of one code point in terminal columns (0, 1 or 2) */
+extern int _cel_clay_codepoint_width(uint32_t codepoint);
+
+/* Decode one UTF-8 sequence at text[0..length). Returns bytes consumed
+ * (>= 1 when length > 0); invalid sequences yield U+FFFD and consume one
+ * byte. */
+extern int32_t _cel_clay_utf8_decode(const char* text, int32_t length,
+                                     uint32_t* out_codepoint);
+
+/* Measure a UTF-8 slice */
+extern _CelClayTextExtent _cel_clay_text_extent(const char* text, int32_t length);
+
+/* Bytes of the longest prefix of text[0..length) that fits in max_columns
+ * (stops at the first newline). Never splits a UTF-8 sequence. */
+extern int32_t _cel_clay_text_fit(const char* text, int32_t length, int32_t max_columns);
+
+#endif /* CELS_CLAY_TEXT_WIDTH_H */
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Trace - Chrome trace event export of layout and render spans
+ *
+ * Writes nested spans to a JSON file in Chrome trace event format, which
+ * chrome://tracing and ui.perfetto.dev load directly:
+ *
+ *   layout     One surface's layout pass (args: surface entity, text
+ *              measurement calls and their total microseconds -- text
+ *              measurement is aggregated rather than traced per call)
+ *   subtree    A container whose subtree has at least subtree_threshold
+ *              nodes (args: entity, nodes)
+ *   dispatch   The render bridge publishing a frame
+ *   draw       One backend command batch: a surface's commands drawn by the
+ *              ncurses, SDL3 or headless renderer (args: commands)
+ *
+ * Each thread appends finished spans to its own ring buffer with no locks.
+ * A writer thread started with the trace drains every ring into the file
+ * every flush_interval_ms, or sooner when a ring reaches half full, so no
+ * file I/O happens in the frame pipeline. A ring that fills up between
+ * two drains drops spans; the file gets an "events_dropped" marker.
+ *
+ * The file is a bare JSON array and is left unterminated until
+ * cel_clay_trace_stop, which the trace viewers accept -- a trace cut short
+ * by a crash still loads.
+ *
+ * Build with -DCELS_CLAY_TRACE=ON. When off, the hook macros expand to
+ * nothing (BEGIN to false) and none of the API below exists -- guard
+ * callers with #ifdef CELS_CLAY_TRACE.
+ *
+ * Usage:
+ *   cel_clay_trace_start("frames.json", NULL);
+ *   ... run frames ...
+ *   cel_clay_trace_stop();
+ */
+
+#ifndef CELS_CLAY_TRACE_H
+#define CELS_CLAY_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CELS_CLAY_TRACE
+
+#include <stdatomic.h>
+
+/* ============================================================================
+ * ClayTraceConfig
+ * ============================================================================
+ *
+ * subtree_threshold: Minimum subtree size in nodes (the container
+ *                    included) for a container to get a span. Default 64.
+ * events_per_thread: Ring capacity per thread, rounded up to a power of
+ *                    two. Default 16384.
+ * flush_interval_ms: How often the writer thread drains the rings.
+ *                    Default 100.
+ *
+ * Zero fields take the defaults.
+ */
+typedef struct ClayTraceConfig {
+    int32_t subtree_threshold;
+    int32_t events_per_thread;
+    int32_t flush_interval_ms;
+} ClayTraceConfig;
+
+/* ============================================================================
+ * Trace API
+ * ============================================================================
+ *
+ * cel_clay_trace_start: Create `path` and start tracing. Returns false
+ *   (and logs) if the file or the writer thread can't be created, or a
+ *   trace is already running.
+ * cel_clay_trace_stop: Stop the writer thread, write what is left, close
+ *   the file. Call between frames.
+ * cel_clay_trace_active: Whether a trace is running.
+ */
+extern bool cel_clay_trace_start(const char* path, const ClayTraceConfig* config);
+extern void cel_clay_trace_stop(void);
+extern bool cel_clay_trace_active(void);
+
+/* ============================================================================
+ * Internal Hooks
+ * ============================================================================
+ *
+ * Spans nest per thread. CEL_CLAY_TRACE_BEGIN (and CEL_CLAY_TRACE_SUBTREE,
+ * which also applies the size threshold) yields whether a span was
+ * opened; the caller ends it with CEL_CLAY_TRACE_END. Spans whose end is
+ * found later by position instead carry a key: CEL_CLAY_TRACE_END_KEY
+ * ends the innermost span only if it was opened with that key (the layout
+ * walk keys subtree spans by walk depth). Unkeyed spans use key -1.
+ *
+ * Args attach to the innermost open span; names are string literals, up
+ * to four per span. _cel_clay_trace_measure adds one text measurement to
+ * the thread's tally; CEL_CLAY_TRACE_MEASURE_ARGS attaches the tally to
+ * the innermost span and resets it.
+ */
+extern atomic_bool _cel_clay_trace_on;
+extern int32_t _cel_clay_trace_subtree_threshold;
+
+extern bool _cel_clay_trace_begin(const char* name, int32_t key);
+extern void _cel_clay_trace_arg(const char* name, uint64_t value);
+extern void _cel_clay_trace_end(void);
+extern void _cel_clay_trace_end_key(int32_t key);
+extern uint64_t _cel_clay_trace_now(void);
+extern void _cel_clay_trace_measure(uint64_t ns);
+extern void _cel_clay_trace_measure_args(void);
+
+#define CEL_CLAY_TRACING() \
+    atomic_load_explicit(&_cel_clay_trace_on, memory_order_relaxed)
+#define CEL_CLAY_TRACE_BEGIN(name, key) \
+    (CEL_CLAY_TRACING() && _cel_clay_trace_begin((name), (key)))
+#define CEL_CLAY_TRACE_SUBTREE(nodes, key) \
+    (CEL_CLAY_TRACING() && (nodes) >= _cel_clay_trace_subtree_threshold && \
+     _cel_clay_trace_begin("subtree", (key)))
+#define CEL_CLAY_TRACE_ARG(name, value) _cel_clay_trace_arg((name), (uint64_t)(value))
+#define CEL_CLAY_TRACE_MEASURE_ARGS() _cel_clay_trace_measure_args()
+#define CEL_CLAY_TRACE_END() _cel_clay_trace_end()
+#define CEL_CLAY_TRACE_END_KEY(key) \
+    do { if (CEL_CLAY_TRACING()) _cel_clay_trace_end_key(key); } while (0)
+
+#else
+
+#define CEL_CLAY_TRACING() false
+#define CEL_CLAY_TRACE_BEGIN(name, key) false
+#define CEL_CLAY_TRACE_SUBTREE(nodes, key) false
+#define CEL_CLAY_TRACE_ARG(name, value) ((void)0)
+#define CEL_CLAY_TRACE_MEASURE_ARGS() ((void)0)
+#define CEL_CLAY_TRACE_END() ((void)0)
+#define CEL_CLAY_TRACE_END_KEY(key) ((void)0)
+
+#endif /* CELS_CLAY_TRACE */
+
+#endif /* CELS_CLAY_TRACE_H */
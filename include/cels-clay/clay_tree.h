@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Layout Tree Cache - Flattened entity hierarchy for the layout walk
+ *
+ * The layout system used to rediscover the UI tree every frame with
+ * ecs_children + ecs_get_id per entity. The tree cache keeps a persistent
+ * depth-first array of layout nodes instead. Each node stores its entity,
+ * its node kind, a copy of the Clay property component that drives it, and
+ * the extent of its subtree, so the walk is a linear scan of the array.
+ *
+ * The array is rebuilt only when flecs observers report a structural change
+ * (ChildOf, CELS_SIBLING_ORDER, Clay component add/remove). Component value
+ * changes (OnSet) patch the copy in the existing node in place. Rebuilds
+ * reuse each parent's sorted child list unless one of its children was
+ * added, removed or reordered.
+ *
+ * Internal to cels-clay: used by clay_layout.c. Not for direct consumer use.
+ */
+
+#ifndef CELS_CLAY_TREE_H
+#define CELS_CLAY_TREE_H
+
+#include <cels/cels.h>
+#include <flecs.h>
+#include "cels-clay/clay_layout.h"
+#include "cels-clay/clay_primitives.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ============================================================================
+ * Layout Node
+ * ============================================================================
+ *
+ * Node kinds follow the walker's component priority: an entity with both
+ * ClayContainerConfig and ClayTextConfig is a container. Entities without
+ * any layout component are passthrough nodes -- they emit nothing but their
+ * children are still laid out at that point in the tree.
+ *
+ * Subtree extent: the children of node i occupy [i + 1, end). A node's
+ * next sibling starts at its end index. Direct children are also indexed
+ * (child_count slots) for O(1) positional access.
+ *
+ * Windowed containers (ClayContainerConfig.child_limit > 0) are leaves in
+ * the cached array (end = i + 1): their children are materialized per
+ * window by _cel_clay_tree_window instead.
+ */
+typedef enum _CelClayNodeKind {
+    CEL_CLAY_NODE_PASSTHROUGH = 0,
+    CEL_CLAY_NODE_SURFACE,
+    CEL_CLAY_NODE_CONTAINER,
+    CEL_CLAY_NODE_TEXT,
+    CEL_CLAY_NODE_SPACER,
+    CEL_CLAY_NODE_IMAGE,
+} _CelClayNodeKind;
+
+typedef struct _CelClayNode {
+    ecs_entity_t entity;
+    int32_t parent;         /* Node index of the parent (-1 for surfaces) */
+    int32_t surface;        /* Node index of the owning surface */
+    int32_t end;            /* One past the last node of this subtree */
+    int32_t first_child;    /* First child slot (internal to clay_tree.c) */
+    int32_t child_count;    /* Number of direct children (also when windowed) */
+    int32_t window_first;   /* Prepared window node range (windowed nodes) */
+    int32_t window_end;
+    uint32_t window_sync;   /* Sync generation the window was prepared in */
+    uint32_t change_sync;   /* Last sync that saw a change in this subtree */
+    uint8_t kind;           /* _CelClayNodeKind */
+    bool has_border;        /* Container carries a ClayBorderStyle */
+    bool windowed;          /* Children materialized per window */
+    ClayBorderStyle border;
+    union {
+        ClaySurfaceConfig surface;
+        ClayContainerConfig container;
+        ClayTextConfig text;
+        ClaySpacerConfig spacer;
+        ClayImageConfig image;
+    } config;
+} _CelClayNode;
+
+/* ============================================================================
+ * Tree Cache API
+ * ============================================================================
+ *
+ * _cel_clay_tree_invalidate: Make the next sync rebuild the array,
+ *   reloading every node's component copies (for edits the observers
+ *   missed; see cel_clay_layout_invalidate).
+ * _cel_clay_tree_sync: Rebuild the array if the structure changed. Returns
+ *   true when the tree differs from the previous sync (rebuild or value
+ *   change), i.e. the layout must run again.
+ * _cel_clay_tree_surface_changed: Whether the last sync saw a change in
+ *   the given surface's subtree (or its config).
+ * _cel_clay_tree_subtree_changed: The same for the subtree of one cached
+ *   node (always true for transient window nodes).
+ * _cel_clay_tree_paint_changes: Entities whose changes in the last sync
+ *   were paint-only (container bg, text color). They do not count as a
+ *   change of their surface; the node copies already hold the new colors.
+ * _cel_clay_tree_nodes: Current node array. Surfaces are the top-level
+ *   nodes: iterate them with `for (i = 0; i < count; i = nodes[i].end)`.
+ * _cel_clay_tree_find: Node index of an entity, or -1 if not in the tree.
+ * _cel_clay_tree_window: Node range [*out_first, *out_end) holding the
+ *   subtrees of children [start, start + count) of a node, in sibling
+ *   order (clamped to the child count). For windowed nodes the subtrees
+ *   are materialized into transient nodes past the cached tree, valid
+ *   until the next sync. O(count + window subtree size), independent of
+ *   the total child count. Returns false for an empty range. May grow the
+ *   node array: re-fetch pointers from _cel_clay_tree_nodes afterwards.
+ * _cel_clay_tree_window_ready: Whether _cel_clay_tree_window for that
+ *   range is a read-only lookup (flattened node, or the prepared window).
+ *   Anything else materializes, which is main-thread only.
+ * _cel_clay_tree_prepare_windows: Materialize every configured window
+ *   (child_offset/child_limit) in a surface's subtree up front. Afterwards
+ *   _cel_clay_tree_window for those windows is a read-only lookup, so the
+ *   surface can be walked on a worker thread.
+ */
+extern void _cel_clay_tree_observers_register(ecs_world_t* world);
+extern void _cel_clay_tree_cleanup(void);
+extern void _cel_clay_tree_invalidate(void);
+extern bool _cel_clay_tree_sync(ecs_world_t* world);
+extern bool _cel_clay_tree_surface_changed(ecs_entity_t surface);
+extern bool _cel_clay_tree_subtree_changed(int32_t node);
+extern const ecs_entity_t* _cel_clay_tree_paint_changes(int32_t* out_count);
+extern const _CelClayNode* _cel_clay_tree_nodes(int32_t* out_count);
+extern int32_t _cel_clay_tree_find(ecs_entity_t entity);
+extern bool _cel_clay_tree_window(int32_t node, int32_t start, int32_t count,
+                                  int32_t* out_first, int32_t* out_end);
+extern bool _cel_clay_tree_window_ready(int32_t node, int32_t start, int32_t count);
+extern void _cel_clay_tree_prepare_windows(int32_t surface);
+
+#endif /* CELS_CLAY_TREE_H */
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Cells - Implementation
+ *
+ * NOTE: This file compiles in the CONSUMER's context (INTERFACE library).
+ */
+
+#include "cels-clay/clay_cells.h"
+#include "clay.h"
+#include <math.h>
+
+/* ============================================================================
+ * Coordinate Mapping
+ * ============================================================================ */
+
+_CelClayCellRect _cel_clay_bbox_to_cells(Clay_BoundingBox bbox, float aspect_ratio) {
+    /* Scale horizontal values by aspect ratio */
+    float x = bbox.x * aspect_ratio;
+    float w = bbox.width * aspect_ratio;
+
+    /* Round to nearest cell */
+    int cx = (int)roundf(x);
+    int cy = (int)roundf(bbox.y);
+    int cw = (int)roundf(w);
+    int ch = (int)roundf(bbox.height);
+
+    /* Minimum 1 cell for non-zero dimensions */
+    if (bbox.width > 0 && cw < 1) cw = 1;
+    if (bbox.height > 0 && ch < 1) ch = 1;
+
+    return (_CelClayCellRect){ .x = cx, .y = cy, .w = cw, .h = ch };
+}
+
+/* ============================================================================
+ * Parent Background
+ * ============================================================================
+ *
+ * Clay emits commands depth-first: a parent's RECTANGLE always precedes
+ * its children's commands. Scanning backwards from the command, the first
+ * containing RECTANGLE is the innermost parent.
+ */
+
+Clay_Color _cel_clay_find_parent_bg(Clay_RenderCommandArray commands, int32_t index) {
+    Clay_BoundingBox tb = Clay_RenderCommandArray_Get(&commands, index)->boundingBox;
+
+    for (int32_t j = index - 1; j >= 0; j--) {
+        Clay_RenderCommand* prev = Clay_RenderCommandArray_Get(&commands, j);
+        if (prev->commandType != CLAY_RENDER_COMMAND_TYPE_RECTANGLE) continue;
+
+        /* Skip transparent rectangles (alpha < 2 = border-only, no fill) */
+        Clay_Color bg = prev->renderData.rectangle.backgroundColor;
+        if (bg.a < 2.0f) continue;
+
+        Clay_BoundingBox rb = prev->boundingBox;
+        if (rb.x <= tb.x && rb.y <= tb.y &&
+            rb.x + rb.width >= tb.x + tb.width &&
+            rb.y + rb.height >= tb.y + tb.height) {
+            return bg;
+        }
+    }
+
+    return (Clay_Color){0, 0, 0, 0};  /* alpha=0: no parent bg found */
+}
@@ -24,13 +24,20 @@
  *   Clay_Engine_configure(config) -- store config before module init
  *   cels_register(Clay_Engine)    -- initialize Clay via module system
  *
- * The arena is allocated with at least Clay_MinMemorySize() bytes.
- * Consumer can override via ClayEngineConfig.arena_size.
+ * The arena is allocated with at least Clay_MinMemorySize() bytes for the
+ * current element/word limits. Consumer can override via
+ * ClayEngineConfig.arena_size and set the starting limits with max_elements
+ * and max_measure_words; the limits grow when a pass exceeds them.
  *
  * NOTE: This file compiles in the CONSUMER's context (INTERFACE library).
  * NOTE: This file does NOT define CLAY_IMPLEMENTATION -- that's in clay_impl.c.
  */
 
+/* mmap flags (MAP_ANONYMOUS, MAP_NORESERVE) and mincore under strict -std */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
 #include "cels-clay/clay_engine.h"
 #include "cels-clay/clay_layout.h"
 #include "cels-clay/clay_render.h"
@@ -40,6 +47,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define CEL_CLAY_HAS_MMAP 1
+#endif
 
 /* ============================================================================
  * Static State
@@ -52,9 +67,21 @@ static ClayEngineConfig g_clay_config = {0};
  * arena.memory to a 64-byte cache-line boundary, so arena.memory != malloc result */
 static void* g_clay_arena_memory = NULL;
 
-/* Clay context pointer -- stored for future multi-context support */
+/* Primary Clay context: created at module init, configured by renderers
+ * (measure function, scroll input) and adopted by the first ClaySurface.
+ * Further surfaces get their own contexts via _cel_clay_context_create. */
 static Clay_Context* g_clay_context = NULL;
 
+/* Element / measured-word limits of newly created contexts. Start from the
+ * config and double on capacity overflow (_cel_clay_grow_limits). */
+#define CEL_CLAY_DEFAULT_MAX_ELEMENTS 8192
+#define CEL_CLAY_DEFAULT_MAX_MEASURE_WORDS 16384
+static uint32_t g_max_elements = CEL_CLAY_DEFAULT_MAX_ELEMENTS;
+static uint32_t g_max_measure_words = CEL_CLAY_DEFAULT_MAX_MEASURE_WORDS;
+
+/* Bumped by cel_clay_trim_arenas; surfaces compare it before each pass */
+static uint32_t g_trim_generation = 0;
+
 /* ============================================================================
  * State Singleton
  * ============================================================================ */
@@ -62,20 +89,46 @@ static Clay_Context* g_clay_context = NULL;
 CEL_State(ClayEngineState);
 static struct ClayEngineState ClayEngineState = {0};
 
+/* ============================================================================
+ * Context Header
+ * ============================================================================
+ *
+ * Every context allocation starts with a header, followed by the Clay
+ * arena. The header is the error handler's userData: capacity errors are
+ * recorded there for the layout system, which grows the limits and
+ * rebuilds the context between passes (see _cel_clay_context_take_overflow).
+ * A context is only used by one thread at a time, so no locking is needed.
+ */
+
+typedef struct {
+    uint32_t overflow;      /* CEL_CLAY_OVERFLOW_* raised since the last take */
+    bool mapped;            /* Allocation is an mmap reservation (lazy_arena) */
+    size_t size;            /* Bytes allocated, header included */
+    Clay_Context* context;  /* Context living in this allocation */
+} _CelClayContextHeader;
+
+/* Keeps the arena that follows the header cache-line aligned */
+#define CEL_CLAY_CONTEXT_HEADER_SIZE 64
+
 /* ============================================================================
  * Error Handler
  * ============================================================================ */
 
 static void clay_error_handler(Clay_ErrorData error) {
+    _CelClayContextHeader* header = (_CelClayContextHeader*)error.userData;
     const char* type_str = "unknown";
     switch (error.errorType) {
         case CLAY_ERROR_TYPE_TEXT_MEASUREMENT_FUNCTION_NOT_PROVIDED:
             type_str = "text measurement function not provided"; break;
         case CLAY_ERROR_TYPE_ARENA_CAPACITY_EXCEEDED:
+            if (header) { header->overflow |= CEL_CLAY_OVERFLOW_ARENA; return; }
             type_str = "arena capacity exceeded"; break;
         case CLAY_ERROR_TYPE_ELEMENTS_CAPACITY_EXCEEDED:
+            /* Recorded; the layout system grows the limit and retries */
+            if (header) { header->overflow |= CEL_CLAY_OVERFLOW_ELEMENTS; return; }
             type_str = "elements capacity exceeded"; break;
         case CLAY_ERROR_TYPE_TEXT_MEASUREMENT_CAPACITY_EXCEEDED:
+            if (header) { header->overflow |= CEL_CLAY_OVERFLOW_WORDS; return; }
             type_str = "text measurement capacity exceeded"; break;
         case CLAY_ERROR_TYPE_DUPLICATE_ID:
             return;  /* Duplicate IDs are expected with auto-generated widget Clay elements */
@@ -91,6 +144,222 @@ static void clay_error_handler(Clay_ErrorData error) {
             type_str, error.errorText.length, error.errorText.chars);
 }
 
+/* ============================================================================
+ * Context Management
+ * ============================================================================
+ *
+ * Every Clay context lives inside its own arena: Clay_Initialize carves the
+ * context struct and all of its element/text caches out of the arena
+ * memory, so freeing the arena destroys the context. New contexts are
+ * sized for the current element/word limits and share the error handler.
+ *
+ * Clay_Initialize makes the new context current -- callers restore the
+ * context they need afterwards.
+ *
+ * With ClayEngineConfig.lazy_arena the allocation is an anonymous mmap
+ * reservation (MAP_NORESERVE): only pages Clay actually touches become
+ * resident, typically a small fraction of an arena sized for thousands of
+ * elements. _cel_clay_context_trim hands the per-pass region back with
+ * madvise(MADV_DONTNEED) right before a pass rebuilds it, so pages that
+ * only a past peak frame needed stop counting against the process.
+ */
+
+static char* clay_arena_reserve(size_t size, bool* out_mapped) {
+    *out_mapped = false;
+#ifdef CEL_CLAY_HAS_MMAP
+    if (g_clay_config.lazy_arena) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+#endif
+        void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (memory != MAP_FAILED) {
+            *out_mapped = true;
+            return (char*)memory;
+        }
+        fprintf(stderr, "[cels-clay] mmap of Clay arena failed, using malloc\n");
+    }
+#else
+    if (g_clay_config.lazy_arena) {
+        static bool warned = false;
+        if (!warned) {
+            fprintf(stderr, "[cels-clay] lazy_arena needs mmap; using malloc\n");
+            warned = true;
+        }
+    }
+#endif
+    return (char*)malloc(size);
+}
+
+static size_t clay_page_size(void) {
+#ifdef CEL_CLAY_HAS_MMAP
+    long page = sysconf(_SC_PAGESIZE);
+    if (page > 0) return (size_t)page;
+#endif
+    return 4096;
+}
+
+static uint32_t clay_arena_size(void) {
+    uint32_t min_memory = Clay_MinMemorySize();
+    if (g_clay_config.arena_size == 0) return min_memory;
+    if (g_clay_config.arena_size < min_memory) {
+        static bool warned = false;
+        if (!warned) {
+            fprintf(stderr, "[cels-clay] warning: requested arena_size %u "
+                    "is less than Clay_MinMemorySize() %u, clamping to minimum\n",
+                    (unsigned)g_clay_config.arena_size, (unsigned)min_memory);
+            warned = true;
+        }
+        return min_memory;
+    }
+    return g_clay_config.arena_size;
+}
+
+Clay_Context* _cel_clay_context_create(Clay_Dimensions dimensions, void** out_memory) {
+    /* With no current context, Clay's limit setters change the defaults
+     * that Clay_MinMemorySize and Clay_Initialize read */
+    Clay_SetCurrentContext(NULL);
+    Clay_SetMaxElementCount((int32_t)g_max_elements);
+    Clay_SetMaxMeasureTextCacheWordCount((int32_t)g_max_measure_words);
+
+    uint32_t arena_size = clay_arena_size();
+    size_t size = CEL_CLAY_CONTEXT_HEADER_SIZE + (size_t)arena_size;
+    bool mapped = false;
+    char* memory = clay_arena_reserve(size, &mapped);
+    if (memory == NULL) {
+        fprintf(stderr, "[cels-clay] failed to allocate Clay arena (%u bytes)\n",
+                (unsigned)arena_size);
+        *out_memory = NULL;
+        return NULL;
+    }
+    _CelClayContextHeader* header = (_CelClayContextHeader*)memory;
+    header->overflow = 0;
+    header->mapped = mapped;
+    header->size = size;
+
+    Clay_Arena arena = Clay_CreateArenaWithCapacityAndMemory(
+        arena_size, memory + CEL_CLAY_CONTEXT_HEADER_SIZE);
+    Clay_Context* context = Clay_Initialize(
+        arena, dimensions,
+        (Clay_ErrorHandler){
+            .errorHandlerFunction = clay_error_handler,
+            .userData = header
+        });
+    if (context == NULL) {
+        _cel_clay_context_destroy(memory);
+        *out_memory = NULL;
+        return NULL;
+    }
+    header->context = context;
+
+    *out_memory = memory;
+    return context;
+}
+
+void _cel_clay_context_destroy(void* memory) {
+    if (memory == NULL) return;
+#ifdef CEL_CLAY_HAS_MMAP
+    _CelClayContextHeader* header = (_CelClayContextHeader*)memory;
+    if (header->mapped) {
+        munmap(memory, header->size);
+        return;
+    }
+#endif
+    free(memory);
+}
+
+uint32_t _cel_clay_context_take_overflow(void* memory) {
+    if (memory == NULL) return 0;
+    _CelClayContextHeader* header = (_CelClayContextHeader*)memory;
+    uint32_t overflow = header->overflow;
+    header->overflow = 0;
+    return overflow;
+}
+
+void _cel_clay_context_trim(void* memory) {
+#ifdef CEL_CLAY_HAS_MMAP
+    _CelClayContextHeader* header = (_CelClayContextHeader*)memory;
+    if (header == NULL || !header->mapped || header->context == NULL) return;
+
+    size_t page = clay_page_size();
+    uintptr_t start = (uintptr_t)memory + CEL_CLAY_CONTEXT_HEADER_SIZE +
+                      _cel_clay_context_ephemeral_offset(header->context);
+    uintptr_t end = (uintptr_t)memory + header->size;
+    start = (start + page - 1) & ~(uintptr_t)(page - 1);
+    if (start < end) {
+        madvise((void*)start, (size_t)(end - start), MADV_DONTNEED);
+    }
+#else
+    (void)memory;
+#endif
+}
+
+void _cel_clay_context_footprint(void* memory, size_t* reserved, size_t* committed) {
+    _CelClayContextHeader* header = (_CelClayContextHeader*)memory;
+    if (header == NULL) return;
+    *reserved += header->size;
+
+#ifdef CEL_CLAY_HAS_MMAP
+    if (header->mapped) {
+        size_t page = clay_page_size();
+        size_t pages = (header->size + page - 1) / page;
+#ifdef __APPLE__
+        char vec[256];
+#else
+        unsigned char vec[256];
+#endif
+        for (size_t first = 0; first < pages; first += sizeof(vec)) {
+            size_t count = pages - first < sizeof(vec) ? pages - first : sizeof(vec);
+            size_t bytes = count * page;
+            if (first + count == pages) bytes = header->size - first * page;
+            if (mincore((char*)memory + first * page, bytes, vec) != 0) {
+                *committed += bytes;  /* Unknown: count as resident */
+                continue;
+            }
+            for (size_t i = 0; i < count; i++) {
+                if (vec[i] & 1) *committed += page;
+            }
+        }
+        return;
+    }
+#endif
+    *committed += header->size;  /* malloc'd: assume resident */
+}
+
+void _cel_clay_grow_limits(uint32_t overflow) {
+    /* Arena errors mean the context outgrew its estimate: grow both */
+    if (overflow & (CEL_CLAY_OVERFLOW_ELEMENTS | CEL_CLAY_OVERFLOW_ARENA)) {
+        g_max_elements *= 2;
+    }
+    if (overflow & (CEL_CLAY_OVERFLOW_WORDS | CEL_CLAY_OVERFLOW_ARENA)) {
+        g_max_measure_words *= 2;
+    }
+    fprintf(stderr, "[cels-clay] Clay capacity exceeded: growing to %u elements, "
+            "%u measured words\n", (unsigned)g_max_elements, (unsigned)g_max_measure_words);
+}
+
+Clay_Context* _cel_clay_primary_context_recreate(Clay_Dimensions dimensions) {
+    void* memory = NULL;
+    Clay_Context* context = _cel_clay_context_create(dimensions, &memory);
+    if (context == NULL) return NULL;  /* Keep the old one */
+    _cel_clay_context_destroy(g_clay_arena_memory);
+    g_clay_arena_memory = memory;
+    g_clay_context = context;
+    return context;
+}
+
+void* _cel_clay_primary_context_memory(void) {
+    return g_clay_arena_memory;
+}
+
+Clay_Context* _cel_clay_primary_context(void) {
+    return g_clay_context;
+}
+
+const ClayEngineConfig* _cel_clay_engine_config(void) {
+    return &g_clay_config;
+}
+
 /* ============================================================================
  * Lifecycle -- Arena cleanup on entity destruction
  * ============================================================================ */
@@ -99,12 +368,15 @@ CEL_Lifecycle(ClayEngineLC);
 
 CEL_Observe(ClayEngineLC, on_destroy) {
     (void)entity;
-    _cel_clay_layout_cleanup();  /* Free frame arena (before Clay arena) */
+    _cel_clay_layout_cleanup();  /* Free surface contexts and frame arenas (before Clay arena) */
+    _cel_clay_render_cleanup();
     if (g_clay_arena_memory != NULL) {
-        free(g_clay_arena_memory);
+        _cel_clay_context_destroy(g_clay_arena_memory);
         g_clay_arena_memory = NULL;
+        g_clay_context = NULL;
     }
     ClayEngineState.initialized = false;
+    ClayEngineState.stats = (ClayEngineStats){0};
 }
 
 /* ============================================================================
@@ -119,40 +391,22 @@ CEL_Module(Clay_Engine, init) {
     cels_register(ClayContainerConfig, ClayTextConfig, ClaySpacerConfig,
                   ClayImageConfig, ClayBorderStyle);
 
-    /* 1. Set generous element/text cache limits BEFORE Clay_MinMemorySize().
-     * Default is too small for terminal apps with long text at wide widths. */
-    Clay_SetMaxElementCount(8192);
-    Clay_SetMaxMeasureTextCacheWordCount(16384);
+    /* 1. Starting element/text cache limits (applied by context creation,
+     * BEFORE Clay_MinMemorySize()). Clay's own defaults are too small for
+     * terminal apps with long text at wide widths; they grow on overflow. */
+    g_max_elements = g_clay_config.max_elements
+        ? g_clay_config.max_elements : CEL_CLAY_DEFAULT_MAX_ELEMENTS;
+    g_max_measure_words = g_clay_config.max_measure_words
+        ? g_clay_config.max_measure_words : CEL_CLAY_DEFAULT_MAX_MEASURE_WORDS;
 
-    /* 2. Calculate arena size (now reflects the higher limits) */
-    uint32_t min_memory = Clay_MinMemorySize();
-    uint32_t arena_size = min_memory;
-
-    if (g_clay_config.arena_size > 0) {
-        if (g_clay_config.arena_size >= min_memory) {
-            arena_size = g_clay_config.arena_size;
-        } else {
-            fprintf(stderr, "[cels-clay] warning: requested arena_size %u "
-                    "is less than Clay_MinMemorySize() %u, clamping to minimum\n",
-                    (unsigned)g_clay_config.arena_size, (unsigned)min_memory);
-            arena_size = min_memory;
-        }
-    }
-
-    /* 3. Allocate arena memory */
-    g_clay_arena_memory = malloc(arena_size);
-    Clay_Arena arena = Clay_CreateArenaWithCapacityAndMemory(
-        arena_size, g_clay_arena_memory);
-
-    /* 4. Initialize Clay with initial dimensions from config */
-    g_clay_context = Clay_Initialize(
-        arena,
+    /* 2-4. Allocate the primary arena (sized from the limits above) and
+     * initialize Clay with initial dimensions from config */
+    g_clay_context = _cel_clay_context_create(
         (Clay_Dimensions){
             .width = g_clay_config.initial_width,
             .height = g_clay_config.initial_height
         },
-        (Clay_ErrorHandler){ .errorHandlerFunction = clay_error_handler }
-    );
+        &g_clay_arena_memory);
 
     /* 5. Register state singleton with cross-TU pointer registry */
     ClayEngineState_register();
@@ -181,3 +435,40 @@ void Clay_Engine_configure(const ClayEngineConfig* config) {
         g_clay_config = *config;
     }
 }
+
+ClayArenaFootprint cel_clay_get_arena_footprint(void) {
+    ClayArenaFootprint footprint = {0};
+    if (g_clay_arena_memory != NULL) {
+        _cel_clay_context_footprint(g_clay_arena_memory,
+                                    &footprint.reserved, &footprint.committed);
+        footprint.contexts++;
+    }
+    for (int32_t i = 0; i < _cel_clay_surface_count(); i++) {
+        void* memory = _cel_clay_surface_context_memory(i);
+        if (memory == NULL || memory == g_clay_arena_memory) continue;
+        _cel_clay_context_footprint(memory, &footprint.reserved, &footprint.committed);
+        footprint.contexts++;
+    }
+    return footprint;
+}
+
+void cel_clay_trim_arenas(void) {
+    g_trim_generation++;
+}
+
+uint32_t _cel_clay_trim_generation(void) {
+    return g_trim_generation;
+}
+
+void _cel_clay_engine_stats_publish(const ClayEngineStats* stats) {
+    size_t arena_peak = ClayEngineState.stats.arena_bytes_peak;
+    uint32_t elements_peak = ClayEngineState.stats.elements_peak;
+
+    ClayEngineState.stats = *stats;
+    ClayEngineState.stats.arena_bytes_peak = stats->arena_bytes_used > arena_peak
+        ? stats->arena_bytes_used : arena_peak;
+    ClayEngineState.stats.elements_peak = stats->elements_peak > elements_peak
+        ? stats->elements_peak : elements_peak;
+    ClayEngineState.stats.max_elements = g_max_elements;
+    ClayEngineState.stats.max_measure_words = g_max_measure_words;
+}
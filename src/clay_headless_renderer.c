@@ -0,0 +1,640 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Headless Renderer - Implementation
+ *
+ * Mirrors clay_ncurses_renderer.c command by command, writing cells into
+ * a ClayHeadlessGrid instead of drawing through cels-ncurses. Coordinate
+ * mapping and parent background resolution come from clay_cells.h, text
+ * widths from clay_text_width.h -- the same code the ncurses renderer
+ * and its measure callback use.
+ *
+ * NOTE: This file compiles in the CONSUMER's context (INTERFACE library).
+ */
+
+#include "cels-clay/clay_headless_renderer.h"
+#include "cels-clay/clay_render.h"
+#include "cels-clay/clay_layout.h"
+#include "cels-clay/clay_cells.h"
+#include "cels-clay/clay_text_width.h"
+#include "cels-clay/clay_profile.h"
+#include "cels-clay/clay_trace.h"
+#include "clay.h"
+#include <cels/cels.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ============================================================================
+ * Static State
+ * ============================================================================ */
+
+static const ClayHeadlessConfig CLAY_HEADLESS_CONFIG_DEFAULT = {
+    .columns = 80,
+    .rows = 24,
+    .cell_aspect_ratio = 2.0f,
+    .alpha_as_dim = true,
+};
+
+static ClayHeadlessConfig g_config = {0};
+static bool g_configured = false;
+static ClayHeadlessGrid* g_grid = NULL;
+
+static ClayHeadlessConfig config_resolve(const ClayHeadlessConfig* config) {
+    ClayHeadlessConfig resolved = config ? *config : CLAY_HEADLESS_CONFIG_DEFAULT;
+    if (resolved.columns <= 0) resolved.columns = CLAY_HEADLESS_CONFIG_DEFAULT.columns;
+    if (resolved.rows <= 0) resolved.rows = CLAY_HEADLESS_CONFIG_DEFAULT.rows;
+    if (resolved.cell_aspect_ratio <= 0.0f) {
+        resolved.cell_aspect_ratio = CLAY_HEADLESS_CONFIG_DEFAULT.cell_aspect_ratio;
+    }
+    return resolved;
+}
+
+/* ============================================================================
+ * Raster State
+ * ============================================================================
+ *
+ * One raster per cel_clay_headless_render call: the target grid, the
+ * config, and the scissor stack. Nested scissors intersect with their
+ * parent; past CEL_CLAY_HEADLESS_MAX_SCISSOR levels the innermost clip
+ * stays in effect.
+ */
+
+#define CEL_CLAY_HEADLESS_MAX_SCISSOR 16
+
+typedef struct {
+    ClayHeadlessGrid* grid;
+    ClayHeadlessConfig config;
+    _CelClayCellRect clip[CEL_CLAY_HEADLESS_MAX_SCISSOR];
+    int depth;
+    int overflow;               /* Pushes past the stack limit */
+} _CelClayRaster;
+
+static inline uint32_t color_rgb(Clay_Color c) {
+    return ((uint32_t)(uint8_t)c.r << 16) | ((uint32_t)(uint8_t)c.g << 8) |
+           (uint32_t)(uint8_t)c.b;
+}
+
+/* Parent bg as a cell color: terminal default when there is none */
+static inline uint32_t parent_color(Clay_Color parent_bg) {
+    return parent_bg.a > 0 ? color_rgb(parent_bg) : CLAY_HEADLESS_COLOR_DEFAULT;
+}
+
+static void raster_put(_CelClayRaster* r, int x, int y, uint32_t codepoint,
+                       uint32_t fg, uint32_t bg, uint32_t attrs) {
+    if (x < 0 || y < 0 || x >= r->grid->columns || y >= r->grid->rows) return;
+    if (r->depth > 0) {
+        const _CelClayCellRect* clip = &r->clip[r->depth - 1];
+        if (x < clip->x || y < clip->y || x >= clip->x + clip->w || y >= clip->y + clip->h) {
+            return;
+        }
+    }
+    r->grid->cells[(size_t)y * (size_t)r->grid->columns + (size_t)x] = (ClayHeadlessCell){
+        .codepoint = codepoint, .fg = fg, .bg = bg, .attrs = attrs
+    };
+}
+
+static void raster_push_scissor(_CelClayRaster* r, _CelClayCellRect rect) {
+    if (r->depth == CEL_CLAY_HEADLESS_MAX_SCISSOR) {
+        r->overflow++;
+        return;
+    }
+    if (r->depth > 0) {
+        const _CelClayCellRect* parent = &r->clip[r->depth - 1];
+        int x0 = rect.x > parent->x ? rect.x : parent->x;
+        int y0 = rect.y > parent->y ? rect.y : parent->y;
+        int x1 = rect.x + rect.w < parent->x + parent->w ? rect.x + rect.w : parent->x + parent->w;
+        int y1 = rect.y + rect.h < parent->y + parent->h ? rect.y + rect.h : parent->y + parent->h;
+        rect = (_CelClayCellRect){ x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0 };
+    }
+    r->clip[r->depth++] = rect;
+}
+
+static void raster_pop_scissor(_CelClayRaster* r) {
+    if (r->overflow > 0) {
+        r->overflow--;
+    } else if (r->depth > 0) {
+        r->depth--;
+    }
+}
+
+static void raster_fill(_CelClayRaster* r, _CelClayCellRect rect, uint32_t codepoint,
+                        uint32_t fg, uint32_t bg, uint32_t attrs) {
+    for (int y = rect.y; y < rect.y + rect.h; y++) {
+        for (int x = rect.x; x < rect.x + rect.w; x++) {
+            raster_put(r, x, y, codepoint, fg, bg, attrs);
+        }
+    }
+}
+
+/* Draw at most max_columns columns of UTF-8 text (first line only).
+ * Returns the columns drawn. */
+static int raster_text(_CelClayRaster* r, int x, int y, const char* text, int32_t length,
+                       int max_columns, uint32_t fg, uint32_t bg, uint32_t attrs) {
+    int32_t fit = _cel_clay_text_fit(text, length, max_columns);
+    int column = 0;
+    for (int32_t i = 0; i < fit; ) {
+        uint32_t codepoint = 0;
+        i += _cel_clay_utf8_decode(text + i, fit - i, &codepoint);
+        int width = _cel_clay_codepoint_width(codepoint);
+        if (width <= 0) continue;  /* Combining marks have no cell of their own */
+        raster_put(r, x + column, y, codepoint, fg, bg, attrs);
+        if (width == 2) raster_put(r, x + column + 1, y, 0, fg, bg, attrs);
+        column += width;
+    }
+    return column;
+}
+
+/* ============================================================================
+ * Borders
+ * ============================================================================
+ *
+ * Box-drawing sets for the three cels-ncurses border styles. Sides are
+ * drawn first; a corner gets its corner character only when both sides
+ * meeting there are drawn.
+ */
+
+enum {
+    SIDE_TOP = 1, SIDE_RIGHT = 2, SIDE_BOTTOM = 4, SIDE_LEFT = 8,
+    SIDE_ALL = 15
+};
+
+typedef enum { BORDER_SINGLE, BORDER_DOUBLE, BORDER_ROUNDED } _CelClayBorderKind;
+
+typedef struct {
+    uint32_t h, v, ul, ur, ll, lr;
+} _CelClayBorderChars;
+
+static const _CelClayBorderChars g_border_chars[] = {
+    [BORDER_SINGLE]  = { 0x2500, 0x2502, 0x250C, 0x2510, 0x2514, 0x2518 },
+    [BORDER_DOUBLE]  = { 0x2550, 0x2551, 0x2554, 0x2557, 0x255A, 0x255D },
+    [BORDER_ROUNDED] = { 0x2500, 0x2502, 0x256D, 0x256E, 0x2570, 0x256F },
+};
+
+static void raster_border(_CelClayRaster* r, _CelClayCellRect rect, int sides,
+                          _CelClayBorderKind kind, uint32_t fg, uint32_t bg) {
+    if (rect.w <= 0 || rect.h <= 0) return;
+    const _CelClayBorderChars* chars = &g_border_chars[kind];
+    int x1 = rect.x + rect.w - 1;
+    int y1 = rect.y + rect.h - 1;
+
+    for (int x = rect.x; x <= x1; x++) {
+        if (sides & SIDE_TOP) raster_put(r, x, rect.y, chars->h, fg, bg, 0);
+        if (sides & SIDE_BOTTOM) raster_put(r, x, y1, chars->h, fg, bg, 0);
+    }
+    for (int y = rect.y; y <= y1; y++) {
+        if (sides & SIDE_LEFT) raster_put(r, rect.x, y, chars->v, fg, bg, 0);
+        if (sides & SIDE_RIGHT) raster_put(r, x1, y, chars->v, fg, bg, 0);
+    }
+    if ((sides & (SIDE_TOP | SIDE_LEFT)) == (SIDE_TOP | SIDE_LEFT)) {
+        raster_put(r, rect.x, rect.y, chars->ul, fg, bg, 0);
+    }
+    if ((sides & (SIDE_TOP | SIDE_RIGHT)) == (SIDE_TOP | SIDE_RIGHT)) {
+        raster_put(r, x1, rect.y, chars->ur, fg, bg, 0);
+    }
+    if ((sides & (SIDE_BOTTOM | SIDE_LEFT)) == (SIDE_BOTTOM | SIDE_LEFT)) {
+        raster_put(r, rect.x, y1, chars->ll, fg, bg, 0);
+    }
+    if ((sides & (SIDE_BOTTOM | SIDE_RIGHT)) == (SIDE_BOTTOM | SIDE_RIGHT)) {
+        raster_put(r, x1, y1, chars->lr, fg, bg, 0);
+    }
+}
+
+/* ============================================================================
+ * Command Rendering
+ * ============================================================================
+ *
+ * Each function matches its counterpart in clay_ncurses_renderer.c.
+ */
+
+static void render_rectangle(_CelClayRaster* r, _CelClayCellRect rect,
+                             const Clay_RectangleRenderData* data) {
+    Clay_Color c = data->backgroundColor;
+    uint32_t attrs = (r->config.alpha_as_dim && c.a < 128) ? CLAY_HEADLESS_ATTR_DIM : 0;
+    raster_fill(r, rect, ' ', CLAY_HEADLESS_COLOR_DEFAULT, color_rgb(c), attrs);
+}
+
+static void render_text(_CelClayRaster* r, _CelClayCellRect rect,
+                        const Clay_TextRenderData* data, Clay_Color parent_bg,
+                        void* userData) {
+    Clay_StringSlice text = data->stringContents;
+    if (text.length <= 0 || text.chars == NULL) return;
+
+    /* Packed text attributes share the CLAY_HEADLESS_ATTR_* bits */
+    uint32_t attrs = (uint32_t)((uintptr_t)userData & 0x1Fu);
+    raster_text(r, rect.x, rect.y, text.chars, text.length, rect.w,
+                color_rgb(data->textColor), parent_color(parent_bg), attrs);
+}
+
+static void render_border(_CelClayRaster* r, _CelClayCellRect rect,
+                          const Clay_BorderRenderData* data, Clay_Color parent_bg) {
+    int sides = 0;
+    if (data->width.top > 0)    sides |= SIDE_TOP;
+    if (data->width.right > 0)  sides |= SIDE_RIGHT;
+    if (data->width.bottom > 0) sides |= SIDE_BOTTOM;
+    if (data->width.left > 0)   sides |= SIDE_LEFT;
+    if (sides == 0) return;
+
+    Clay_Color c = data->color;
+    uint32_t fg = (c.r || c.g || c.b || c.a) ? color_rgb(c) : CLAY_HEADLESS_COLOR_DEFAULT;
+
+    _CelClayBorderKind kind = BORDER_SINGLE;
+    if (data->cornerRadius.topLeft > 0 || data->cornerRadius.topRight > 0 ||
+        data->cornerRadius.bottomLeft > 0 || data->cornerRadius.bottomRight > 0) {
+        kind = BORDER_ROUNDED;
+    } else if (data->width.top >= 2 || data->width.right >= 2 ||
+               data->width.bottom >= 2 || data->width.left >= 2) {
+        kind = BORDER_DOUBLE;
+    }
+
+    raster_border(r, rect, sides, kind, fg, parent_color(parent_bg));
+}
+
+static void render_border_decor(_CelClayRaster* r, _CelClayCellRect rect,
+                                const CelClayBorderDecor* decor, Clay_Color parent_bg) {
+    _CelClayBorderKind kind;
+    switch (decor->border_style) {
+        case 1:  kind = BORDER_SINGLE; break;
+        case 2:  kind = BORDER_DOUBLE; break;
+        default: kind = BORDER_ROUNDED; break;
+    }
+
+    /* Interior fill with the panel bg (alpha < 2 = border only) */
+    Clay_Color ibg = decor->bg_color;
+    _CelClayCellRect inner = { rect.x + 1, rect.y + 1, rect.w - 2, rect.h - 2 };
+    if (inner.w > 0 && inner.h > 0 && ibg.a >= 2.0f) {
+        raster_fill(r, inner, ' ', CLAY_HEADLESS_COLOR_DEFAULT, color_rgb(ibg), 0);
+    }
+
+    uint32_t border_bg = parent_color(parent_bg);
+    raster_border(r, rect, SIDE_ALL, kind, color_rgb(decor->border_color), border_bg);
+
+    /* " Title " on the top line, after the upper-left corner */
+    int title_end = rect.x + 1;
+    if (decor->title && decor->title[0] != '\0') {
+        char title_buf[256];
+        int len = snprintf(title_buf, sizeof(title_buf), " %s ", decor->title);
+        if (len > (int)sizeof(title_buf) - 1) len = (int)sizeof(title_buf) - 1;
+        int max_cols = rect.w - 2;
+        if (max_cols > 0 && len > 0) {
+            uint32_t attrs = (uint32_t)(decor->title_text_attr & 0x1Fu);
+            raster_text(r, rect.x + 1, rect.y, title_buf, len, max_cols,
+                        color_rgb(decor->title_color), border_bg, attrs);
+            title_end = rect.x + 1 + (len < max_cols ? len : max_cols);
+        }
+    }
+
+    /* Right-aligned text before the upper-right corner */
+    if (decor->right_text && decor->right_text[0] != '\0') {
+        char right_buf[64];
+        int len = snprintf(right_buf, sizeof(right_buf), " %s ", decor->right_text);
+        if (len > (int)sizeof(right_buf) - 1) len = (int)sizeof(right_buf) - 1;
+        int right_end = rect.x + rect.w - 1;
+        int right_x = right_end - len;
+        if (len > 0 && right_x > title_end && right_x >= rect.x + 1) {
+            raster_text(r, right_x, rect.y, right_buf, len, right_end - right_x,
+                        color_rgb(decor->right_color), border_bg, 0);
+        }
+    }
+}
+
+void cel_clay_headless_render(ClayHeadlessGrid* grid, Clay_RenderCommandArray commands,
+                              const ClayHeadlessConfig* config) {
+    if (!grid) return;
+    _CelClayRaster raster = { .grid = grid, .config = config_resolve(config) };
+    _CelClayRaster* r = &raster;
+    float ar = r->config.cell_aspect_ratio;
+    bool traced = CEL_CLAY_TRACE_BEGIN("draw", -1);
+    if (traced) CEL_CLAY_TRACE_ARG("commands", commands.length);
+
+    for (int32_t j = 0; j < commands.length; j++) {
+        Clay_RenderCommand* cmd = Clay_RenderCommandArray_Get(&commands, j);
+
+        switch (cmd->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+                _CelClayCellRect rect = _cel_clay_bbox_to_cells(cmd->boundingBox, ar);
+                if (cmd->userData) {
+                    render_border_decor(r, rect, (const CelClayBorderDecor*)cmd->userData,
+                                        _cel_clay_find_parent_bg(commands, j));
+                } else {
+                    render_rectangle(r, rect, &cmd->renderData.rectangle);
+                }
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+                _CelClayCellRect rect = _cel_clay_bbox_to_cells(cmd->boundingBox, ar);
+                render_text(r, rect, &cmd->renderData.text,
+                            _cel_clay_find_parent_bg(commands, j), cmd->userData);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+                _CelClayCellRect rect = _cel_clay_bbox_to_cells(cmd->boundingBox, ar);
+                render_border(r, rect, &cmd->renderData.border,
+                              _cel_clay_find_parent_bg(commands, j));
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+                raster_push_scissor(r, _cel_clay_bbox_to_cells(cmd->boundingBox, ar));
+                break;
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+                raster_pop_scissor(r);
+                break;
+            default:
+                break;  /* IMAGE, CUSTOM, NONE -- skip silently */
+        }
+    }
+
+    if (traced) CEL_CLAY_TRACE_END();
+}
+
+/* ============================================================================
+ * Grid API
+ * ============================================================================ */
+
+static const ClayHeadlessCell g_blank_cell = {
+    .codepoint = ' ',
+    .fg = CLAY_HEADLESS_COLOR_DEFAULT,
+    .bg = CLAY_HEADLESS_COLOR_DEFAULT,
+    .attrs = 0
+};
+
+ClayHeadlessGrid* cel_clay_headless_grid_create(int32_t columns, int32_t rows) {
+    if (columns <= 0 || rows <= 0) return NULL;
+    ClayHeadlessGrid* grid = (ClayHeadlessGrid*)malloc(sizeof(ClayHeadlessGrid));
+    if (!grid) return NULL;
+    grid->cells = (ClayHeadlessCell*)malloc(
+        sizeof(ClayHeadlessCell) * (size_t)columns * (size_t)rows);
+    if (!grid->cells) {
+        free(grid);
+        return NULL;
+    }
+    grid->columns = columns;
+    grid->rows = rows;
+    cel_clay_headless_grid_clear(grid);
+    return grid;
+}
+
+void cel_clay_headless_grid_destroy(ClayHeadlessGrid* grid) {
+    if (!grid) return;
+    free(grid->cells);
+    free(grid);
+}
+
+void cel_clay_headless_grid_clear(ClayHeadlessGrid* grid) {
+    if (!grid) return;
+    size_t count = (size_t)grid->columns * (size_t)grid->rows;
+    for (size_t i = 0; i < count; i++) grid->cells[i] = g_blank_cell;
+}
+
+static inline uint64_t grid_mix(uint64_t h, uint64_t v) {
+    h ^= v * 0x9E3779B97F4A7C15ull;
+    h = (h << 27) | (h >> 37);
+    return h * 0xC2B2AE3D27D4EB4Full + 0x165667B19E3779F9ull;
+}
+
+uint64_t cel_clay_headless_grid_hash(const ClayHeadlessGrid* grid) {
+    if (!grid) return 0;
+    uint64_t h = grid_mix(0x243F6A8885A308D3ull,
+                          ((uint64_t)(uint32_t)grid->columns << 32) | (uint32_t)grid->rows);
+    size_t count = (size_t)grid->columns * (size_t)grid->rows;
+    for (size_t i = 0; i < count; i++) {
+        const ClayHeadlessCell* cell = &grid->cells[i];
+        h = grid_mix(h, ((uint64_t)cell->codepoint << 32) | cell->attrs);
+        h = grid_mix(h, ((uint64_t)cell->fg << 32) | cell->bg);
+    }
+    return h;
+}
+
+static int utf8_encode(uint32_t codepoint, char out[4]) {
+    if (codepoint < 0x80) {
+        out[0] = (char)codepoint;
+        return 1;
+    }
+    if (codepoint < 0x800) {
+        out[0] = (char)(0xC0 | (codepoint >> 6));
+        out[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+    if (codepoint < 0x10000) {
+        out[0] = (char)(0xE0 | (codepoint >> 12));
+        out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (codepoint >> 18));
+    out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+bool cel_clay_headless_grid_dump(const ClayHeadlessGrid* grid, FILE* out, bool styles) {
+    if (!grid || !out) return false;
+    for (int32_t y = 0; y < grid->rows; y++) {
+        const ClayHeadlessCell* row = &grid->cells[(size_t)y * (size_t)grid->columns];
+        for (int32_t x = 0; x < grid->columns; x++) {
+            if (row[x].codepoint == 0) continue;  /* Second half of a wide char */
+            char bytes[4];
+            fwrite(bytes, 1, (size_t)utf8_encode(row[x].codepoint, bytes), out);
+        }
+        fputc('\n', out);
+
+        if (!styles) continue;
+        for (int32_t x = 0; x < grid->columns; x++) {
+            if (x > 0 && row[x].fg == row[x - 1].fg && row[x].bg == row[x - 1].bg &&
+                row[x].attrs == row[x - 1].attrs) {
+                continue;
+            }
+            fprintf(out, "%s%d:%x/%x/%x", x > 0 ? " " : "", (int)x,
+                    (unsigned)row[x].fg, (unsigned)row[x].bg, (unsigned)row[x].attrs);
+        }
+        fputc('\n', out);
+    }
+    return !ferror(out);
+}
+
+/* Golden file: magic, columns, rows, then the cells (native byte order) */
+static const char g_grid_magic[8] = { 'C', 'L', 'A', 'Y', 'G', 'R', 'I', 'D' };
+
+bool cel_clay_headless_grid_save(const ClayHeadlessGrid* grid, const char* path) {
+    if (!grid) return false;
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "[cels-clay] headless: cannot write '%s'\n", path);
+        return false;
+    }
+    int32_t size[2] = { grid->columns, grid->rows };
+    size_t count = (size_t)grid->columns * (size_t)grid->rows;
+    bool ok = fwrite(g_grid_magic, sizeof(g_grid_magic), 1, file) == 1 &&
+              fwrite(size, sizeof(size), 1, file) == 1 &&
+              fwrite(grid->cells, sizeof(ClayHeadlessCell), count, file) == count;
+    if (fclose(file) != 0) ok = false;
+    if (!ok) fprintf(stderr, "[cels-clay] headless: cannot write '%s'\n", path);
+    return ok;
+}
+
+ClayHeadlessGrid* cel_clay_headless_grid_load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "[cels-clay] headless: cannot read '%s'\n", path);
+        return NULL;
+    }
+    char magic[8];
+    int32_t size[2];
+    ClayHeadlessGrid* grid = NULL;
+    if (fread(magic, sizeof(magic), 1, file) == 1 &&
+        memcmp(magic, g_grid_magic, sizeof(magic)) == 0 &&
+        fread(size, sizeof(size), 1, file) == 1) {
+        grid = cel_clay_headless_grid_create(size[0], size[1]);
+    }
+    if (grid) {
+        size_t count = (size_t)grid->columns * (size_t)grid->rows;
+        if (fread(grid->cells, sizeof(ClayHeadlessCell), count, file) != count) {
+            cel_clay_headless_grid_destroy(grid);
+            grid = NULL;
+        }
+    }
+    fclose(file);
+    if (!grid) fprintf(stderr, "[cels-clay] headless: '%s' is not a grid file\n", path);
+    return grid;
+}
+
+int32_t cel_clay_headless_grid_diff(const ClayHeadlessGrid* a, const ClayHeadlessGrid* b,
+                                    int32_t* out_column, int32_t* out_row) {
+    if (out_column) *out_column = -1;
+    if (out_row) *out_row = -1;
+    if (!a || !b) return 0;
+
+    if (a->columns != b->columns || a->rows != b->rows) {
+        int32_t cells_a = a->columns * a->rows;
+        int32_t cells_b = b->columns * b->rows;
+        if (out_column) *out_column = 0;
+        if (out_row) *out_row = 0;
+        return cells_a > cells_b ? cells_a : cells_b;
+    }
+
+    int32_t differing = 0;
+    for (int32_t y = 0; y < a->rows; y++) {
+        for (int32_t x = 0; x < a->columns; x++) {
+            size_t i = (size_t)y * (size_t)a->columns + (size_t)x;
+            const ClayHeadlessCell* ca = &a->cells[i];
+            const ClayHeadlessCell* cb = &b->cells[i];
+            if (ca->codepoint == cb->codepoint && ca->fg == cb->fg &&
+                ca->bg == cb->bg && ca->attrs == cb->attrs) {
+                continue;
+            }
+            if (differing == 0) {
+                if (out_column) *out_column = x;
+                if (out_row) *out_row = y;
+            }
+            differing++;
+        }
+    }
+    return differing;
+}
+
+/* ============================================================================
+ * Text Measurement Callback
+ * ============================================================================
+ *
+ * Same as the ncurses renderer: cell columns from the built-in width
+ * table, divided by the aspect ratio into layout units.
+ */
+
+static Clay_Dimensions clay_headless_measure_text(Clay_StringSlice text,
+                                                  Clay_TextElementConfig* config,
+                                                  void* userData) {
+    (void)config;
+    (void)userData;
+    if (text.length <= 0 || text.chars == NULL) {
+        return (Clay_Dimensions){ .width = 0, .height = 0 };
+    }
+    _CelClayTextExtent extent = _cel_clay_text_extent(text.chars, text.length);
+    return (Clay_Dimensions){
+        .width = (float)extent.columns / g_config.cell_aspect_ratio,
+        .height = (float)extent.lines
+    };
+}
+
+/* ============================================================================
+ * Provider Callback
+ * ============================================================================
+ *
+ * Redraws the module grid from every surface, in surface order, on frames
+ * where some surface is dirty.
+ */
+
+static void clay_headless_render(cels_iter_t* it) {
+    (void)it;
+    int32_t surface_count = cel_clay_surface_count();
+
+    bool fresh = false;
+    if (!g_grid) {
+        g_grid = cel_clay_headless_grid_create(g_config.columns, g_config.rows);
+        if (!g_grid) {
+            fprintf(stderr, "[cels-clay] headless: out of memory for %dx%d grid\n",
+                    g_config.columns, g_config.rows);
+            return;
+        }
+        fresh = true;
+    }
+
+    bool dirty = fresh;
+    for (int32_t i = 0; i < surface_count; i++) {
+        dirty = dirty || cel_clay_get_surface_render_data(i)->dirty;
+    }
+    if (!dirty) return;
+
+    CEL_CLAY_PROFILE_BEGIN(draw);
+    cel_clay_headless_grid_clear(g_grid);
+    for (int32_t i = 0; i < surface_count; i++) {
+        cel_clay_headless_render(g_grid, cel_clay_get_surface_render_data(i)->render_commands,
+                                 &g_config);
+    }
+    CEL_CLAY_PROFILE_END(draw, CEL_CLAY_PHASE_DRAW);
+}
+
+/* ============================================================================
+ * Module Definition
+ * ============================================================================ */
+
+CEL_Module(Clay_Headless, init) {
+    if (!g_configured) g_config = config_resolve(NULL);
+
+    cel_clay_set_measure_text_function(clay_headless_measure_text, NULL);
+
+    ClayRenderableData_register();
+    cels_entity_t comp_ids[] = { ClayRenderableData_id };
+    cels_system_declare("Headless_ClayRenderable_ClayRenderableData",
+                        CELS_ON_RENDER, clay_headless_render, comp_ids, 1);
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+void Clay_Headless_configure(const ClayHeadlessConfig* config) {
+    g_config = config_resolve(config);
+    g_configured = true;
+    cel_clay_headless_grid_destroy(g_grid);
+    g_grid = NULL;
+}
+
+const ClayHeadlessGrid* cel_clay_headless_grid(void) {
+    return g_grid;
+}
@@ -24,6 +24,70 @@
  *
  * All other source files that need Clay should include clay.h WITHOUT
  * defining CLAY_IMPLEMENTATION (they get declarations only).
+ *
+ * Parallel layout (CELS_CLAY_PARALLEL_LAYOUT): Clay keeps the current
+ * context in the global Clay__currentContext, which every Clay call reads.
+ * To let worker threads lay out different contexts at the same time, the
+ * name is redirected to a thread-local slot before Clay is instantiated:
+ * Clay's own definition `Clay_Context *Clay__currentContext;` then expands
+ * to a (compatible) redeclaration of the slot accessor, and every use reads
+ * or writes the calling thread's slot. Clay_SetCurrentContext therefore
+ * only affects the calling thread.
  */
+#ifdef CELS_CLAY_PARALLEL_LAYOUT
+#include "clay.h"  /* Declarations only: Clay_Context */
+
+static _Thread_local Clay_Context* g_clay_tls_context = NULL;
+
+Clay_Context** _cel_clay_current_context_slot(void) {
+    return &g_clay_tls_context;
+}
+
+#define Clay__currentContext (*_cel_clay_current_context_slot())
+#endif
+
 #define CLAY_IMPLEMENTATION
 #include "clay.h"
+
+#include "cels-clay/clay_engine.h"
+
+/* Offset into a context's arena where the per-pass (ephemeral) memory
+ * starts: everything past it is rebuilt by Clay_BeginLayout. Lives here
+ * because Clay_Context is only defined in the implementation section.
+ * Used by _cel_clay_context_trim. */
+size_t _cel_clay_context_ephemeral_offset(Clay_Context* context) {
+    return (size_t)context->arenaResetOffset;
+}
+
+/* Arena, element and measured-word usage of a context, as left by its last
+ * pass (Clay keeps them until the next Clay_BeginLayout). Words on the free
+ * list were evicted and do not count. Used for ClayEngineStats. */
+void _cel_clay_context_usage(Clay_Context* context, _CelClayContextUsage* usage) {
+    usage->arena_used = (size_t)context->internalArena.nextAllocation;
+    usage->arena_capacity = context->internalArena.capacity;
+    usage->elements = (uint32_t)context->layoutElements.length;
+    usage->measured_words = (uint32_t)(context->measuredWords.length -
+                                       context->measuredWordsFreeList.length);
+}
+
+/* Index of the element opened last in the current context (a text element
+ * right after CLAY_TEXT). Valid until the context's next Clay_BeginLayout. */
+int32_t _cel_clay_last_element_index(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    return context ? context->layoutElements.length - 1 : -1;
+}
+
+/* Wrapped line count of the text element at `element_index` in the
+ * current context's last pass, and its element id: the element's TEXT
+ * commands carry Clay__HashNumber(line, id).id. The index must come from
+ * _cel_clay_last_element_index right after a CLAY_TEXT. */
+int32_t _cel_clay_text_element_lines(int32_t element_index, uint32_t* out_id) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    if (!context || element_index < 0 || element_index >= context->layoutElements.length) {
+        return 0;
+    }
+    Clay_LayoutElement* element = &context->layoutElements.internalArray[element_index];
+    Clay__TextElementData* text = element->childrenOrTextContent.textElementData;
+    *out_id = element->id;
+    return text ? text->wrappedLines.length : 0;
+}
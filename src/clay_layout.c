@@ -22,24 +22,50 @@
  * - Per-frame bump arena for dynamic string lifetime management
  * - Terminal text measurement function (character-cell based)
  * - Auto-ID generation via Clay__HashNumber(counter, entity_id)
- * - Depth-first entity tree walk with component-presence dispatch
+ * - Linear walk over the cached depth-first node array (clay_tree.c)
  * - Property-driven emit: ClayContainerConfig, ClayTextConfig,
  *   ClaySpacerConfig, ClayImageConfig -> CLAY()/CLAY_TEXT() calls
  * - CEL_Clay_Children child emission at call site
+ * - Per-surface state: own Clay context, frame arena and render commands
  * - PreStore layout system: SetDimensions -> arena reset -> BeginLayout -> walk -> EndLayout
+ * - Change tracking: clean frames skip Clay and reuse the last commands
+ * - Optional parallel layout: changed surfaces laid out on worker threads
  * - Render command storage for render bridge
  *
  * NOTE: This file compiles in the CONSUMER's context (INTERFACE library).
  */
 
 #include "cels-clay/clay_layout.h"
+#include "cels-clay/clay_engine.h"
 #include "cels-clay/clay_primitives.h"
+#include "cels-clay/clay_tree.h"
+#include "cels-clay/clay_profile.h"
+#include "cels-clay/clay_trace.h"
 #include "clay.h"
 #include <flecs.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#ifdef CELS_CLAY_PARALLEL_LAYOUT
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+/* ============================================================================
+ * Thread-Local Layout State
+ * ============================================================================
+ *
+ * With CELS_CLAY_PARALLEL_LAYOUT, surfaces are walked on worker threads.
+ * Everything a walk touches (frame arena, current entity, close stack) is
+ * then per thread; each thread also has its own current Clay context (see
+ * clay_impl.c). Without it the qualifier expands to nothing.
+ */
+#ifdef CELS_CLAY_PARALLEL_LAYOUT
+#define CEL_CLAY_LAYOUT_LOCAL _Thread_local
+#else
+#define CEL_CLAY_LAYOUT_LOCAL
+#endif
 
 /* ============================================================================
  * Forward declaration for Clay internal
@@ -74,23 +100,92 @@ void ClaySurfaceConfig_register(void) {
 }
 
 /* ============================================================================
- * Frame Arena (per-frame bump allocator for dynamic strings)
+ * Frame Arena (per-frame chunked bump allocator for dynamic strings)
  * ============================================================================
  *
  * Dynamic strings (snprintf results, concatenated text) are stack-local in
  * layout functions. Clay_String stores only a pointer -- not a copy. The
  * frame arena copies dynamic strings into a persistent buffer that survives
- * until the renderer reads them. Reset at the start of each frame.
+ * until the renderer reads them. Each surface owns one, reset at the start
+ * of that surface's pass -- a skipped surface keeps its strings alive for
+ * the commands it reuses. g_frame_arena points at the active surface's
+ * (per thread under parallel layout).
+ *
+ * The arena is a list of chunks. When the current chunk is full the next
+ * one is used (or a new one, at least twice the last, is appended), so a
+ * copy never moves and every Clay_String handed out in the pass stays
+ * valid. At reset, a pass that spilled into several chunks has them
+ * coalesced into one chunk holding their total, so steady state is a
+ * single chunk. After CEL_CLAY_FRAME_ARENA_SHRINK_PASSES passes that each
+ * used under a quarter of it, the chunk is halved (never below the
+ * initial size, ClayEngineConfig.frame_arena_size).
  */
 
-typedef struct {
-    char* memory;
+typedef struct _CelClayArenaChunk {
+    struct _CelClayArenaChunk* next;
     size_t capacity;
     size_t offset;
+    char data[];
+} _CelClayArenaChunk;
+
+typedef struct {
+    _CelClayArenaChunk* head;
+    _CelClayArenaChunk* current;
+    size_t min_capacity;    /* Initial size; shrinking stops here */
+    size_t used;            /* Bytes copied since the last reset */
+    uint32_t chunk_count;
+    uint32_t low_passes;    /* Consecutive passes under a quarter of head */
 } _CelClayFrameArena;
 
-static _CelClayFrameArena g_frame_arena = {0};
-#define CEL_CLAY_FRAME_ARENA_SIZE (16 * 1024)  /* 16KB */
+static CEL_CLAY_LAYOUT_LOCAL _CelClayFrameArena* g_frame_arena = NULL;
+#define CEL_CLAY_FRAME_ARENA_SIZE (16 * 1024)  /* 16KB default */
+#define CEL_CLAY_FRAME_ARENA_SHRINK_PASSES 120
+
+/* Initial chunk size for new surfaces (ClayEngineConfig.frame_arena_size) */
+static size_t g_frame_arena_size = CEL_CLAY_FRAME_ARENA_SIZE;
+
+static _CelClayArenaChunk* arena_chunk_new(size_t capacity) {
+    _CelClayArenaChunk* chunk = (_CelClayArenaChunk*)malloc(
+        sizeof(_CelClayArenaChunk) + capacity);
+    if (chunk == NULL) {
+        fprintf(stderr, "[cels-clay] failed to allocate frame arena chunk (%zu bytes)\n",
+                capacity);
+        return NULL;
+    }
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->offset = 0;
+    return chunk;
+}
+
+static void arena_chunks_free(_CelClayArenaChunk* chunk) {
+    while (chunk) {
+        _CelClayArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+/* Chunk with room for len bytes: the current one, a kept successor, or a
+ * newly appended one */
+static _CelClayArenaChunk* arena_chunk_for(_CelClayFrameArena* arena, size_t len) {
+    _CelClayArenaChunk* chunk = arena->current;
+    if (chunk->offset + len <= chunk->capacity) return chunk;
+
+    while (chunk->next) {
+        chunk = chunk->next;
+        chunk->offset = 0;
+        if (len <= chunk->capacity) return arena->current = chunk;
+    }
+
+    size_t capacity = chunk->capacity * 2;
+    while (capacity < len) capacity *= 2;
+    _CelClayArenaChunk* grown = arena_chunk_new(capacity);
+    if (grown == NULL) return NULL;
+    chunk->next = grown;
+    arena->chunk_count++;
+    return arena->current = grown;
+}
 
 Clay_String _cel_clay_frame_arena_string(const char* buf, int32_t len) {
     Clay_String empty = { .isStaticallyAllocated = false, .length = 0, .chars = "" };
@@ -99,20 +194,20 @@ Clay_String _cel_clay_frame_arena_string(const char* buf, int32_t len) {
         return empty;
     }
 
-    if (g_frame_arena.memory == NULL) {
+    if (g_frame_arena == NULL || g_frame_arena->head == NULL) {
         fprintf(stderr, "[cels-clay] frame arena not initialized\n");
         return empty;
     }
 
-    if (g_frame_arena.offset + (size_t)len > g_frame_arena.capacity) {
-        fprintf(stderr, "[cels-clay] frame arena overflow: need %d bytes, "
-                "%zu/%zu used\n", len, g_frame_arena.offset, g_frame_arena.capacity);
+    _CelClayArenaChunk* chunk = arena_chunk_for(g_frame_arena, (size_t)len);
+    if (chunk == NULL) {
         return empty;
     }
 
-    char* dest = g_frame_arena.memory + g_frame_arena.offset;
+    char* dest = chunk->data + chunk->offset;
     memcpy(dest, buf, (size_t)len);
-    g_frame_arena.offset += (size_t)len;
+    chunk->offset += (size_t)len;
+    g_frame_arena->used += (size_t)len;
 
     return (Clay_String){
         .isStaticallyAllocated = false,
@@ -121,8 +216,62 @@ Clay_String _cel_clay_frame_arena_string(const char* buf, int32_t len) {
     };
 }
 
-static void _cel_clay_frame_arena_reset(void) {
-    g_frame_arena.offset = 0;
+static bool _cel_clay_frame_arena_init(_CelClayFrameArena* arena) {
+    memset(arena, 0, sizeof(*arena));
+    arena->head = arena_chunk_new(g_frame_arena_size);
+    if (arena->head == NULL) return false;
+    arena->current = arena->head;
+    arena->min_capacity = g_frame_arena_size;
+    arena->chunk_count = 1;
+    return true;
+}
+
+static void _cel_clay_frame_arena_free(_CelClayFrameArena* arena) {
+    arena_chunks_free(arena->head);
+    memset(arena, 0, sizeof(*arena));
+}
+
+/* Replace all chunks with a single one of `capacity` bytes (all strings
+ * of the previous pass are dead at this point) */
+static void arena_replace_chunks(_CelClayFrameArena* arena, size_t capacity) {
+    _CelClayArenaChunk* chunk = arena_chunk_new(capacity);
+    if (chunk == NULL) return;  /* Keep the old chunks */
+    arena_chunks_free(arena->head);
+    arena->head = chunk;
+    arena->chunk_count = 1;
+}
+
+static void _cel_clay_frame_arena_reset(_CelClayFrameArena* arena) {
+    size_t head_capacity = arena->head->capacity;
+
+    if (arena->chunk_count > 1) {
+        /* Last pass spilled: one chunk big enough for all of it */
+        size_t total = 0;
+        for (_CelClayArenaChunk* c = arena->head; c; c = c->next) total += c->capacity;
+        arena_replace_chunks(arena, total);
+        arena->low_passes = 0;
+    } else if (arena->used < head_capacity / 4 && head_capacity > arena->min_capacity) {
+        if (++arena->low_passes >= CEL_CLAY_FRAME_ARENA_SHRINK_PASSES) {
+            size_t half = head_capacity / 2;
+            arena_replace_chunks(arena, half > arena->min_capacity ? half : arena->min_capacity);
+            arena->low_passes = 0;
+        }
+    } else {
+        arena->low_passes = 0;
+    }
+
+    arena->head->offset = 0;
+    arena->current = arena->head;
+    arena->used = 0;
+}
+
+/* Add this arena's chunk count and reserved bytes to the totals */
+static void arena_measure(const _CelClayFrameArena* arena, ClayFrameArenaStats* stats) {
+    for (const _CelClayArenaChunk* c = arena->head; c; c = c->next) {
+        stats->capacity += c->capacity;
+        stats->chunk_count++;
+    }
+    stats->bytes_used += arena->used;
 }
 
 /* ============================================================================
@@ -130,8 +279,8 @@ static void _cel_clay_frame_arena_reset(void) {
  * ============================================================================
  *
  * Each character is 1 unit wide, newlines increment height. Matches Clay's
- * terminal renderer example pattern. Registered via Clay_SetMeasureTextFunction
- * during layout init.
+ * terminal renderer example pattern. Installed during layout init unless a
+ * renderer already set its own (cel_clay_set_measure_text_function).
  *
  * Callback signature uses Clay_StringSlice (verified for Clay v0.14).
  */
@@ -163,24 +312,289 @@ static Clay_Dimensions _cel_clay_measure_text(
     return (Clay_Dimensions){ .width = max_width, .height = height };
 }
 
+/* ============================================================================
+ * Measure Function Wrapper
+ * ============================================================================
+ *
+ * Clay only calls the measure function for text it has no cached
+ * measurement of, so counting calls around each CLAY_TEXT tells cache hits
+ * from misses (ClayEngineStats). The installed function is kept here and
+ * Clay calls it through a counting wrapper; the counter belongs to the
+ * thread running the pass.
+ */
+
+typedef Clay_Dimensions (*_CelClayMeasureFn)(Clay_StringSlice text,
+                                             Clay_TextElementConfig* config,
+                                             void* userData);
+
+static _CelClayMeasureFn g_measure_fn = NULL;
+static void* g_measure_user_data = NULL;
+static CEL_CLAY_LAYOUT_LOCAL uint32_t g_measure_calls = 0;
+
+static Clay_Dimensions measure_text_counted(
+    Clay_StringSlice text,
+    Clay_TextElementConfig* config,
+    void* userData)
+{
+    (void)userData;
+    g_measure_calls++;
+#ifdef CELS_CLAY_TRACE
+    if (CEL_CLAY_TRACING()) {
+        uint64_t start = _cel_clay_trace_now();
+        Clay_Dimensions size = g_measure_fn(text, config, g_measure_user_data);
+        _cel_clay_trace_measure(_cel_clay_trace_now() - start);
+        return size;
+    }
+#endif
+    return g_measure_fn(text, config, g_measure_user_data);
+}
+
+void cel_clay_set_measure_text_function(
+    Clay_Dimensions (*measure)(Clay_StringSlice text,
+                               Clay_TextElementConfig* config,
+                               void* user_data),
+    void* user_data)
+{
+    if (measure == NULL) return;
+    g_measure_fn = measure;
+    g_measure_user_data = user_data;
+    if (Clay_GetCurrentContext() != NULL) {
+        Clay_SetMeasureTextFunction(measure_text_counted, NULL);
+    }
+    cel_clay_invalidate_text_measurements();
+}
+
 /* ============================================================================
  * Layout Pass State
  * ============================================================================
  *
  * Globals used during the entity tree walk. The layout system sets
  * g_layout_world and g_layout_current_entity before walking each entity.
- * CEL_Clay_Children() reads these to recurse into children.
+ * CEL_Clay_Children() reads these to walk the current node's subtree.
+ * All of them belong to the thread running the pass.
  */
 
-static ecs_world_t* g_layout_world = NULL;
-static cels_entity_t g_layout_current_entity = 0;
-static bool g_layout_pass_active = false;
-static Clay_RenderCommandArray g_last_render_commands = {0};
-static Clay_Dimensions g_last_layout_dimensions = {0, 0};
+static CEL_CLAY_LAYOUT_LOCAL ecs_world_t* g_layout_world = NULL;
+static CEL_CLAY_LAYOUT_LOCAL cels_entity_t g_layout_current_entity = 0;
+static CEL_CLAY_LAYOUT_LOCAL bool g_layout_pass_active = false;
+
+/* Close stack for the node walk: subtree end index per open container */
+static CEL_CLAY_LAYOUT_LOCAL int32_t* g_walk_stack = NULL;
+static CEL_CLAY_LAYOUT_LOCAL int32_t g_walk_depth = 0;
+static CEL_CLAY_LAYOUT_LOCAL int32_t g_walk_capacity = 0;
+
+/* Text elements emitted / measured (cache misses) in the current pass */
+static CEL_CLAY_LAYOUT_LOCAL uint32_t g_text_lookups = 0;
+static CEL_CLAY_LAYOUT_LOCAL uint32_t g_text_misses = 0;
+
+/* Surface state of the pass (subtree cache bookkeeping), and the subtree
+ * recording in progress: caching is off, the root container is sized
+ * from g_record_root_sizing */
+struct _CelClaySurfaceState;
+static CEL_CLAY_LAYOUT_LOCAL struct _CelClaySurfaceState* g_layout_state = NULL;
+static CEL_CLAY_LAYOUT_LOCAL bool g_recording = false;
+static CEL_CLAY_LAYOUT_LOCAL const Clay_Sizing* g_record_root_sizing = NULL;
+
+/* ============================================================================
+ * Change Tracking
+ * ============================================================================
+ *
+ * The layout tree cache (clay_tree.c) observes every ECS input of the
+ * layout -- Clay property components, ClaySurfaceConfig, ChildOf and
+ * CELS_SIBLING_ORDER -- and reports whether anything changed since the
+ * last sync. g_layout_dirty covers explicit invalidation on top of that.
+ *
+ * When nothing changed and the surface size is the same, the previous
+ * pass's render commands are still valid (Clay keeps them until the next
+ * Clay_BeginLayout, and the frame arena is only reset when a pass actually
+ * runs), so the whole pass is skipped.
+ *
+ * Starts dirty so the first frame always lays out.
+ */
+
+static bool g_layout_dirty = true;
+static ClayLayoutStats g_layout_stats = {0};
+
+/* Bumped by cel_clay_invalidate_text_measurements; a surface whose
+ * measure_generation lags resets its context's measure cache */
+static uint32_t g_measure_generation = 0;
+static ClayFrameArenaStats g_arena_stats = {0};
+
+/* Text elements laid out / measured since init (ClayEngineStats) */
+static uint64_t g_text_lookups_total = 0;
+static uint64_t g_text_misses_total = 0;
+
+void cel_clay_layout_invalidate(void) {
+    _cel_clay_tree_invalidate();
+    g_layout_dirty = true;
+}
+
+void cel_clay_invalidate_text_measurements(void) {
+    g_measure_generation++;
+    g_layout_dirty = true;
+}
+
+ClayLayoutStats cel_clay_get_layout_stats(void) {
+    return g_layout_stats;
+}
+
+ClayFrameArenaStats cel_clay_get_frame_arena_stats(void) {
+    return g_arena_stats;
+}
+
+/* ============================================================================
+ * Surface State
+ * ============================================================================
+ *
+ * Each ClaySurface owns a Clay context (element tree, text measure cache,
+ * scroll state), a frame arena and the render commands of its last pass.
+ * The measure cache survives resizes -- word sizes depend on text and
+ * font, not on the layout width -- and is only reset after
+ * cel_clay_invalidate_text_measurements().
+ * The first surface adopts the engine's primary context; further surfaces
+ * allocate their own. A surface is laid out only when its subtree changed
+ * (per-surface attribution from the tree cache), its size changed, or the
+ * layout was invalidated -- otherwise its previous commands are reused.
+ *
+ * States are matched to surface entities each frame; states whose entity
+ * is gone are destroyed along with their context.
+ */
+
+/* A text node's element in its surface's last pass (paint patches) */
+typedef struct {
+    ecs_entity_t entity;
+    int32_t element;                /* Index in the context's layout elements */
+} _CelClayTextIndex;
+
+typedef struct _CelClaySurfaceState {
+    _CelClaySurfaceOutput output;   /* Entity, commands, dimensions */
+    Clay_Context* context;
+    void* context_memory;           /* NULL when using the primary context */
+    _CelClayFrameArena frame_arena;
+    uint32_t measure_generation;    /* g_measure_generation of its cache */
+    uint32_t trim_generation;       /* _cel_clay_trim_generation() handled */
+    uint32_t text_lookups;          /* Text elements since the last stats run */
+    uint32_t text_misses;           /* Of those, measured (cache misses) */
+    bool laid_out;                  /* Has completed at least one pass */
+    bool alive;                     /* Seen this frame */
+    bool ran;                       /* Laid out this frame */
+    int32_t node;                   /* Surface node of the last pass */
+    int32_t* replays;               /* Subtree caches replayed by the last pass */
+    int32_t replay_count;
+    int32_t replay_capacity;
+    int32_t* records;               /* Cacheable nodes it laid out for real */
+    int32_t record_count;
+    int32_t record_capacity;
+    Clay_RenderCommand* spliced;    /* Commands with replays expanded */
+    int32_t spliced_capacity;
+    _CelClayTextIndex* texts;       /* Text elements of the last pass */
+    int32_t text_count;
+    int32_t text_capacity;
+    bool walk_serial;               /* Walk materializes windows: main thread only */
+} _CelClaySurfaceState;
+
+static _CelClaySurfaceState* g_surfaces = NULL;
+static int32_t g_surface_count = 0;
+static int32_t g_surface_capacity = 0;
+
+static void surface_state_destroy(_CelClaySurfaceState* state) {
+    if (state->context_memory) {
+        _cel_clay_context_destroy(state->context_memory);
+    }
+    _cel_clay_frame_arena_free(&state->frame_arena);
+    free(state->replays);
+    free(state->records);
+    free(state->spliced);
+    free(state->texts);
+}
+
+static bool primary_context_in_use(void) {
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        if (g_surfaces[i].context_memory == NULL) return true;
+    }
+    return false;
+}
+
+/* Find or create the state of a surface entity. Returns NULL on failure. */
+static _CelClaySurfaceState* surface_state_get(ecs_entity_t surface, Clay_Dimensions dims) {
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        if (g_surfaces[i].output.surface == surface) return &g_surfaces[i];
+    }
+
+    if (g_surface_count >= g_surface_capacity) {
+        int32_t cap = g_surface_capacity ? g_surface_capacity * 2 : 4;
+        _CelClaySurfaceState* states = (_CelClaySurfaceState*)realloc(
+            g_surfaces, sizeof(_CelClaySurfaceState) * (size_t)cap);
+        if (!states) return NULL;
+        g_surfaces = states;
+        g_surface_capacity = cap;
+    }
+
+    _CelClaySurfaceState state = {0};
+    state.output.surface = surface;
+    state.measure_generation = g_measure_generation;
+    state.trim_generation = _cel_clay_trim_generation();
+    if (!_cel_clay_frame_arena_init(&state.frame_arena)) return NULL;
+
+    if (!primary_context_in_use() && _cel_clay_primary_context() != NULL) {
+        state.context = _cel_clay_primary_context();
+    } else {
+        state.context = _cel_clay_context_create(dims, &state.context_memory);
+        if (state.context == NULL) {
+            _cel_clay_frame_arena_free(&state.frame_arena);
+            return NULL;
+        }
+    }
+
+    g_surfaces[g_surface_count] = state;
+    return &g_surfaces[g_surface_count++];
+}
+
+/* Allocation holding the state's context (and its overflow flags) */
+static void* surface_state_memory(const _CelClaySurfaceState* state) {
+    return state->context_memory ? state->context_memory
+                                 : _cel_clay_primary_context_memory();
+}
+
+/* Replace the state's context with a fresh one at the current limits */
+static bool surface_state_rebuild_context(_CelClaySurfaceState* state, Clay_Dimensions dims) {
+    Clay_Context* context;
+    if (state->context_memory) {
+        void* memory = NULL;
+        context = _cel_clay_context_create(dims, &memory);
+        if (context == NULL) return false;
+        _cel_clay_context_destroy(state->context_memory);
+        state->context_memory = memory;
+    } else {
+        context = _cel_clay_primary_context_recreate(dims);
+        if (context == NULL) return false;
+    }
+    state->context = context;
+    state->measure_generation = g_measure_generation;
+    return true;
+}
+
+/* Destroy states whose surface entity was not seen this frame */
+static void surface_states_prune(void) {
+    int32_t kept = 0;
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        if (g_surfaces[i].alive) {
+            g_surfaces[i].alive = false;
+            g_surfaces[kept++] = g_surfaces[i];
+        } else {
+            surface_state_destroy(&g_surfaces[i]);
+        }
+    }
+    g_surface_count = kept;
+}
+
+/* Forward declaration for the node walk (re-entered by CEL_Clay_Children) */
+static void clay_walk_nodes(int32_t first, int32_t end);
 
-/* Forward declarations for tree walk (mutually recursive) */
-static void clay_walk_entity(ecs_world_t* world, ecs_entity_t entity);
-static void clay_walk_children(ecs_world_t* world, ecs_entity_t parent);
+/* Forward declarations for cleanup (defined with the layout jobs) */
+static void layout_jobs_cleanup(void);
+static void subtree_caches_cleanup(void);
+static void paint_patches_cleanup(void);
 
 /* ============================================================================
  * Auto-ID Generation
@@ -191,14 +605,18 @@ static void clay_walk_children(ecs_world_t* world, ecs_entity_t parent);
  * is unique per macro expansion site within a translation unit.
  */
 
-Clay_ElementId _cel_clay_auto_id(uint32_t counter) {
-    uint32_t seed = (uint32_t)g_layout_current_entity;
+static Clay_ElementId element_id_for(cels_entity_t entity, uint32_t counter) {
+    uint32_t seed = (uint32_t)entity;
     /* Scramble entity ID with golden ratio hash to avoid Clay__HashNumber
      * weakness where small sequential (counter, seed) pairs collide */
     seed *= 2654435761u;
     return Clay__HashNumber(counter, seed);
 }
 
+Clay_ElementId _cel_clay_auto_id(uint32_t counter) {
+    return element_id_for(g_layout_current_entity, counter);
+}
+
 bool _cel_clay_layout_active(void) {
     return g_layout_pass_active;
 }
@@ -208,34 +626,53 @@ bool _cel_clay_layout_active(void) {
  * ============================================================================ */
 
 void _cel_clay_layout_init(void) {
-    /* Allocate frame arena */
-    g_frame_arena.memory = (char*)malloc(CEL_CLAY_FRAME_ARENA_SIZE);
-    if (g_frame_arena.memory == NULL) {
-        fprintf(stderr, "[cels-clay] failed to allocate frame arena (%d bytes)\n",
-                CEL_CLAY_FRAME_ARENA_SIZE);
-        return;
+    /* Frame arenas are allocated per surface on first layout */
+
+    /* Frame arena initial size and layout threads from Clay_Engine_configure */
+    const ClayEngineConfig* config = _cel_clay_engine_config();
+    g_frame_arena_size = config->frame_arena_size
+        ? config->frame_arena_size : CEL_CLAY_FRAME_ARENA_SIZE;
+    cel_clay_set_layout_threads(config->layout_threads);
+
+    /* Register text measurement function (unless a renderer already did) */
+    if (g_measure_fn == NULL) {
+        g_measure_fn = _cel_clay_measure_text;
+        g_measure_user_data = NULL;
     }
-    g_frame_arena.capacity = CEL_CLAY_FRAME_ARENA_SIZE;
-    g_frame_arena.offset = 0;
-
-    /* Register text measurement function */
-    Clay_SetMeasureTextFunction(_cel_clay_measure_text, NULL);
+    Clay_SetMeasureTextFunction(measure_text_counted, NULL);
 
     /* Ensure components are registered */
     ClaySurfaceConfig_register();
 }
 
 void _cel_clay_layout_cleanup(void) {
-    if (g_frame_arena.memory != NULL) {
-        free(g_frame_arena.memory);
-        g_frame_arena.memory = NULL;
+    layout_jobs_cleanup();
+    subtree_caches_cleanup();
+    paint_patches_cleanup();
+
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        surface_state_destroy(&g_surfaces[i]);
     }
-    g_frame_arena.capacity = 0;
-    g_frame_arena.offset = 0;
+    free(g_surfaces);
+    g_surfaces = NULL;
+    g_surface_count = 0;
+    g_surface_capacity = 0;
+    g_frame_arena = NULL;
 
     g_layout_world = NULL;
     g_layout_current_entity = 0;
     g_layout_pass_active = false;
+    g_layout_dirty = true;
+    g_arena_stats = (ClayFrameArenaStats){0};
+    g_text_lookups_total = 0;
+    g_text_misses_total = 0;
+
+    free(g_walk_stack);
+    g_walk_stack = NULL;
+    g_walk_depth = 0;
+    g_walk_capacity = 0;
+
+    _cel_clay_tree_cleanup();
 }
 
 /* ============================================================================
@@ -258,19 +695,17 @@ static Clay_SizingAxis _sizing_or_grow(Clay_SizingAxis axis) {
  * Emit Functions (property-driven Clay element generation)
  * ============================================================================
  *
- * Each emit function reads a component struct from an entity and generates
- * the corresponding CLAY() or CLAY_TEXT() call. Called by clay_walk_entity()
- * based on which component is present.
+ * Each emit function reads the component copy cached on a layout node and
+ * generates the corresponding Clay element. Containers are only opened
+ * here -- the walk closes them once it has emitted their subtree. Leaves
+ * are opened and closed immediately.
  *
  * Auto-IDs use fixed discriminator values (0-3) combined with entity ID.
  * Since each entity has a unique ID, this produces unique Clay element IDs.
  */
 
-static void emit_container(ecs_world_t* world, ecs_entity_t entity,
-                            const ClayContainerConfig* config) {
-    /* Check for additive ClayBorderStyle component */
-    const ClayBorderStyle* border_style = (const ClayBorderStyle*)
-        ecs_get_id(world, entity, ClayBorderStyle_id);
+static void emit_container_open(const _CelClayNode* node) {
+    const ClayContainerConfig* config = &node->config.container;
 
     Clay_ElementDeclaration decl = {
         .layout = {
@@ -285,27 +720,37 @@ static void emit_container(ecs_world_t* world, ecs_entity_t entity,
         },
         .backgroundColor = config->bg
     };
-    for (CLAY__ELEMENT_DEFINITION_LATCH = (Clay__OpenElementWithId(_cel_clay_auto_id(0)), Clay__ConfigureOpenElement(decl), 0);
-         CLAY__ELEMENT_DEFINITION_LATCH < 1;
-         CLAY__ELEMENT_DEFINITION_LATCH = 1, Clay__CloseElement()) {
-        clay_walk_children(world, entity);
+    if (g_record_root_sizing) {
+        /* Root of a subtree recording: the size it was laid out at */
+        decl.layout.sizing = *g_record_root_sizing;
+        g_record_root_sizing = NULL;
     }
+    Clay__OpenElementWithId(_cel_clay_auto_id(0));
+    Clay__ConfigureOpenElement(decl);
 }
 
-static void emit_text(ecs_world_t* world, ecs_entity_t entity,
-                       const ClayTextConfig* config) {
-    (void)world; (void)entity;  /* text is a leaf node */
+static void emit_text(const _CelClayNode* node) {
+    const ClayTextConfig* config = &node->config.text;
     if (!config->text) return;
 
-    /* Convert const char* to Clay_String using the frame arena */
-    int32_t len = (int32_t)strlen(config->text);
+    /* Stable text is passed through as-is (length cached by the tree);
+     * other text is copied into the frame arena */
+    int32_t len = config->length > 0 ? config->length : (int32_t)strlen(config->text);
     Clay_String clay_str;
-    if (len > 0) {
+    if (len > 0 && config->stable) {
+        clay_str = (Clay_String){
+            .isStaticallyAllocated = true,
+            .length = len,
+            .chars = config->text
+        };
+    } else if (len > 0) {
         clay_str = _cel_clay_frame_arena_string(config->text, len);
     } else {
         clay_str = (Clay_String){ .chars = "", .length = 0 };
     }
 
+    /* Clay measures the text right here unless its cache has it */
+    uint32_t calls = g_measure_calls;
     CLAY_TEXT(clay_str, CLAY_TEXT_CONFIG({
         .textColor = config->color,
         .fontSize = config->font_size,
@@ -314,11 +759,29 @@ static void emit_text(ecs_world_t* world, ecs_entity_t entity,
         .lineHeight = config->line_height,
         .wrapMode = config->wrap
     }));
+    g_text_lookups++;
+    if (g_measure_calls != calls) g_text_misses++;
+
+    /* Index the element for paint-only patches of this surface */
+    struct _CelClaySurfaceState* state = g_layout_state;
+    if (state && !g_recording) {
+        if (state->text_count >= state->text_capacity) {
+            int32_t cap = state->text_capacity ? state->text_capacity * 2 : 64;
+            _CelClayTextIndex* texts = (_CelClayTextIndex*)realloc(
+                state->texts, sizeof(_CelClayTextIndex) * (size_t)cap);
+            if (!texts) return;  /* Unindexed text: its paint changes relayout */
+            state->texts = texts;
+            state->text_capacity = cap;
+        }
+        state->texts[state->text_count++] = (_CelClayTextIndex){
+            .entity = node->entity,
+            .element = _cel_clay_last_element_index()
+        };
+    }
 }
 
-static void emit_spacer(ecs_world_t* world, ecs_entity_t entity,
-                          const ClaySpacerConfig* config) {
-    (void)world; (void)entity;  /* spacer is a leaf node */
+static void emit_spacer(const _CelClayNode* node) {
+    const ClaySpacerConfig* config = &node->config.spacer;
     Clay_ElementDeclaration spacer_decl = {
         .layout = {
             .sizing = {
@@ -327,14 +790,13 @@ static void emit_spacer(ecs_world_t* world, ecs_entity_t entity,
             }
         }
     };
-    for (CLAY__ELEMENT_DEFINITION_LATCH = (Clay__OpenElementWithId(_cel_clay_auto_id(1)), Clay__ConfigureOpenElement(spacer_decl), 0);
-         CLAY__ELEMENT_DEFINITION_LATCH < 1;
-         CLAY__ELEMENT_DEFINITION_LATCH = 1, Clay__CloseElement()) {}
+    Clay__OpenElementWithId(_cel_clay_auto_id(1));
+    Clay__ConfigureOpenElement(spacer_decl);
+    Clay__CloseElement();
 }
 
-static void emit_image(ecs_world_t* world, ecs_entity_t entity,
-                         const ClayImageConfig* config) {
-    (void)world; (void)entity;  /* image is a leaf node */
+static void emit_image(const _CelClayNode* node) {
+    const ClayImageConfig* config = &node->config.image;
     Clay_ElementDeclaration img_decl = {
         .layout = {
             .sizing = {
@@ -348,99 +810,243 @@ static void emit_image(ecs_world_t* world, ecs_entity_t entity,
         .backgroundColor = config->bg,
         .cornerRadius = config->corner_radius
     };
-    for (CLAY__ELEMENT_DEFINITION_LATCH = (Clay__OpenElementWithId(_cel_clay_auto_id(2)), Clay__ConfigureOpenElement(img_decl), 0);
-         CLAY__ELEMENT_DEFINITION_LATCH < 1;
-         CLAY__ELEMENT_DEFINITION_LATCH = 1, Clay__CloseElement()) {}
+    Clay__OpenElementWithId(_cel_clay_auto_id(2));
+    Clay__ConfigureOpenElement(img_decl);
+    Clay__CloseElement();
 }
 
 /* ============================================================================
- * Entity Tree Walk (depth-first, recursive, component-presence dispatch)
+ * Subtree Cache
  * ============================================================================
  *
- * Walks the CELS entity hierarchy and dispatches by component presence:
- * - ClayContainerConfig -> emit CLAY() container with direction/props/children
- * - ClayTextConfig -> emit CLAY_TEXT() leaf
- * - ClaySpacerConfig -> emit CLAY() spacing leaf
- * - ClayImageConfig -> emit CLAY() image leaf
- * - No layout component -> transparent passthrough (walk children directly)
+ * Cacheable containers (ClayContainerConfig.cacheable) keep the render
+ * commands of their subtree, relative to the container's origin, in an
+ * entry keyed by entity. While an entry is valid, the walk emits a
+ * childless stand-in instead of the subtree: same element id, the
+ * container's sizing with FIT axes fixed at the recorded size, and a
+ * CUSTOM marker so its position in the command order is known. After the
+ * pass the stand-in's command is replaced by the cached commands, offset
+ * to where the stand-in landed.
+ *
+ * An entry is invalidated when the tree sync sees a change anywhere in
+ * the subtree, on cel_clay_layout_invalidate, and when its stand-in is
+ * laid out at a different size than recorded (the constraint changed) --
+ * that surface's pass then runs again with the subtree walked for real.
+ * A container walked for real is recorded after the pass: its subtree is
+ * laid out alone at its final size in a separate Clay context.
  *
- * Current entity is saved/restored for nested CEL_Clay_Children calls.
+ * Entries are created and modified only between passes (serially); the
+ * walk just reads them and appends to its own surface state.
  */
 
-static void clay_walk_entity(ecs_world_t* world, ecs_entity_t entity) {
-    ecs_entity_t prev_entity = g_layout_current_entity;
-    g_layout_current_entity = entity;
-
-    /* Check component presence in priority order */
-    const ClayContainerConfig* container = (const ClayContainerConfig*)
-        ecs_get_id(world, entity, ClayContainerConfig_id);
-    const ClayTextConfig* text = (const ClayTextConfig*)
-        ecs_get_id(world, entity, ClayTextConfig_id);
-    const ClaySpacerConfig* spacer = (const ClaySpacerConfig*)
-        ecs_get_id(world, entity, ClaySpacerConfig_id);
-    const ClayImageConfig* image = (const ClayImageConfig*)
-        ecs_get_id(world, entity, ClayImageConfig_id);
-
-    if (container) {
-        emit_container(world, entity, container);
-    } else if (text) {
-        emit_text(world, entity, text);
-    } else if (spacer) {
-        emit_spacer(world, entity, spacer);
-    } else if (image) {
-        emit_image(world, entity, image);
-    } else {
-        clay_walk_children(world, entity);
+typedef struct {
+    ecs_entity_t entity;
+    uint32_t element_id;            /* Clay id of the container and stand-in */
+    Clay_Dimensions size;           /* Size the commands were recorded at */
+    Clay_RenderCommand* commands;   /* Relative to the container's origin */
+    int32_t count;
+    int32_t capacity;
+    char* text;                     /* Copies of the text commands' strings */
+    size_t text_capacity;
+    bool valid;
+} _CelClaySubtreeCache;
+
+static _CelClaySubtreeCache* g_caches = NULL;
+static int32_t g_cache_count = 0;
+static int32_t g_cache_capacity = 0;
+
+/* customData of stand-in elements */
+static char g_standin_marker;
+
+static bool index_list_push(int32_t** list, int32_t* count, int32_t* capacity,
+                            int32_t value) {
+    if (*count >= *capacity) {
+        int32_t cap = *capacity ? *capacity * 2 : 8;
+        int32_t* grown = (int32_t*)realloc(*list, sizeof(int32_t) * (size_t)cap);
+        if (!grown) return false;
+        *list = grown;
+        *capacity = cap;
     }
+    (*list)[(*count)++] = value;
+    return true;
+}
 
-    g_layout_current_entity = prev_entity;
+static int32_t subtree_cache_find(ecs_entity_t entity) {
+    for (int32_t i = 0; i < g_cache_count; i++) {
+        if (g_caches[i].entity == entity) return i;
+    }
+    return -1;
 }
 
-/* Max children for stack-local sort buffer. Overflow falls back to unsorted. */
-#define CEL_CLAY_MAX_SORTED_CHILDREN 128
+static void emit_standin(const _CelClayNode* node, const _CelClaySubtreeCache* cache) {
+    const ClayContainerConfig* config = &node->config.container;
+    Clay_Sizing sizing = {
+        .width = _sizing_or_grow(config->width),
+        .height = _sizing_or_grow(config->height)
+    };
+    if (sizing.width.type == CLAY__SIZING_TYPE_FIT) {
+        sizing.width = CLAY_SIZING_FIXED(cache->size.width);
+    }
+    if (sizing.height.type == CLAY__SIZING_TYPE_FIT) {
+        sizing.height = CLAY_SIZING_FIXED(cache->size.height);
+    }
 
-typedef struct {
-    ecs_entity_t entity;
-    uint32_t order;
-} _CelSortedChild;
-
-static void clay_walk_children(ecs_world_t* world, ecs_entity_t parent) {
-    _CelSortedChild buf[CEL_CLAY_MAX_SORTED_CHILDREN];
-    int count = 0;
-
-    /* Collect children with their sibling order */
-    ecs_entity_t so_id = (ecs_entity_t)CELS_SIBLING_ORDER;
-    ecs_iter_t it = ecs_children(world, parent);
-    while (ecs_children_next(&it)) {
-        for (int i = 0; i < it.count; i++) {
-            if (count >= CEL_CLAY_MAX_SORTED_CHILDREN) {
-                /* Overflow: walk remaining unsorted */
-                clay_walk_entity(world, it.entities[i]);
-                continue;
-            }
-            const cels_sibling_order_t* so = (const cels_sibling_order_t*)
-                ecs_get_id(world, it.entities[i], so_id);
-            buf[count].entity = it.entities[i];
-            buf[count].order = so ? so->order : (uint32_t)count;
-            count++;
+    Clay_ElementDeclaration decl = {
+        .layout = { .sizing = sizing },
+        .custom = { .customData = &g_standin_marker }
+    };
+    Clay__OpenElementWithId(_cel_clay_auto_id(0));
+    Clay__ConfigureOpenElement(decl);
+    Clay__CloseElement();
+}
+
+/* Cacheable container at node `index`: emit its stand-in if its entry is
+ * valid (returns true -- skip the subtree), otherwise note it for
+ * recording after the pass. Transient window nodes are never cached. */
+static bool subtree_cache_visit(int32_t index, const _CelClayNode* node) {
+    struct _CelClaySurfaceState* state = g_layout_state;
+    if (g_recording || state == NULL) return false;
+
+    int32_t cache = subtree_cache_find(node->entity);
+    if (cache >= 0 && g_caches[cache].valid) {
+        if (!index_list_push(&state->replays, &state->replay_count,
+                             &state->replay_capacity, cache)) {
+            return false;
         }
+        emit_standin(node, &g_caches[cache]);
+        return true;
+    }
+
+    int32_t tree_count = 0;
+    _cel_clay_tree_nodes(&tree_count);
+    if (index < tree_count) {
+        index_list_push(&state->records, &state->record_count,
+                        &state->record_capacity, index);
+    }
+    return false;
+}
+
+/* ============================================================================
+ * Node Walk (linear scan of the cached depth-first node array)
+ * ============================================================================
+ *
+ * Walks nodes [first, end) and dispatches by node kind:
+ * - CONTAINER -> open CLAY() container; closed when the scan leaves its subtree
+ *   (windowed containers walk their materialized child window and close)
+ * - TEXT -> emit CLAY_TEXT() leaf
+ * - SPACER -> emit CLAY() spacing leaf
+ * - IMAGE -> emit CLAY() image leaf
+ * - PASSTHROUGH -> nothing; its children follow in the array and attach to
+ *   the nearest open container
+ *
+ * Open containers are tracked on g_walk_stack by their subtree end index.
+ * The stack is shared with nested walks (CEL_Clay_Children called while a
+ * walk is running); each walk only pops entries above the depth it started
+ * at. Current entity is saved/restored around the walk for auto-IDs.
+ */
+
+static bool walk_stack_push(int32_t end) {
+    if (g_walk_depth >= g_walk_capacity) {
+        int32_t cap = g_walk_capacity ? g_walk_capacity * 2 : 64;
+        int32_t* stack = (int32_t*)realloc(g_walk_stack, sizeof(int32_t) * (size_t)cap);
+        if (!stack) return false;
+        g_walk_stack = stack;
+        g_walk_capacity = cap;
     }
+    g_walk_stack[g_walk_depth++] = end;
+    return true;
+}
+
+static void clay_walk_nodes(int32_t first, int32_t end) {
+    cels_entity_t prev_entity = g_layout_current_entity;
+    int32_t base = g_walk_depth;
 
-    /* Insertion sort by order (children count is typically < 20) */
-    for (int i = 1; i < count; i++) {
-        _CelSortedChild tmp = buf[i];
-        int j = i - 1;
-        while (j >= 0 && buf[j].order > tmp.order) {
-            buf[j + 1] = buf[j];
-            j--;
+    for (int32_t i = first; i < end; i++) {
+        /* Close containers whose subtree ended before this node */
+        while (g_walk_depth > base && g_walk_stack[g_walk_depth - 1] <= i) {
+            Clay__CloseElement();
+            CEL_CLAY_TRACE_END_KEY(g_walk_depth);
+            g_walk_depth--;
+        }
+
+        /* Re-fetched per node: materializing a window may grow the array */
+        const _CelClayNode* node = &_cel_clay_tree_nodes(NULL)[i];
+        g_layout_current_entity = node->entity;
+
+        switch (node->kind) {
+            case CEL_CLAY_NODE_CONTAINER:
+                if (node->config.container.cacheable && subtree_cache_visit(i, node)) {
+                    i = node->end - 1;  /* Replayed: skip the subtree */
+                    break;
+                }
+                emit_container_open(node);
+                if (node->windowed) {
+                    /* Closed right here: unkeyed span */
+                    bool traced = CEL_CLAY_TRACE_SUBTREE(node->end - i, -1);
+                    if (traced) {
+                        CEL_CLAY_TRACE_ARG("entity", node->entity);
+                        CEL_CLAY_TRACE_ARG("nodes", node->end - i);
+                    }
+                    int32_t window_first, window_end;
+                    if (_cel_clay_tree_window(i, (int32_t)node->config.container.child_offset,
+                                              (int32_t)node->config.container.child_limit,
+                                              &window_first, &window_end)) {
+                        clay_walk_nodes(window_first, window_end);
+                    }
+                    Clay__CloseElement();
+                    if (traced) CEL_CLAY_TRACE_END();
+                } else if (node->end <= i + 1 || !walk_stack_push(node->end)) {
+                    Clay__CloseElement();  /* No children (or no stack room) */
+                } else if (CEL_CLAY_TRACE_SUBTREE(node->end - i, g_walk_depth)) {
+                    /* Closed by the stack pop at this depth */
+                    CEL_CLAY_TRACE_ARG("entity", node->entity);
+                    CEL_CLAY_TRACE_ARG("nodes", node->end - i);
+                }
+                break;
+            case CEL_CLAY_NODE_TEXT:
+                emit_text(node);
+                break;
+            case CEL_CLAY_NODE_SPACER:
+                emit_spacer(node);
+                break;
+            case CEL_CLAY_NODE_IMAGE:
+                emit_image(node);
+                break;
+            default:
+                break;  /* PASSTHROUGH: children follow in the array */
         }
-        buf[j + 1] = tmp;
     }
 
-    /* Walk in sorted order */
-    for (int i = 0; i < count; i++) {
-        clay_walk_entity(world, buf[i].entity);
+    while (g_walk_depth > base) {
+        Clay__CloseElement();
+        CEL_CLAY_TRACE_END_KEY(g_walk_depth);
+        g_walk_depth--;
     }
+
+    g_layout_current_entity = prev_entity;
+}
+
+static bool g_layout_batch_parallel = false;
+
+/* Walk children [start, start + count) of the current entity's node.
+ * Returns false (with a diagnostic outside a layout pass) if none.
+ * A range other than a prepared window materializes nodes, growing the
+ * shared node array: during a parallel batch the surface is flagged
+ * instead and laid out again on the main thread (layout_jobs_run). */
+static bool walk_current_children(const char* caller, int32_t start, int32_t count) {
+    if (!g_layout_pass_active || g_layout_world == NULL) {
+        fprintf(stderr, "[cels-clay] %s called outside layout pass\n", caller);
+        return false;
+    }
+    int32_t index = _cel_clay_tree_find(g_layout_current_entity);
+    if (g_layout_batch_parallel && !_cel_clay_tree_window_ready(index, start, count)) {
+        if (g_layout_state) g_layout_state->walk_serial = true;
+        return false;
+    }
+    int32_t first, end;
+    if (!_cel_clay_tree_window(index, start, count, &first, &end)) return false;
+    clay_walk_nodes(first, end);
+    return true;
 }
 
 /* ============================================================================
@@ -449,226 +1055,998 @@ static void clay_walk_children(ecs_world_t* world, ecs_entity_t parent) {
  *
  * Called from within emit functions or advanced layout functions via the
  * CEL_Clay_Children() macro. Emits child entities at the current point
- * in the CLAY tree.
+ * in the CLAY tree. Children resolve through _cel_clay_tree_window: a
+ * contiguous node range for flattened parents, materialized on demand
+ * for windowed containers.
  */
 
 void _cel_clay_emit_children(void) {
-    if (!g_layout_pass_active || g_layout_world == NULL) {
-        fprintf(stderr, "[cels-clay] CEL_Clay_Children() called outside layout pass\n");
-        return;
-    }
-    clay_walk_children(g_layout_world, g_layout_current_entity);
+    walk_current_children("CEL_Clay_Children()", 0, INT32_MAX);
 }
 
 /* Emit a range of children [start, start+count) in sibling order.
  * Used by scrollable containers for virtual rendering -- only visible
  * children get Clay elements created, avoiding element overflow.
- * Uses heap allocation when children exceed the stack sort buffer. */
+ * Costs O(count), independent of the total number of children. */
 void _cel_clay_emit_children_range(int start, int count) {
-    if (!g_layout_pass_active || g_layout_world == NULL) {
-        fprintf(stderr, "[cels-clay] CEL_Clay_ChildrenRange() called outside layout pass\n");
-        return;
+    walk_current_children("CEL_Clay_ChildrenRange()", start, count);
+}
+
+/* Emit a specific child entity by index (0-based, in sibling order).
+ * Used by container widgets that need to place children in separate regions
+ * (e.g., Widget_Split pane 1 = child 0, pane 2 = child 1).
+ * Returns true if a child at that index was found and emitted. */
+bool _cel_clay_emit_child_at_index(int index) {
+    return walk_current_children("_cel_clay_emit_child_at_index()", index, 1);
+}
+
+/* ============================================================================
+ * Render Command Storage
+ * ============================================================================
+ *
+ * After Clay_EndLayout(), render commands are stored in the surface's state
+ * for the render bridge to consume: _cel_clay_surface_outputs() lists every
+ * surface; the single-surface getters report the first one.
+ */
+
+const _CelClaySurfaceOutput* _cel_clay_surface_output(int32_t index) {
+    if (index < 0 || index >= g_surface_count) return NULL;
+    return &g_surfaces[index].output;
+}
+
+int32_t _cel_clay_surface_count(void) {
+    return g_surface_count;
+}
+
+void* _cel_clay_surface_context_memory(int32_t index) {
+    if (index < 0 || index >= g_surface_count) return NULL;
+    return surface_state_memory(&g_surfaces[index]);
+}
+
+Clay_RenderCommandArray _cel_clay_get_render_commands(void) {
+    if (g_surface_count == 0) return (Clay_RenderCommandArray){0};
+    return g_surfaces[0].output.commands;
+}
+
+Clay_Dimensions _cel_clay_get_layout_dimensions(void) {
+    if (g_surface_count == 0) return (Clay_Dimensions){0, 0};
+    return g_surfaces[0].output.dimensions;
+}
+
+/* ============================================================================
+ * Layout System (PreStore phase)
+ * ============================================================================
+ *
+ * Runs each frame at PreStore phase. For each ClaySurface entity:
+ * 0. Skip the pass if nothing in this surface changed (see Surface State)
+ * 1. Make the surface's Clay context current, set its layout dimensions
+ * 2. Reset the surface's frame arena for dynamic strings
+ * 3. Clay_BeginLayout()
+ * 4. Walk children of the surface entity (linear scan of its node range)
+ * 5. Clay_EndLayout() -> store render commands in the surface state
+ *
+ * Steps 1-5 run as a layout job per surface, in parallel when configured
+ * (see Layout Jobs). The primary context is current again when the system
+ * returns, so renderer-side calls (scroll input) address the first surface.
+ *
+ * Uses ecs_iter_t* callback (direct flecs system, matching cels-ncurses pattern).
+ */
+
+static void clay_layout_surface(ecs_world_t* world, _CelClaySurfaceState* state,
+                                int32_t node, Clay_Dimensions dims) {
+    const _CelClayNode* nodes = _cel_clay_tree_nodes(NULL);
+    int32_t end = nodes[node].end;
+    bool traced = CEL_CLAY_TRACE_BEGIN("layout", -1);
+    if (traced) CEL_CLAY_TRACE_ARG("surface", state->output.surface);
+
+    /* 0. Trim requested: the last pass's commands are about to be replaced,
+     * so its per-pass pages can go back to the OS */
+    if (state->trim_generation != _cel_clay_trim_generation()) {
+        _cel_clay_context_trim(surface_state_memory(state));
+        state->trim_generation = _cel_clay_trim_generation();
     }
-    if (count <= 0) return;
 
-    /* Collect all children with their sibling order */
-    _CelSortedChild stack_buf[CEL_CLAY_MAX_SORTED_CHILDREN];
-    _CelSortedChild* buf = stack_buf;
-    int total = 0;
-    bool heap = false;
+    /* 1. Select context; drop its word measurements only if the measure
+     * function's inputs changed (font, theme) -- not on resize */
+    Clay_SetCurrentContext(state->context);
+    if (state->measure_generation != g_measure_generation) {
+        Clay_ResetMeasureTextCache();
+        state->measure_generation = g_measure_generation;
+    }
+    Clay_SetLayoutDimensions(dims);
+    state->output.dimensions = dims;
+
+    /* 2. Reset this surface's frame arena */
+    g_frame_arena = &state->frame_arena;
+    _cel_clay_frame_arena_reset(g_frame_arena);
+
+    /* 3. Begin layout pass */
+    Clay_BeginLayout();
+    g_text_lookups = 0;
+    g_text_misses = 0;
+    state->replay_count = 0;
+    state->record_count = 0;
+    state->text_count = 0;
+    g_layout_state = state;
+    g_layout_world = world;
+    g_layout_pass_active = true;
+    g_layout_current_entity = state->output.surface;
+
+    /* 4. Walk the surface subtree inside a TOP_TO_BOTTOM root container.
+     * Clay's implicit root uses LEFT_TO_RIGHT (enum default 0),
+     * which would arrange widgets horizontally. */
+    {
+        Clay_ElementDeclaration root_decl = {
+            .layout = {
+                .layoutDirection = CLAY_TOP_TO_BOTTOM,
+                .sizing = { .width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0) }
+            }
+        };
+        Clay__OpenElement();
+        Clay__ConfigureOpenElement(root_decl);
+        CEL_CLAY_PROFILE_BEGIN(walk);
+        clay_walk_nodes(node + 1, end);
+        CEL_CLAY_PROFILE_END(walk, CEL_CLAY_PHASE_WALK);
+        CEL_CLAY_PROFILE_BEGIN(close);
+        Clay__CloseElement();
+        CEL_CLAY_PROFILE_END(close, CEL_CLAY_PHASE_CLOSE);
+    }
 
-    /* First pass: count children */
-    ecs_entity_t so_id = (ecs_entity_t)CELS_SIBLING_ORDER;
-    ecs_iter_t it = ecs_children(g_layout_world, g_layout_current_entity);
-    while (ecs_children_next(&it)) {
-        total += it.count;
+    /* 5. End layout pass */
+    g_layout_pass_active = false;
+    g_layout_world = NULL;
+    g_layout_current_entity = 0;
+    g_layout_state = NULL;
+    g_frame_arena = NULL;
+
+    CEL_CLAY_PROFILE_BEGIN(end_layout);
+    state->output.commands = Clay_EndLayout();
+    CEL_CLAY_PROFILE_END(end_layout, CEL_CLAY_PHASE_END_LAYOUT);
+    state->output.revision++;
+    state->laid_out = true;
+    state->ran = true;
+    state->node = node;
+    state->text_lookups += g_text_lookups;
+    state->text_misses += g_text_misses;
+
+    if (traced) {
+        CEL_CLAY_TRACE_MEASURE_ARGS();
+        CEL_CLAY_TRACE_END();
     }
+}
 
-    /* Allocate heap buffer if needed */
-    if (total > CEL_CLAY_MAX_SORTED_CHILDREN) {
-        buf = (_CelSortedChild*)malloc(sizeof(_CelSortedChild) * total);
-        if (!buf) return;
-        heap = true;
+/* ============================================================================
+ * Layout Jobs (serial or parallel)
+ * ============================================================================
+ *
+ * The system callback first decides, serially, which surfaces need a pass
+ * and queues one job per surface. Anything that may grow shared arrays --
+ * creating surface states and contexts, materializing child windows -- is
+ * done while queuing, so a job only reads the node array and writes its own
+ * surface state, Clay context and frame arena. A walk that asks for a
+ * child range outside its prepared windows (CEL_Clay_ChildrenRange with
+ * another range) would materialize nodes: such surfaces are laid out on
+ * the calling thread after the parallel batch.
+ *
+ * With CELS_CLAY_PARALLEL_LAYOUT and more than one layout thread, the jobs
+ * are pulled from a shared counter by the calling thread and a pool of
+ * persistent workers; the callback returns only once every job finished,
+ * so the render bridge at OnStore sees complete command arrays. Otherwise
+ * (or with a single job) they run in order on the calling thread.
+ *
+ * Jobs hold surface state indices: g_surfaces may move while queuing.
+ */
+
+typedef struct {
+    int32_t state;          /* Index into g_surfaces */
+    int32_t node;           /* Surface node index */
+    Clay_Dimensions dims;
+} _CelClayLayoutJob;
+
+static _CelClayLayoutJob* g_jobs = NULL;
+static int32_t g_job_count = 0;
+static int32_t g_job_capacity = 0;
+static ecs_world_t* g_job_world = NULL;
+
+static uint32_t g_layout_threads = 1;
+
+/* Grow-and-retry rounds per frame after a capacity overflow (each round
+ * doubles the exceeded limit) */
+#define CEL_CLAY_CAPACITY_RETRIES 4
+static bool g_layout_serial_only = false;
+
+static bool layout_job_push(int32_t state, int32_t node, Clay_Dimensions dims) {
+    if (g_job_count >= g_job_capacity) {
+        int32_t cap = g_job_capacity ? g_job_capacity * 2 : 8;
+        _CelClayLayoutJob* jobs = (_CelClayLayoutJob*)realloc(
+            g_jobs, sizeof(_CelClayLayoutJob) * (size_t)cap);
+        if (!jobs) return false;
+        g_jobs = jobs;
+        g_job_capacity = cap;
     }
+    g_jobs[g_job_count++] = (_CelClayLayoutJob){ state, node, dims };
+    return true;
+}
 
-    /* Second pass: collect */
-    int collected = 0;
-    it = ecs_children(g_layout_world, g_layout_current_entity);
-    while (ecs_children_next(&it)) {
-        for (int i = 0; i < it.count && collected < total; i++) {
-            const cels_sibling_order_t* so = (const cels_sibling_order_t*)
-                ecs_get_id(g_layout_world, it.entities[i], so_id);
-            buf[collected].entity = it.entities[i];
-            buf[collected].order = so ? so->order : (uint32_t)collected;
-            collected++;
-        }
+static void layout_job_run(int32_t index) {
+    const _CelClayLayoutJob* job = &g_jobs[index];
+    clay_layout_surface(g_job_world, &g_surfaces[job->state], job->node, job->dims);
+}
+
+static void layout_jobs_run_serial(void) {
+    for (int32_t i = 0; i < g_job_count; i++) {
+        layout_job_run(i);
+    }
+}
+
+#ifdef CELS_CLAY_PARALLEL_LAYOUT
+
+static pthread_t* g_workers = NULL;
+static uint32_t g_worker_count = 0;
+static pthread_mutex_t g_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_pool_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t g_pool_done = PTHREAD_COND_INITIALIZER;
+static uint32_t g_pool_generation = 0;  /* Incremented per dispatched batch */
+static uint32_t g_pool_busy = 0;        /* Workers still in the current batch */
+static bool g_pool_shutdown = false;
+static atomic_int g_next_job;
+
+static void layout_jobs_drain(void) {
+    for (;;) {
+        int32_t index = atomic_fetch_add(&g_next_job, 1);
+        if (index >= g_job_count) break;
+        layout_job_run(index);
     }
+}
 
-    /* Insertion sort by sibling order */
-    for (int i = 1; i < collected; i++) {
-        _CelSortedChild tmp = buf[i];
-        int j = i - 1;
-        while (j >= 0 && buf[j].order > tmp.order) {
-            buf[j + 1] = buf[j];
-            j--;
+/* Worker loop. `arg` carries the batch generation at creation time, so a
+ * worker started between batches waits for the next one. */
+static void* layout_worker_main(void* arg) {
+    uint32_t seen = (uint32_t)(uintptr_t)arg;
+
+    pthread_mutex_lock(&g_pool_mutex);
+    for (;;) {
+        while (!g_pool_shutdown && g_pool_generation == seen) {
+            pthread_cond_wait(&g_pool_start, &g_pool_mutex);
         }
-        buf[j + 1] = tmp;
+        if (g_pool_shutdown) break;
+        seen = g_pool_generation;
+        pthread_mutex_unlock(&g_pool_mutex);
+
+        layout_jobs_drain();
+
+        pthread_mutex_lock(&g_pool_mutex);
+        if (--g_pool_busy == 0) pthread_cond_signal(&g_pool_done);
     }
+    pthread_mutex_unlock(&g_pool_mutex);
 
-    /* Walk only the visible range */
-    int end = start + count;
-    if (end > collected) end = collected;
-    for (int i = start; i < end; i++) {
-        clay_walk_entity(g_layout_world, buf[i].entity);
+    /* Thread-local close stack of this worker */
+    free(g_walk_stack);
+    g_walk_stack = NULL;
+    return NULL;
+}
+
+static void layout_pool_stop(void) {
+    if (g_worker_count == 0) return;
+
+    pthread_mutex_lock(&g_pool_mutex);
+    g_pool_shutdown = true;
+    pthread_cond_broadcast(&g_pool_start);
+    pthread_mutex_unlock(&g_pool_mutex);
+
+    for (uint32_t i = 0; i < g_worker_count; i++) {
+        pthread_join(g_workers[i], NULL);
     }
+    free(g_workers);
+    g_workers = NULL;
+    g_worker_count = 0;
+    g_pool_shutdown = false;
+}
 
-    if (heap) free(buf);
+/* Start (or restart) the pool with `count` workers. Returns the number
+ * actually running. */
+static uint32_t layout_pool_resize(uint32_t count) {
+    if (count == g_worker_count) return g_worker_count;
+    layout_pool_stop();
+    if (count == 0) return 0;
+
+    g_workers = (pthread_t*)malloc(sizeof(pthread_t) * count);
+    if (!g_workers) return 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (pthread_create(&g_workers[i], NULL, layout_worker_main,
+                           (void*)(uintptr_t)g_pool_generation) != 0) {
+            fprintf(stderr, "[cels-clay] failed to start layout worker %u of %u\n",
+                    i + 1, count);
+            break;
+        }
+        g_worker_count++;
+    }
+    return g_worker_count;
 }
 
-/* Emit a specific child entity by index (0-based, in sibling order).
- * Used by container widgets that need to place children in separate regions
- * (e.g., Widget_Split pane 1 = child 0, pane 2 = child 1).
- * Returns true if a child at that index was found and emitted. */
-bool _cel_clay_emit_child_at_index(int index) {
-    if (!g_layout_pass_active || g_layout_world == NULL) {
-        fprintf(stderr, "[cels-clay] _cel_clay_emit_child_at_index() called outside layout pass\n");
-        return false;
+static void layout_jobs_run_parallel(void) {
+    atomic_store(&g_next_job, 0);
+
+    pthread_mutex_lock(&g_pool_mutex);
+    g_pool_busy = g_worker_count;
+    g_pool_generation++;
+    pthread_cond_broadcast(&g_pool_start);
+    pthread_mutex_unlock(&g_pool_mutex);
+
+    /* The calling thread takes jobs too */
+    layout_jobs_drain();
+
+    pthread_mutex_lock(&g_pool_mutex);
+    while (g_pool_busy > 0) {
+        pthread_cond_wait(&g_pool_done, &g_pool_mutex);
     }
+    pthread_mutex_unlock(&g_pool_mutex);
+}
 
-    _CelSortedChild buf[CEL_CLAY_MAX_SORTED_CHILDREN];
-    int count = 0;
+#else
+
+static void layout_pool_stop(void) {}
+
+#endif /* CELS_CLAY_PARALLEL_LAYOUT */
+
+/* Parallel: surfaces known to materialize windows while walking are kept
+ * out of the batch, and run afterwards on this thread together with any
+ * surface that hit an unprepared window during the batch (its pass is
+ * redone from the start). */
+static void layout_jobs_run(ecs_world_t* world) {
+    g_job_world = world;
+#ifdef CELS_CLAY_PARALLEL_LAYOUT
+    if (g_job_count > 1 && g_layout_threads > 1 && !g_layout_serial_only &&
+        layout_pool_resize(g_layout_threads - 1) > 0) {
+        int32_t total = g_job_count;
+        int32_t batch = 0;
+        for (int32_t j = 0; j < total; j++) {
+            if (g_surfaces[g_jobs[j].state].walk_serial) continue;
+            _CelClayLayoutJob job = g_jobs[batch];
+            g_jobs[batch++] = g_jobs[j];
+            g_jobs[j] = job;
+        }
 
-    ecs_entity_t so_id = (ecs_entity_t)CELS_SIBLING_ORDER;
-    ecs_iter_t it = ecs_children(g_layout_world, g_layout_current_entity);
-    while (ecs_children_next(&it)) {
-        for (int i = 0; i < it.count && count < CEL_CLAY_MAX_SORTED_CHILDREN; i++) {
-            const cels_sibling_order_t* so = (const cels_sibling_order_t*)
-                ecs_get_id(g_layout_world, it.entities[i], so_id);
-            buf[count].entity = it.entities[i];
-            buf[count].order = so ? so->order : (uint32_t)count;
-            count++;
+        g_job_count = batch;
+        g_layout_batch_parallel = true;
+        layout_jobs_run_parallel();
+        g_layout_batch_parallel = false;
+        g_job_count = total;
+
+        for (int32_t j = 0; j < total; j++) {
+            if (g_surfaces[g_jobs[j].state].walk_serial) layout_job_run(j);
         }
+        g_job_world = NULL;
+        return;
     }
+#endif
+    layout_jobs_run_serial();
+    g_job_world = NULL;
+}
+
+/* Run the queued jobs. A pass that exceeded Clay's element or word
+ * capacity produced a truncated tree: grow the limits, rebuild those
+ * surfaces' contexts with larger arenas and run their passes again, this
+ * frame. */
+static void layout_jobs_run_grown(ecs_world_t* world) {
+    layout_jobs_run(world);
+
+    for (int attempt = 0; attempt < CEL_CLAY_CAPACITY_RETRIES && g_job_count > 0; attempt++) {
+        uint32_t overflow = 0;
+        int32_t retry = 0;
+        for (int32_t j = 0; j < g_job_count; j++) {
+            uint32_t bits = _cel_clay_context_take_overflow(
+                surface_state_memory(&g_surfaces[g_jobs[j].state]));
+            if (bits) {
+                overflow |= bits;
+                g_jobs[retry++] = g_jobs[j];
+            }
+        }
+        if (overflow == 0) break;
 
-    /* Insertion sort by order */
-    for (int i = 1; i < count; i++) {
-        _CelSortedChild tmp = buf[i];
-        int j = i - 1;
-        while (j >= 0 && buf[j].order > tmp.order) {
-            buf[j + 1] = buf[j];
-            j--;
+        _cel_clay_grow_limits(overflow);
+        g_job_count = 0;
+        for (int32_t j = 0; j < retry; j++) {
+            if (surface_state_rebuild_context(&g_surfaces[g_jobs[j].state], g_jobs[j].dims)) {
+                g_jobs[g_job_count++] = g_jobs[j];
+            }
         }
-        buf[j + 1] = tmp;
+        layout_jobs_run(world);
+        g_layout_stats.passes_executed += (uint64_t)g_job_count;
     }
+}
 
-    if (index >= 0 && index < count) {
-        clay_walk_entity(g_layout_world, buf[index].entity);
-        return true;
+static void layout_jobs_cleanup(void) {
+    layout_pool_stop();
+    free(g_jobs);
+    g_jobs = NULL;
+    g_job_count = 0;
+    g_job_capacity = 0;
+    g_layout_serial_only = false;
+}
+
+void cel_clay_set_layout_threads(uint32_t threads) {
+    if (threads == 0) threads = 1;
+#ifndef CELS_CLAY_PARALLEL_LAYOUT
+    if (threads > 1) {
+        static bool warned = false;
+        if (!warned) {
+            fprintf(stderr, "[cels-clay] layout_threads = %u ignored: built "
+                    "without CELS_CLAY_PARALLEL_LAYOUT\n", threads);
+            warned = true;
+        }
+        threads = 1;
     }
-    return false;  /* No child at that index */
+#endif
+    g_layout_threads = threads;
+}
+
+uint32_t cel_clay_get_layout_threads(void) {
+    return g_layout_serial_only ? 1 : g_layout_threads;
+}
+
+void _cel_clay_layout_require_serial(void) {
+    g_layout_serial_only = true;
 }
 
 /* ============================================================================
- * Render Command Storage
+ * Subtree Cache Upkeep (between passes)
  * ============================================================================
  *
- * After Clay_EndLayout(), render commands are stored for the render bridge
- * to consume. Accessible via _cel_clay_get_render_commands().
+ * Before the passes: drop entries whose container left the tree or
+ * stopped being cacheable, invalidate entries whose subtree changed.
+ * After the passes: check every stand-in's size (re-running surfaces
+ * where one differs), expand the stand-ins into the surface's spliced
+ * command array, and record the cacheable containers that were walked.
+ *
+ * Recording lays a subtree out a second time, alone in g_record_context:
+ * the surface pass's commands can't be cut out by range, since Clay emits
+ * floating and z-indexed elements and scissor ends out of tree order and
+ * clips to the surface. The cost is paid once per change of the subtree,
+ * after which the pass walks a single stand-in instead.
  */
 
-Clay_RenderCommandArray _cel_clay_get_render_commands(void) {
-    return g_last_render_commands;
+/* Context subtrees are recorded in; created on first use, no culling so
+ * content overflowing the container is kept. Its word measurements are
+ * dropped with the surfaces' (g_measure_generation). */
+static Clay_Context* g_record_context = NULL;
+static void* g_record_memory = NULL;
+static uint32_t g_record_measure_generation = 0;
+
+static void subtree_cache_free(_CelClaySubtreeCache* cache) {
+    free(cache->commands);
+    free(cache->text);
 }
 
-Clay_Dimensions _cel_clay_get_layout_dimensions(void) {
-    return g_last_layout_dimensions;
+static void subtree_caches_sync(bool invalidated) {
+    const _CelClayNode* nodes = _cel_clay_tree_nodes(NULL);
+    for (int32_t i = 0; i < g_cache_count; ) {
+        int32_t node = _cel_clay_tree_find(g_caches[i].entity);
+        if (node < 0 || nodes[node].kind != CEL_CLAY_NODE_CONTAINER ||
+            !nodes[node].config.container.cacheable) {
+            subtree_cache_free(&g_caches[i]);
+            g_caches[i] = g_caches[--g_cache_count];
+            continue;
+        }
+        if (invalidated || _cel_clay_tree_subtree_changed(node)) {
+            g_caches[i].valid = false;
+        }
+        i++;
+    }
+}
+
+/* Stand-ins laid out at another size than recorded invalidate their entry;
+ * their surfaces are queued to run again. Returns the number queued. */
+static int32_t subtree_caches_check(void) {
+    g_job_count = 0;
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        _CelClaySurfaceState* state = &g_surfaces[i];
+        if (!state->ran || state->replay_count == 0) continue;
+
+        Clay_SetCurrentContext(state->context);
+        bool rerun = false;
+        for (int32_t r = 0; r < state->replay_count; r++) {
+            _CelClaySubtreeCache* cache = &g_caches[state->replays[r]];
+            Clay_ElementData data = Clay_GetElementData(element_id_for(cache->entity, 0));
+            if (data.found && (data.boundingBox.width != cache->size.width ||
+                               data.boundingBox.height != cache->size.height)) {
+                cache->valid = false;
+                rerun = true;
+            }
+        }
+        if (rerun) layout_job_push(i, state->node, state->output.dimensions);
+    }
+    return g_job_count;
+}
+
+/* Replace the stand-in commands of a surface's last pass with the cached
+ * subtree commands, into the state's own array */
+static void subtree_caches_splice(_CelClaySurfaceState* state) {
+    Clay_RenderCommandArray commands = state->output.commands;
+    int32_t total = commands.length;
+    for (int32_t r = 0; r < state->replay_count; r++) {
+        total += g_caches[state->replays[r]].count;
+    }
+    if (total > state->spliced_capacity) {
+        Clay_RenderCommand* spliced = (Clay_RenderCommand*)realloc(
+            state->spliced, sizeof(Clay_RenderCommand) * (size_t)total);
+        if (!spliced) {
+            fprintf(stderr, "[cels-clay] subtree cache: out of memory replaying commands\n");
+            return;
+        }
+        state->spliced = spliced;
+        state->spliced_capacity = total;
+    }
+
+    int32_t count = 0;
+    for (int32_t i = 0; i < commands.length; i++) {
+        const Clay_RenderCommand* command = &commands.internalArray[i];
+        if (command->commandType != CLAY_RENDER_COMMAND_TYPE_CUSTOM ||
+            command->renderData.custom.customData != &g_standin_marker) {
+            state->spliced[count++] = *command;
+            continue;
+        }
+        for (int32_t r = 0; r < state->replay_count; r++) {
+            const _CelClaySubtreeCache* cache = &g_caches[state->replays[r]];
+            if (cache->element_id != command->id) continue;
+            for (int32_t c = 0; c < cache->count; c++) {
+                Clay_RenderCommand replayed = cache->commands[c];
+                replayed.boundingBox.x += command->boundingBox.x;
+                replayed.boundingBox.y += command->boundingBox.y;
+                state->spliced[count++] = replayed;
+            }
+            g_layout_stats.subtrees_replayed++;
+            break;
+        }
+    }
+
+    state->output.commands = (Clay_RenderCommandArray){
+        .capacity = state->spliced_capacity,
+        .length = count,
+        .internalArray = state->spliced
+    };
+}
+
+/* Copy recorded commands into an entry, text strings included (the frame
+ * arena they may point into is reset by the next pass) */
+static bool subtree_cache_store(_CelClaySubtreeCache* cache,
+                                Clay_RenderCommandArray commands) {
+    size_t text_size = 0;
+    for (int32_t i = 0; i < commands.length; i++) {
+        if (commands.internalArray[i].commandType == CLAY_RENDER_COMMAND_TYPE_TEXT) {
+            text_size += (size_t)commands.internalArray[i].renderData.text.stringContents.length;
+        }
+    }
+
+    if (commands.length > cache->capacity) {
+        Clay_RenderCommand* grown = (Clay_RenderCommand*)realloc(
+            cache->commands, sizeof(Clay_RenderCommand) * (size_t)commands.length);
+        if (!grown) return false;
+        cache->commands = grown;
+        cache->capacity = commands.length;
+    }
+    if (text_size > cache->text_capacity) {
+        char* grown = (char*)realloc(cache->text, text_size);
+        if (!grown) return false;
+        cache->text = grown;
+        cache->text_capacity = text_size;
+    }
+
+    size_t offset = 0;
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand command = commands.internalArray[i];
+        if (command.commandType == CLAY_RENDER_COMMAND_TYPE_TEXT) {
+            Clay_StringSlice* string = &command.renderData.text.stringContents;
+            if (string->length > 0) {
+                memcpy(cache->text + offset, string->chars, (size_t)string->length);
+            }
+            string->chars = cache->text + offset;
+            string->baseChars = string->chars;
+            offset += (size_t)string->length;
+        }
+        cache->commands[i] = command;
+    }
+    cache->count = commands.length;
+    return true;
+}
+
+/* Lay out the subtree of cacheable node `node` alone, at the size it got
+ * in the surface's last pass, and store its commands */
+static void subtree_cache_record(ecs_world_t* world, _CelClaySurfaceState* state,
+                                 int32_t node) {
+    const _CelClayNode* nodes = _cel_clay_tree_nodes(NULL);
+    ecs_entity_t entity = nodes[node].entity;
+
+    Clay_SetCurrentContext(state->context);
+    Clay_ElementData data = Clay_GetElementData(element_id_for(entity, 0));
+    if (!data.found || data.boundingBox.width <= 0.0f || data.boundingBox.height <= 0.0f) {
+        return;
+    }
+    Clay_Dimensions size = { data.boundingBox.width, data.boundingBox.height };
+
+    int32_t index = subtree_cache_find(entity);
+    if (index < 0) {
+        if (g_cache_count >= g_cache_capacity) {
+            int32_t cap = g_cache_capacity ? g_cache_capacity * 2 : 8;
+            _CelClaySubtreeCache* caches = (_CelClaySubtreeCache*)realloc(
+                g_caches, sizeof(_CelClaySubtreeCache) * (size_t)cap);
+            if (!caches) return;
+            g_caches = caches;
+            g_cache_capacity = cap;
+        }
+        index = g_cache_count++;
+        g_caches[index] = (_CelClaySubtreeCache){
+            .entity = entity,
+            .element_id = element_id_for(entity, 0).id
+        };
+    }
+
+    if (g_record_context == NULL) {
+        g_record_context = _cel_clay_context_create(size, &g_record_memory);
+        if (g_record_context == NULL) return;
+        Clay_SetCullingEnabled(false);
+        g_record_measure_generation = g_measure_generation;
+    }
+
+    Clay_Sizing root_sizing = {
+        .width = CLAY_SIZING_FIXED(size.width),
+        .height = CLAY_SIZING_FIXED(size.height)
+    };
+
+    Clay_SetCurrentContext(g_record_context);
+    if (g_record_measure_generation != g_measure_generation) {
+        Clay_ResetMeasureTextCache();
+        g_record_measure_generation = g_measure_generation;
+    }
+    Clay_SetLayoutDimensions(size);
+    g_frame_arena = &state->frame_arena;
+    Clay_BeginLayout();
+    g_layout_world = world;
+    g_layout_pass_active = true;
+    g_recording = true;
+    g_record_root_sizing = &root_sizing;
+    CEL_CLAY_PROFILE_BEGIN(walk);
+    clay_walk_nodes(node, nodes[node].end);
+    CEL_CLAY_PROFILE_END(walk, CEL_CLAY_PHASE_WALK);
+    g_record_root_sizing = NULL;
+    g_recording = false;
+    g_layout_pass_active = false;
+    g_layout_world = NULL;
+    g_frame_arena = NULL;
+    CEL_CLAY_PROFILE_BEGIN(end_layout);
+    Clay_RenderCommandArray commands = Clay_EndLayout();
+    CEL_CLAY_PROFILE_END(end_layout, CEL_CLAY_PHASE_END_LAYOUT);
+
+    /* Truncated recording: grow the limits, rebuild the context next time */
+    uint32_t overflow = _cel_clay_context_take_overflow(g_record_memory);
+    if (overflow) {
+        _cel_clay_grow_limits(overflow);
+        _cel_clay_context_destroy(g_record_memory);
+        g_record_context = NULL;
+        g_record_memory = NULL;
+        return;
+    }
+
+    _CelClaySubtreeCache* cache = &g_caches[index];
+    cache->size = size;
+    cache->valid = subtree_cache_store(cache, commands);
+    if (cache->valid) g_layout_stats.subtrees_recorded++;
+}
+
+/* After the passes (and capacity retries) of a frame */
+static void subtree_caches_resolve(ecs_world_t* world) {
+    for (int attempt = 0; attempt < CEL_CLAY_CAPACITY_RETRIES; attempt++) {
+        if (subtree_caches_check() == 0) break;
+        g_layout_stats.passes_executed += (uint64_t)g_job_count;
+        layout_jobs_run_grown(world);
+    }
+
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        _CelClaySurfaceState* state = &g_surfaces[i];
+        if (!state->ran) continue;
+        if (state->replay_count > 0) subtree_caches_splice(state);
+        for (int32_t r = 0; r < state->record_count; r++) {
+            subtree_cache_record(world, state, state->records[r]);
+        }
+    }
+}
+
+static void subtree_caches_cleanup(void) {
+    for (int32_t i = 0; i < g_cache_count; i++) {
+        subtree_cache_free(&g_caches[i]);
+    }
+    free(g_caches);
+    g_caches = NULL;
+    g_cache_count = 0;
+    g_cache_capacity = 0;
+
+    if (g_record_memory != NULL) {
+        _cel_clay_context_destroy(g_record_memory);
+        g_record_memory = NULL;
+        g_record_context = NULL;
+    }
 }
 
 /* ============================================================================
- * Layout System (PreStore phase)
+ * Paint-Only Patches
  * ============================================================================
  *
- * Runs each frame at PreStore phase. For each ClaySurface entity:
- * 1. Set Clay layout dimensions from ClaySurfaceConfig
- * 2. Reset frame arena for dynamic strings
- * 3. Clay_BeginLayout()
- * 4. Walk children of the surface entity (depth-first tree walk)
- * 5. Clay_EndLayout() -> store render commands
+ * The tree sync classifies a change that only touches colors (container
+ * bg, text color) as paint-only and does not count it as a change of the
+ * surface. A surface whose only changes are paint-only skips its pass:
+ * the matching commands of its previous render command array get the new
+ * colors in place, keyed by element id -- a container's RECTANGLE command
+ * carries its id, a text's TEXT commands the ids of its wrapped lines.
  *
- * Uses ecs_iter_t* callback (direct flecs system, matching cels-ncurses pattern).
+ * The patch needs every changed text to be indexed from the last pass;
+ * text inside a replayed cached subtree is not, and its surface is laid
+ * out instead. O(changes + texts + commands) per patched surface.
  */
 
+typedef struct {
+    uint64_t* keys;     /* 0 = empty slot */
+    int32_t* values;
+    int32_t capacity;   /* Power of two */
+    int32_t count;
+} _CelClayIdMap;
+
+typedef struct {
+    Clay_Color color;
+    uint8_t kind;       /* CEL_CLAY_NODE_CONTAINER or CEL_CLAY_NODE_TEXT */
+} _CelClayPaintTarget;
+
+static _CelClayIdMap g_paint_entities = {0};  /* Entity -> target */
+static _CelClayIdMap g_paint_commands = {0};  /* Command id + 1 -> target */
+static _CelClayPaintTarget* g_paint_targets = NULL;
+static int32_t g_paint_count = 0;
+static int32_t g_paint_capacity = 0;
+
+static bool id_map_reset(_CelClayIdMap* map, int32_t n) {
+    int32_t cap = 16;
+    while (cap < n * 2) cap *= 2;
+    if (cap > map->capacity) {
+        uint64_t* keys = (uint64_t*)realloc(map->keys, sizeof(uint64_t) * (size_t)cap);
+        if (!keys) return false;
+        map->keys = keys;
+        int32_t* values = (int32_t*)realloc(map->values, sizeof(int32_t) * (size_t)cap);
+        if (!values) return false;
+        map->values = values;
+        map->capacity = cap;
+    }
+    memset(map->keys, 0, sizeof(uint64_t) * (size_t)map->capacity);
+    map->count = 0;
+    return true;
+}
+
+static int32_t* id_map_slot(_CelClayIdMap* map, uint64_t key, bool insert) {
+    uint32_t mask = (uint32_t)map->capacity - 1;
+    uint32_t i = (uint32_t)((key * 11400714819323198485ull) >> 32) & mask;
+    while (map->keys[i] != 0) {
+        if (map->keys[i] == key) return &map->values[i];
+        i = (i + 1) & mask;
+    }
+    if (!insert || map->count * 2 >= map->capacity) return NULL;
+    map->keys[i] = key;
+    map->count++;
+    return &map->values[i];
+}
+
+static void id_map_free(_CelClayIdMap* map) {
+    free(map->keys);
+    free(map->values);
+    *map = (_CelClayIdMap){0};
+}
+
+/* Apply the frame's paint-only changes in surface node `surface` to its
+ * state's commands. Returns false if the surface must be laid out. */
+static bool paint_patch_surface(_CelClaySurfaceState* state, int32_t surface) {
+    int32_t change_count = 0;
+    const ecs_entity_t* changes = _cel_clay_tree_paint_changes(&change_count);
+    if (change_count == 0) return true;
+
+    const _CelClayNode* nodes = _cel_clay_tree_nodes(NULL);
+    if (change_count > g_paint_capacity) {
+        _CelClayPaintTarget* targets = (_CelClayPaintTarget*)realloc(
+            g_paint_targets, sizeof(_CelClayPaintTarget) * (size_t)change_count);
+        if (!targets) return false;
+        g_paint_targets = targets;
+        g_paint_capacity = change_count;
+    }
+    if (!id_map_reset(&g_paint_entities, change_count)) return false;
+
+    /* Targets in this surface, one per entity, with their current colors */
+    g_paint_count = 0;
+    int32_t text_targets = 0;
+    for (int32_t i = 0; i < change_count; i++) {
+        int32_t node = _cel_clay_tree_find(changes[i]);
+        if (node < 0 || nodes[node].surface != surface) continue;
+        int32_t* slot = id_map_slot(&g_paint_entities, (uint64_t)changes[i], true);
+        if (!slot) return false;
+        if (g_paint_entities.count > g_paint_count) {
+            *slot = g_paint_count++;
+            if (nodes[node].kind == CEL_CLAY_NODE_TEXT) text_targets++;
+        }
+        _CelClayPaintTarget* target = &g_paint_targets[*slot];
+        target->kind = nodes[node].kind;
+        target->color = nodes[node].kind == CEL_CLAY_NODE_TEXT
+            ? nodes[node].config.text.color : nodes[node].config.container.bg;
+    }
+    if (g_paint_count == 0) return true;
+
+    /* Command ids of the targets: a container's own id, a text's line ids */
+    int32_t id_count = g_paint_count;
+    Clay_SetCurrentContext(state->context);
+    for (int32_t t = 0; t < state->text_count; t++) {
+        int32_t* slot = id_map_slot(&g_paint_entities, (uint64_t)state->texts[t].entity, false);
+        if (slot) {
+            uint32_t element_id = 0;
+            id_count += _cel_clay_text_element_lines(state->texts[t].element, &element_id);
+        }
+    }
+    if (!id_map_reset(&g_paint_commands, id_count)) return false;
+
+    for (int32_t i = 0; i < change_count; i++) {
+        int32_t* slot = id_map_slot(&g_paint_entities, (uint64_t)changes[i], false);
+        if (!slot || g_paint_targets[*slot].kind != CEL_CLAY_NODE_CONTAINER) continue;
+        int32_t* command = id_map_slot(&g_paint_commands,
+                                       (uint64_t)element_id_for(changes[i], 0).id + 1, true);
+        if (command) *command = *slot;
+    }
+    int32_t texts_found = 0;
+    for (int32_t t = 0; t < state->text_count; t++) {
+        int32_t* slot = id_map_slot(&g_paint_entities, (uint64_t)state->texts[t].entity, false);
+        if (!slot) continue;
+        texts_found++;
+        uint32_t element_id = 0;
+        int32_t lines = _cel_clay_text_element_lines(state->texts[t].element, &element_id);
+        for (int32_t line = 0; line < lines; line++) {
+            int32_t* command = id_map_slot(&g_paint_commands,
+                                           (uint64_t)Clay__HashNumber((uint32_t)line, element_id).id + 1,
+                                           true);
+            if (command) *command = *slot;
+        }
+    }
+    if (texts_found < text_targets) return false;  /* Text not walked last pass */
+
+    Clay_RenderCommandArray commands = state->output.commands;
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand* command = &commands.internalArray[i];
+        if (command->commandType != CLAY_RENDER_COMMAND_TYPE_RECTANGLE &&
+            command->commandType != CLAY_RENDER_COMMAND_TYPE_TEXT) {
+            continue;
+        }
+        int32_t* slot = id_map_slot(&g_paint_commands, (uint64_t)command->id + 1, false);
+        if (!slot) continue;
+        const _CelClayPaintTarget* target = &g_paint_targets[*slot];
+        if (command->commandType == CLAY_RENDER_COMMAND_TYPE_TEXT) {
+            if (target->kind == CEL_CLAY_NODE_TEXT) {
+                command->renderData.text.textColor = target->color;
+            }
+        } else if (target->kind == CEL_CLAY_NODE_CONTAINER) {
+            command->renderData.rectangle.backgroundColor = target->color;
+        }
+    }
+    state->output.revision++;
+    g_layout_stats.passes_painted++;
+    return true;
+}
+
+static void paint_patches_cleanup(void) {
+    id_map_free(&g_paint_entities);
+    id_map_free(&g_paint_commands);
+    free(g_paint_targets);
+    g_paint_targets = NULL;
+    g_paint_count = 0;
+    g_paint_capacity = 0;
+}
+
+/* Totals for ClayEngineState: one O(surfaces) sweep over figures the
+ * passes already left behind */
+static void publish_engine_stats(uint32_t surfaces_laid_out) {
+    ClayEngineStats stats = {0};
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        _CelClaySurfaceState* state = &g_surfaces[i];
+        g_text_lookups_total += state->text_lookups;
+        g_text_misses_total += state->text_misses;
+        state->text_lookups = 0;
+        state->text_misses = 0;
+
+        _CelClayContextUsage usage = {0};
+        _cel_clay_context_usage(state->context, &usage);
+        stats.arena_bytes_used += usage.arena_used;
+        stats.arena_capacity += usage.arena_capacity;
+        stats.elements += usage.elements;
+        if (usage.elements > stats.elements_peak) stats.elements_peak = usage.elements;
+        stats.measure_words += usage.measured_words;
+        stats.render_commands += (uint32_t)state->output.commands.length;
+    }
+
+    stats.text_lookups = g_text_lookups_total;
+    stats.text_misses = g_text_misses_total;
+    stats.measure_hit_rate = g_text_lookups_total > 0
+        ? 1.0f - (float)g_text_misses_total / (float)g_text_lookups_total
+        : 1.0f;
+    stats.frame_arena_peak = g_arena_stats.peak_bytes;
+    stats.surfaces = (uint32_t)g_surface_count;
+    stats.surfaces_laid_out = surfaces_laid_out;
+    _cel_clay_engine_stats_publish(&stats);
+}
+
 static void ClayLayoutSystem_callback(ecs_iter_t* it) {
     (void)it;
+    CEL_CLAY_PROFILE_FRAME_BEGIN();
 
     ecs_world_t* world = cels_get_world(cels_get_context());
 
-    /* Find ClaySurface entities by querying for ClaySurfaceConfig */
-    ecs_iter_t surface_it = ecs_each_id(world, ClaySurfaceConfig_id);
-    while (ecs_each_next(&surface_it)) {
-        for (int i = 0; i < surface_it.count; i++) {
-            ecs_entity_t surface = surface_it.entities[i];
-            const ClaySurfaceConfig* config = (const ClaySurfaceConfig*)
-                ecs_get_id(world, surface, ClaySurfaceConfig_id);
-            if (!config) continue;
-
-            /* Skip layout if dimensions are too small */
-            if (config->width < 2.0f || config->height < 2.0f) continue;
-
-            /* 1. Set layout dimensions (reset text cache on resize) */
-            {
-                static float prev_w = 0, prev_h = 0;
-                if (config->width != prev_w || config->height != prev_h) {
-                    /* Reset text cache on actual resize (not initial 0->real) */
-                    if (prev_w > 0 && prev_h > 0) {
-                        Clay_ResetMeasureTextCache();
-                    }
-                    prev_w = config->width;
-                    prev_h = config->height;
-                }
-            }
-            Clay_SetLayoutDimensions((Clay_Dimensions){
-                .width = config->width,
-                .height = config->height
-            });
-            g_last_layout_dimensions = (Clay_Dimensions){
-                .width = config->width,
-                .height = config->height
-            };
-
-            /* 2. Reset frame arena for this pass */
-            _cel_clay_frame_arena_reset();
-
-            /* 3. Begin layout pass */
-            Clay_BeginLayout();
-            g_layout_world = world;
-            g_layout_pass_active = true;
-
-            /* 4. Walk children inside a TOP_TO_BOTTOM root container.
-             * Clay's implicit root uses LEFT_TO_RIGHT (enum default 0),
-             * which would arrange widgets horizontally. */
-            {
-                Clay_ElementDeclaration root_decl = {
-                    .layout = {
-                        .layoutDirection = CLAY_TOP_TO_BOTTOM,
-                        .sizing = { .width = CLAY_SIZING_GROW(0), .height = CLAY_SIZING_GROW(0) }
-                    }
-                };
-                for (CLAY__ELEMENT_DEFINITION_LATCH = (Clay__OpenElement(), Clay__ConfigureOpenElement(root_decl), 0);
-                     CLAY__ELEMENT_DEFINITION_LATCH < 1;
-                     CLAY__ELEMENT_DEFINITION_LATCH = 1, Clay__CloseElement()) {
-                    clay_walk_children(world, surface);
-                }
-            }
+    /* Bring the node array up to date; consume the explicit dirty flag */
+    _cel_clay_tree_sync(world);
+    bool invalidated = g_layout_dirty;
+    g_layout_dirty = false;
+    subtree_caches_sync(invalidated);
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        g_surfaces[i].ran = false;
+    }
+
+    /* Surfaces are the top-level nodes of the cached tree. Queue a job per
+     * surface that needs a pass. */
+    g_job_count = 0;
+    int32_t node_count = 0;
+    const _CelClayNode* nodes = _cel_clay_tree_nodes(&node_count);
+    for (int32_t s = 0; s < node_count; s = nodes[s].end) {
+        ecs_entity_t surface = nodes[s].entity;
+        Clay_Dimensions dims = {
+            .width = nodes[s].config.surface.width,
+            .height = nodes[s].config.surface.height
+        };
+
+        /* Skip layout if dimensions are too small (keep the state alive) */
+        _CelClaySurfaceState* state = surface_state_get(surface, dims);
+        if (state == NULL) continue;
+        state->alive = true;
+        if (dims.width < 2.0f || dims.height < 2.0f) continue;
+
+        /* 0. Nothing changed in this surface: keep its previous commands,
+         * recolored in place if only colors changed */
+        if (state->laid_out && !invalidated &&
+            !_cel_clay_tree_surface_changed(surface) &&
+            dims.width == state->output.dimensions.width &&
+            dims.height == state->output.dimensions.height &&
+            paint_patch_surface(state, s)) {
+            g_layout_stats.passes_skipped++;
+            continue;
+        }
 
-            /* 5. End layout pass */
-            g_layout_pass_active = false;
-            g_layout_world = NULL;
-            g_layout_current_entity = 0;
+        /* Materialize child windows now: the walk itself must not grow the
+         * node array. May move it -- re-fetch. */
+        _cel_clay_tree_prepare_windows(s);
+        nodes = _cel_clay_tree_nodes(&node_count);
 
-            g_last_render_commands = Clay_EndLayout();
+        if (layout_job_push((int32_t)(state - g_surfaces), s, dims)) {
+            g_layout_stats.passes_executed++;
         }
     }
+
+    int32_t surfaces_laid_out = g_job_count;
+    layout_jobs_run_grown(world);
+
+    subtree_caches_resolve(world);
+
+    surface_states_prune();
+
+    /* Frame arena usage after this frame (all surfaces) */
+    size_t peak = g_arena_stats.peak_bytes;
+    g_arena_stats = (ClayFrameArenaStats){0};
+    for (int32_t i = 0; i < g_surface_count; i++) {
+        arena_measure(&g_surfaces[i].frame_arena, &g_arena_stats);
+    }
+    g_arena_stats.peak_bytes = g_arena_stats.bytes_used > peak
+        ? g_arena_stats.bytes_used : peak;
+
+    publish_engine_stats((uint32_t)surfaces_laid_out);
+
+    if (_cel_clay_primary_context() != NULL) {
+        Clay_SetCurrentContext(_cel_clay_primary_context());
+    }
 }
 
 /* ============================================================================
@@ -699,4 +2077,7 @@ void _cel_clay_layout_system_register(void) {
     sys_desc.callback = ClayLayoutSystem_callback;
 
     ecs_system_init(world, &sys_desc);
+
+    /* Tree cache observers (components are registered by now) */
+    _cel_clay_tree_observers_register(world);
 }
@@ -23,7 +23,7 @@
  *
  * Coordinate mapping:
  *   Clay computes layout in float units. The text measurement callback
- *   returns dimensions in terminal cell columns (via wcwidth). Non-text
+ *   returns dimensions in terminal cell columns (clay_text_width.c). Non-text
  *   bounding boxes (rectangles, borders, scissors) are scaled horizontally
  *   by cell_aspect_ratio to compensate for terminal cells being taller
  *   than wide. Text bounding boxes are NOT aspect-ratio-scaled because
@@ -41,6 +41,11 @@
 
 #include "cels-clay/clay_ncurses_renderer.h"
 #include "cels-clay/clay_render.h"
+#include "cels-clay/clay_layout.h"
+#include "cels-clay/clay_text_width.h"
+#include "cels-clay/clay_cells.h"
+#include "cels-clay/clay_profile.h"
+#include "cels-clay/clay_trace.h"
 #include "clay.h"
 #include <cels/cels.h>
 
@@ -60,7 +65,6 @@ typedef struct CEL_TextAttr {
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
-#include <wchar.h>
 
 /* ============================================================================
  * Text Attribute Helpers
@@ -105,49 +109,17 @@ static const ClayNcursesTheme* g_theme = NULL;
  * Coordinate Mapping
  * ============================================================================
  *
- * Two conversion functions:
- *
- * clay_bbox_to_cells: For rectangles, borders, scissors. Applies aspect
- *   ratio scaling to horizontal values (x, width) so that Clay layout
- *   proportions render correctly in the terminal.
- *
- * clay_text_bbox_to_cells: For text commands. Does NOT apply aspect ratio
- *   because the text measurement callback returns widths in cell columns
- *   (wcwidth units), which are already terminal-accurate.
+ * clay_bbox_to_cells: A thin wrapper over clay_cells.h (shared with the
+ * headless renderer), used for every command type. Applies aspect ratio
+ * scaling to horizontal values (x, width) so that Clay layout proportions
+ * render correctly in the terminal. For text the scaled width is exactly
+ * the cell columns reported by the text measurement callback (built-in
+ * width table).
  */
 
 static TUI_CellRect clay_bbox_to_cells(Clay_BoundingBox bbox) {
-    float ar = g_theme->cell_aspect_ratio;
-
-    /* Scale horizontal values by aspect ratio */
-    float x = bbox.x * ar;
-    float w = bbox.width * ar;
-
-    /* Round to nearest cell (CONTEXT.md decision) */
-    int cx = (int)roundf(x);
-    int cy = (int)roundf(bbox.y);
-    int cw = (int)roundf(w);
-    int ch = (int)roundf(bbox.height);
-
-    /* Minimum 1 cell for non-zero dimensions */
-    if (bbox.width > 0 && cw < 1) cw = 1;
-    if (bbox.height > 0 && ch < 1) ch = 1;
-
-    return (TUI_CellRect){ .x = cx, .y = cy, .w = cw, .h = ch };
-}
-
-static TUI_CellRect clay_text_bbox_to_cells(Clay_BoundingBox bbox) {
-    /* No aspect ratio scaling -- text widths are already in cell columns */
-    int cx = (int)roundf(bbox.x * g_theme->cell_aspect_ratio);
-    int cy = (int)roundf(bbox.y);
-    int cw = (int)roundf(bbox.width);
-    int ch = (int)roundf(bbox.height);
-
-    /* Minimum 1 cell for non-zero dimensions */
-    if (bbox.width > 0 && cw < 1) cw = 1;
-    if (bbox.height > 0 && ch < 1) ch = 1;
-
-    return (TUI_CellRect){ .x = cx, .y = cy, .w = cw, .h = ch };
+    _CelClayCellRect r = _cel_clay_bbox_to_cells(bbox, g_theme->cell_aspect_ratio);
+    return (TUI_CellRect){ .x = r.x, .y = r.y, .w = r.w, .h = r.h };
 }
 
 /* (Overlay layer removed -- the old TUI_Layer API no longer exists.
@@ -186,32 +158,15 @@ static void render_rectangle(TUI_DrawContext* ctx, TUI_CellRect rect,
  * Renders Clay_StringSlice text. The slice is NOT null-terminated, so we
  * copy to a stack buffer (with malloc fallback for long strings) before
  * passing to tui_draw_text which expects const char*.
+ *
+ * Only the prefix that fits the measured width (built-in width table, same
+ * as the measure callback) is drawn, so a host whose libc disagrees about a
+ * character's width cannot spill text past its laid-out box.
  */
 
-/* Find the background color of the nearest parent RECTANGLE that contains
- * the given bounding box. Clay emits commands depth-first: a parent's
- * RECTANGLE always precedes its children's TEXT commands. Scanning backwards
- * from the TEXT index, the first containing RECTANGLE is the innermost parent. */
+/* Parent background resolution is shared with the headless renderer */
 static Clay_Color find_parent_bg(Clay_RenderCommandArray cmds, int32_t text_idx) {
-    Clay_BoundingBox tb = Clay_RenderCommandArray_Get(&cmds, text_idx)->boundingBox;
-
-    for (int32_t j = text_idx - 1; j >= 0; j--) {
-        Clay_RenderCommand* prev = Clay_RenderCommandArray_Get(&cmds, j);
-        if (prev->commandType != CLAY_RENDER_COMMAND_TYPE_RECTANGLE) continue;
-
-        /* Skip transparent rectangles (alpha < 2 = border-only, no fill) */
-        Clay_Color bg = prev->renderData.rectangle.backgroundColor;
-        if (bg.a < 2.0f) continue;
-
-        Clay_BoundingBox rb = prev->boundingBox;
-        if (rb.x <= tb.x && rb.y <= tb.y &&
-            rb.x + rb.width >= tb.x + tb.width &&
-            rb.y + rb.height >= tb.y + tb.height) {
-            return bg;
-        }
-    }
-
-    return (Clay_Color){0, 0, 0, 0};  /* alpha=0: no parent bg found */
+    return _cel_clay_find_parent_bg(cmds, text_idx);
 }
 
 static void render_text(TUI_DrawContext* ctx, TUI_CellRect rect,
@@ -221,15 +176,18 @@ static void render_text(TUI_DrawContext* ctx, TUI_CellRect rect,
     Clay_StringSlice text = data->stringContents;
     if (text.length <= 0 || text.chars == NULL) return;
 
+    int32_t length = _cel_clay_text_fit(text.chars, text.length, rect.w);
+    if (length <= 0) return;
+
     /* Null-terminate: stack buffer for typical strings, malloc fallback */
     char buf_stack[512];
     char* buf = buf_stack;
-    if (text.length >= (int32_t)sizeof(buf_stack)) {
-        buf = (char*)malloc((size_t)text.length + 1);
+    if (length >= (int32_t)sizeof(buf_stack)) {
+        buf = (char*)malloc((size_t)length + 1);
         if (!buf) return;
     }
-    memcpy(buf, text.chars, (size_t)text.length);
-    buf[text.length] = '\0';
+    memcpy(buf, text.chars, (size_t)length);
+    buf[length] = '\0';
 
     Clay_Color c = data->textColor;
     TUI_Color bg = (parent_bg.a > 0)
@@ -422,103 +380,202 @@ static void render_border_decor(TUI_DrawContext* ctx, TUI_CellRect rect,
 }
 
 /* ============================================================================
- * Provider Callback (REND-04 scissor, REND-05 coordinate mapping)
+ * Command Dispatch (REND-04 scissor, REND-05 coordinate mapping)
+ * ============================================================================
+ *
+ * Draws one surface's render commands into a draw context, dispatching by
+ * command type. With an `area`, commands that do not intersect it are
+ * skipped (scissors are still applied, so clipping nests correctly).
+ */
+
+static bool cells_intersect(TUI_CellRect a, TUI_CellRect b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w &&
+           a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+static void render_commands(TUI_DrawContext* ctx, Clay_RenderCommandArray cmds,
+                            const TUI_CellRect* area) {
+    bool traced = CEL_CLAY_TRACE_BEGIN("draw", -1);
+    if (traced) CEL_CLAY_TRACE_ARG("commands", cmds.length);
+
+    for (int32_t j = 0; j < cmds.length; j++) {
+        Clay_RenderCommand* cmd = Clay_RenderCommandArray_Get(&cmds, j);
+
+        switch (cmd->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+                TUI_CellRect cell_rect = clay_bbox_to_cells(cmd->boundingBox);
+                if (area && !cells_intersect(cell_rect, *area)) break;
+                if (cmd->userData) {
+                    /* Border decoration: skip normal full-area fill.
+                     * render_border_decor fills only the interior (inside
+                     * border) so panel bg doesn't bleed outside. */
+                    Clay_Color parent_bg = find_parent_bg(cmds, j);
+                    render_border_decor(ctx, cell_rect,
+                                         (CelClayBorderDecor*)cmd->userData,
+                                         parent_bg);
+                } else {
+                    render_rectangle(ctx, cell_rect, &cmd->renderData.rectangle);
+                }
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+                TUI_CellRect cell_rect = clay_bbox_to_cells(cmd->boundingBox);
+                if (area && !cells_intersect(cell_rect, *area)) break;
+                Clay_Color parent_bg = find_parent_bg(cmds, j);
+                render_text(ctx, cell_rect, &cmd->renderData.text,
+                            parent_bg, cmd->userData);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+                TUI_CellRect cell_rect = clay_bbox_to_cells(cmd->boundingBox);
+                if (area && !cells_intersect(cell_rect, *area)) break;
+                Clay_Color border_parent_bg = find_parent_bg(cmds, j);
+                render_border(ctx, cell_rect, &cmd->renderData.border,
+                              border_parent_bg);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
+                TUI_CellRect cell_rect = clay_bbox_to_cells(cmd->boundingBox);
+                tui_push_scissor(ctx, cell_rect);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+                tui_pop_scissor(ctx);
+                break;
+            }
+            default:
+                break;  /* IMAGE, CUSTOM, NONE -- skip silently */
+        }
+    }
+
+    if (traced) CEL_CLAY_TRACE_END();
+}
+
+/* ============================================================================
+ * Incremental Repaint
+ * ============================================================================
+ *
+ * stdscr keeps the last frame, so when every surface has a render diff
+ * only the damaged cells are redrawn: each damage rectangle is cleared to
+ * the window background and every surface's commands that intersect it
+ * are drawn again, clipped to it. Damage is widened by one cell per side
+ * to cover the rounding in the cell mapping.
+ */
+
+static TUI_CellRect damage_to_cells(Clay_BoundingBox box) {
+    float ar = g_theme->cell_aspect_ratio;
+    int x0 = (int)floorf(box.x * ar) - 1;
+    int y0 = (int)floorf(box.y) - 1;
+    int x1 = (int)ceilf((box.x + box.width) * ar) + 1;
+    int y1 = (int)ceilf(box.y + box.height) + 1;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > COLS) x1 = COLS;
+    if (y1 > LINES) y1 = LINES;
+    return (TUI_CellRect){ .x = x0, .y = y0,
+                           .w = x1 > x0 ? x1 - x0 : 0,
+                           .h = y1 > y0 ? y1 - y0 : 0 };
+}
+
+static void repaint_area(TUI_DrawContext* ctx, TUI_CellRect area,
+                         int32_t surface_count) {
+    if (area.w <= 0 || area.h <= 0) return;
+
+    chtype blank = getbkgd(stdscr);
+    for (int y = area.y; y < area.y + area.h; y++) {
+        mvwhline(stdscr, y, area.x, blank, area.w);
+    }
+
+    for (int32_t i = 0; i < surface_count; i++) {
+        const ClayRenderableData* data = cel_clay_get_surface_render_data(i);
+        if (data->render_commands.length <= 0) continue;
+        tui_scissor_reset(ctx);
+        tui_push_scissor(ctx, area);
+        render_commands(ctx, data->render_commands, &area);
+    }
+}
+
+/* ============================================================================
+ * Provider Callback
  * ============================================================================
  *
  * The main render loop. Called as a ClayRenderable provider at OnStore phase,
- * after ClayRenderDispatch has updated the ClayRenderableData singleton.
+ * after ClayRenderDispatch has published each surface's ClayRenderableData.
  *
  * Flow:
- *   1. Check dirty flag (skip if no commands)
+ *   1. Skip if no surface has commands, or none is dirty (stdscr still
+ *      holds the previous frame)
  *   2. Get background layer draw context
- *   3. Reset scissor stack
- *   4. Iterate render commands, dispatch by type
+ *   3. If every surface has a partial diff: repaint the damage only
+ *   4. Otherwise, per surface, in surface order: reset scissor stack,
+ *      draw commands
+ *   5. Present the frame once
  */
 
 static void clay_ncurses_render(cels_iter_t* it) {
     (void)it;
-    /* Read render commands directly from the layout system getter
+    /* Read render commands from the render bridge's per-surface data
      * rather than querying the singleton via cels_iter_column. */
-    Clay_RenderCommandArray cmds_check = cel_clay_get_render_commands();
-    if (cmds_check.length <= 0) return;
+    int32_t surface_count = cel_clay_surface_count();
+    int32_t total_commands = 0;
+    bool dirty = false;
+    bool full = false;
+    for (int32_t i = 0; i < surface_count; i++) {
+        const ClayRenderableData* data = cel_clay_get_surface_render_data(i);
+        total_commands += data->render_commands.length;
+        dirty = dirty || data->dirty;
+        full = full || data->diff == NULL || data->diff->full;
+    }
+    if (total_commands <= 0 || !dirty) return;
+
+    CEL_CLAY_PROFILE_BEGIN(draw);
+
+    /* Create draw context from stdscr (full terminal surface). */
+    TUI_DrawContext bg_ctx = tui_draw_context_create(
+        stdscr, 0, 0, COLS, LINES);
 
-    {
+    if (!full) {
+        for (int32_t i = 0; i < surface_count; i++) {
+            const ClayRenderDiff* diff = cel_clay_get_surface_render_data(i)->diff;
+            for (int32_t d = 0; d < diff->damage_count; d++) {
+                repaint_area(&bg_ctx, damage_to_cells(diff->damage[d]), surface_count);
+            }
+        }
+        tui_scissor_reset(&bg_ctx);
+    } else {
         /* Clear screen before drawing — no TUISurface means no automatic
          * clear/refresh cycle. We own the full stdscr lifecycle here. */
         werase(stdscr);
 
-        /* Create draw context from stdscr (full terminal surface). */
-        TUI_DrawContext bg_ctx = tui_draw_context_create(
-            stdscr, 0, 0, COLS, LINES);
-
-        /* Reset scissor stack */
-        tui_scissor_reset(&bg_ctx);
+        /* Render pass: all surfaces draw to the background surface */
+        for (int32_t i = 0; i < surface_count; i++) {
+            const ClayRenderableData* data = cel_clay_get_surface_render_data(i);
+            if (data->render_commands.length <= 0) continue;
 
-        Clay_RenderCommandArray cmds = cmds_check;
-
-        /* Render pass: all commands draw to background surface */
-        TUI_DrawContext* ctx = &bg_ctx;
-
-        for (int32_t j = 0; j < cmds.length; j++) {
-            Clay_RenderCommand* cmd = Clay_RenderCommandArray_Get(&cmds, j);
-
-            switch (cmd->commandType) {
-                case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
-                    TUI_CellRect cell_rect = clay_bbox_to_cells(cmd->boundingBox);
-                    if (cmd->userData) {
-                        /* Border decoration: skip normal full-area fill.
-                         * render_border_decor fills only the interior (inside
-                         * border) so panel bg doesn't bleed outside. */
-                        Clay_Color parent_bg = find_parent_bg(cmds, j);
-                        render_border_decor(ctx, cell_rect,
-                                             (CelClayBorderDecor*)cmd->userData,
-                                             parent_bg);
-                    } else {
-                        render_rectangle(ctx, cell_rect, &cmd->renderData.rectangle);
-                    }
-                    break;
-                }
-                case CLAY_RENDER_COMMAND_TYPE_TEXT: {
-                    /* Text bounding boxes are NOT aspect-ratio-scaled */
-                    TUI_CellRect cell_rect = clay_text_bbox_to_cells(cmd->boundingBox);
-                    Clay_Color parent_bg = find_parent_bg(cmds, j);
-                    render_text(ctx, cell_rect, &cmd->renderData.text,
-                                parent_bg, cmd->userData);
-                    break;
-                }
-                case CLAY_RENDER_COMMAND_TYPE_BORDER: {
-                    TUI_CellRect cell_rect = clay_bbox_to_cells(cmd->boundingBox);
-                    Clay_Color border_parent_bg = find_parent_bg(cmds, j);
-                    render_border(ctx, cell_rect, &cmd->renderData.border,
-                                  border_parent_bg);
-                    break;
-                }
-                case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
-                    TUI_CellRect cell_rect = clay_bbox_to_cells(cmd->boundingBox);
-                    tui_push_scissor(ctx, cell_rect);
-                    break;
-                }
-                case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
-                    tui_pop_scissor(ctx);
-                    break;
-                }
-                default:
-                    break;  /* IMAGE, CUSTOM, NONE -- skip silently */
-            }
+            /* Reset scissor stack -- clip regions never span surfaces */
+            tui_scissor_reset(&bg_ctx);
+            render_commands(&bg_ctx, data->render_commands, NULL);
         }
-
-        /* Present the frame */
-        wnoutrefresh(stdscr);
-        doupdate();
     }
+
+    CEL_CLAY_PROFILE_END(draw, CEL_CLAY_PHASE_DRAW);
+
+    /* Present the frame */
+    CEL_CLAY_PROFILE_BEGIN(present);
+    wnoutrefresh(stdscr);
+    doupdate();
+    CEL_CLAY_PROFILE_END(present, CEL_CLAY_PHASE_PRESENT);
 }
 
 /* ============================================================================
  * Text Measurement Callback (REND-07)
  * ============================================================================
  *
- * Provides wcwidth-accurate text dimensions for Clay_SetMeasureTextFunction.
+ * Provides text dimensions for cel_clay_set_measure_text_function, using the
+ * built-in Unicode width table (wcwidth conventions, not libc wcwidth).
  * Returns width in cell columns and height in lines (newline-separated).
+ * Clay calls this for every word it measures, so it works on the UTF-8
+ * slice directly (clay_text_width.c): no copy, no allocation, no locale.
  *
  * The width is NOT divided by aspect ratio. Text widths are reported in
  * cell columns, which is the native terminal unit. The renderer applies
@@ -538,61 +595,18 @@ static Clay_Dimensions clay_ncurses_measure_text(
         return (Clay_Dimensions){ .width = 0, .height = 0 };
     }
 
-    /* Null-terminate for mbstowcs */
-    char buf_stack[512];
-    char* buf = buf_stack;
-    if (text.length >= (int32_t)sizeof(buf_stack)) {
-        buf = (char*)malloc((size_t)text.length + 1);
-        if (!buf) return (Clay_Dimensions){ .width = 0, .height = 0 };
-    }
-    memcpy(buf, text.chars, (size_t)text.length);
-    buf[text.length] = '\0';
-
-    /* Convert to wide characters for wcwidth measurement */
-    wchar_t wbuf_stack[256];
-    wchar_t* wbuf = wbuf_stack;
-    size_t needed = mbstowcs(NULL, buf, 0);
-    if (needed == (size_t)-1) {
-        /* Fallback: count bytes as columns */
-        if (buf != buf_stack) free(buf);
-        return (Clay_Dimensions){ .width = (float)text.length / g_theme->cell_aspect_ratio, .height = 1 };
-    }
-    if (needed >= 256) {
-        wbuf = (wchar_t*)malloc((needed + 1) * sizeof(wchar_t));
-        if (!wbuf) {
-            if (buf != buf_stack) free(buf);
-            return (Clay_Dimensions){ .width = 0, .height = 0 };
-        }
-    }
-    mbstowcs(wbuf, buf, needed + 1);
-
-    /* Walk wide chars: accumulate column width via wcwidth, track newlines */
-    float max_width = 0;
-    float line_width = 0;
-    float height = 1;
-
-    for (size_t i = 0; i < needed; i++) {
-        if (wbuf[i] == L'\n') {
-            if (line_width > max_width) max_width = line_width;
-            line_width = 0;
-            height++;
-        } else {
-            int cw = wcwidth(wbuf[i]);
-            if (cw < 0) cw = 0;  /* Non-printable: zero width */
-            line_width += (float)cw;
-        }
-    }
-    if (line_width > max_width) max_width = line_width;
-
-    if (wbuf != wbuf_stack) free(wbuf);
-    if (buf != buf_stack) free(buf);
+    /* Measure the slice in place: columns of the widest line, line count */
+    _CelClayTextExtent extent = _cel_clay_text_extent(text.chars, text.length);
 
     /* Return width in Clay units (divide by aspect ratio).
      * Text measurement in cell columns is terminal-accurate, but Clay's
      * coordinate space is pre-divided by AR (ClaySurface width = terminal/AR).
      * Without this division, Clay over-allocates space for text and centering
      * calculations produce misaligned results in terminal rendering. */
-    return (Clay_Dimensions){ .width = max_width / g_theme->cell_aspect_ratio, .height = height };
+    return (Clay_Dimensions){
+        .width = (float)extent.columns / g_theme->cell_aspect_ratio,
+        .height = (float)extent.lines
+    };
 }
 
 /* ============================================================================
@@ -614,7 +628,7 @@ CEL_Module(Clay_NCurses, init) {
     if (!g_theme) g_theme = &CLAY_NCURSES_THEME_DEFAULT;
 
     /* Register text measurement callback */
-    Clay_SetMeasureTextFunction(clay_ncurses_measure_text, NULL);
+    cel_clay_set_measure_text_function(clay_ncurses_measure_text, NULL);
 
     /* Register render system at OnRender phase */
     ClayRenderableData_register();
@@ -632,7 +646,13 @@ void Clay_NCurses_configure(const ClayNcursesTheme* theme) {
 }
 
 void clay_ncurses_renderer_set_theme(const ClayNcursesTheme* theme) {
+    const ClayNcursesTheme* prev = g_theme;
     g_theme = theme ? theme : &CLAY_NCURSES_THEME_DEFAULT;
+
+    /* Measured widths are divided by the aspect ratio */
+    if (prev && prev->cell_aspect_ratio != g_theme->cell_aspect_ratio) {
+        cel_clay_invalidate_text_measurements();
+    }
 }
 
 /* ============================================================================
@@ -703,5 +723,10 @@ void clay_ncurses_handle_scroll_input(const struct NCurses_InputState* input,
         g_prev_raw_key = 0;  /* Reset if no key this frame */
     }
 
+    /* Scroll offsets feed the layout -- force a pass when they move */
+    if (scroll_delta.x != 0.0f || scroll_delta.y != 0.0f) {
+        cel_clay_layout_invalidate();
+    }
+
     Clay_UpdateScrollContainers(false, scroll_delta, delta_time);
 }
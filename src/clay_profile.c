@@ -0,0 +1,167 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Profile - Implementation
+ *
+ * Phases accumulate into atomic counters for the frame in flight (layout
+ * workers add concurrently). _cel_clay_profile_frame_begin, called once
+ * per frame from the layout system, moves the counters into the next ring
+ * slot and starts a new frame. Summaries sort a copy of the ring.
+ *
+ * Compiled only with CELS_CLAY_PROFILE (see CMakeLists.txt).
+ *
+ * NOTE: This file compiles in the CONSUMER's context (INTERFACE library).
+ */
+
+/* clock_gettime under strict -std */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#ifdef CELS_CLAY_PROFILE
+
+#include "cels-clay/clay_profile.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ============================================================================
+ * State
+ * ============================================================================ */
+
+static ClayProfileFrame g_ring[CEL_CLAY_PROFILE_HISTORY];
+static int32_t g_ring_head = 0;   /* Next slot to write */
+static int32_t g_ring_count = 0;
+
+static _Atomic uint64_t g_accum[CEL_CLAY_PHASE_COUNT];
+static uint64_t g_frame_start = 0;
+static uint32_t g_frame_number = 0;
+
+static const char* g_phase_names[CEL_CLAY_PHASE_COUNT] = {
+    "walk", "close", "end_layout", "dispatch", "draw", "present", "frame"
+};
+
+/* ============================================================================
+ * Recording
+ * ============================================================================ */
+
+uint64_t _cel_clay_profile_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void _cel_clay_profile_add(ClayProfilePhase phase, uint64_t ns) {
+    if ((unsigned)phase >= CEL_CLAY_PHASE_COUNT) return;
+    atomic_fetch_add_explicit(&g_accum[phase], ns, memory_order_relaxed);
+}
+
+void _cel_clay_profile_frame_begin(void) {
+    uint64_t now = _cel_clay_profile_now();
+
+    if (g_frame_number > 0) {
+        ClayProfileFrame* rec = &g_ring[g_ring_head];
+        rec->frame = g_frame_number;
+        rec->start_ns = g_frame_start;
+        for (int i = 0; i < CEL_CLAY_PHASE_COUNT; i++) {
+            rec->phase_ns[i] = atomic_exchange_explicit(&g_accum[i], 0, memory_order_relaxed);
+        }
+        rec->phase_ns[CEL_CLAY_PHASE_FRAME] = now - g_frame_start;
+
+        g_ring_head = (g_ring_head + 1) % CEL_CLAY_PROFILE_HISTORY;
+        if (g_ring_count < CEL_CLAY_PROFILE_HISTORY) g_ring_count++;
+    } else {
+        /* Anything timed before the first layout belongs to no frame */
+        for (int i = 0; i < CEL_CLAY_PHASE_COUNT; i++) {
+            atomic_store_explicit(&g_accum[i], 0, memory_order_relaxed);
+        }
+    }
+
+    g_frame_number++;
+    g_frame_start = now;
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+int32_t cel_clay_profile_history(ClayProfileFrame* out, int32_t max) {
+    if (!out || max <= 0) return 0;
+    int32_t n = g_ring_count < max ? g_ring_count : max;
+
+    /* The newest n frames, oldest first */
+    int32_t first = g_ring_head - n;
+    if (first < 0) first += CEL_CLAY_PROFILE_HISTORY;
+    for (int32_t i = 0; i < n; i++) {
+        out[i] = g_ring[(first + i) % CEL_CLAY_PROFILE_HISTORY];
+    }
+    return n;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of a sorted array */
+static uint64_t percentile(const uint64_t* sorted, int32_t n, int32_t pct) {
+    int32_t rank = (pct * n + 99) / 100;
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+void cel_clay_profile_summarize(ClayProfileSummary* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(ClayProfileSummary) * CEL_CLAY_PHASE_COUNT);
+
+    int32_t n = g_ring_count;
+    if (n == 0) return;
+
+    uint64_t samples[CEL_CLAY_PROFILE_HISTORY];
+    for (int p = 0; p < CEL_CLAY_PHASE_COUNT; p++) {
+        uint64_t sum = 0;
+        for (int32_t i = 0; i < n; i++) {
+            samples[i] = g_ring[i].phase_ns[p];
+            sum += samples[i];
+        }
+        qsort(samples, (size_t)n, sizeof(uint64_t), compare_u64);
+
+        out[p].samples = (uint32_t)n;
+        out[p].p50_ns = percentile(samples, n, 50);
+        out[p].p99_ns = percentile(samples, n, 99);
+        out[p].max_ns = samples[n - 1];
+        out[p].mean_ns = sum / (uint64_t)n;
+    }
+}
+
+const char* cel_clay_profile_phase_name(ClayProfilePhase phase) {
+    if ((unsigned)phase >= CEL_CLAY_PHASE_COUNT) return "unknown";
+    return g_phase_names[phase];
+}
+
+void cel_clay_profile_reset(void) {
+    g_ring_head = 0;
+    g_ring_count = 0;
+    g_frame_number = 0;
+    for (int i = 0; i < CEL_CLAY_PHASE_COUNT; i++) {
+        atomic_store_explicit(&g_accum[i], 0, memory_order_relaxed);
+    }
+}
+
+#endif /* CELS_CLAY_PROFILE */
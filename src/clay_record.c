@@ -0,0 +1,641 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Render Recording - Implementation
+ *
+ * Recorder: each frame is serialized into a reusable byte buffer and
+ * written with a single fwrite, so a frame is either in the file whole or
+ * (after a crash mid-write) detectably short.
+ *
+ * Replayer: the file is mapped read-only and its frames indexed once at
+ * open; decoding a frame converts its fixed-size command records back
+ * into Clay_RenderCommand without copying text.
+ *
+ * NOTE: This file compiles in the CONSUMER's context (INTERFACE library).
+ */
+
+/* mmap under strict -std */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "cels-clay/clay_record.h"
+#include "cels-clay/clay_render.h"
+#include "clay.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CEL_CLAY_HAS_MMAP 1
+#endif
+
+/* ============================================================================
+ * File Format
+ * ============================================================================
+ *
+ * All records are multiples of 8 bytes and start 8-byte aligned, so a
+ * mapped file can be read in place. Commands are stored field by field in
+ * a fixed layout independent of Clay's struct padding; `u16` holds the
+ * text font fields (fontId, fontSize, letterSpacing, lineHeight) or the
+ * border widths (left, right, top, bottom, betweenChildren).
+ */
+
+#define CEL_CLAY_RECORD_VERSION 1u
+#define CEL_CLAY_RECORD_FRAME_MAGIC 0x4D524643u  /* "CFRM" */
+
+static const char g_record_magic[8] = { 'C', 'L', 'A', 'Y', 'R', 'E', 'C', 0 };
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t command_size;      /* sizeof(_CelClayRecordCommand) */
+} _CelClayRecordHeader;
+
+typedef struct {
+    uint32_t magic;             /* CEL_CLAY_RECORD_FRAME_MAGIC */
+    uint32_t size;              /* Whole frame record, this header included */
+    uint32_t frame_number;
+    float delta_time;
+    uint32_t surface_count;
+    uint32_t reserved;
+} _CelClayRecordFrame;
+
+typedef struct {
+    uint64_t surface;
+    float layout_width;
+    float layout_height;
+    uint32_t command_count;
+    uint32_t text_size;         /* Padded to 8 */
+} _CelClayRecordSurface;
+
+typedef struct {
+    float x, y, width, height;
+    uint32_t id;
+    int16_t z_index;
+    uint8_t type;               /* Clay_RenderCommandType */
+    uint8_t clip;               /* Scissor: bit 0 horizontal, bit 1 vertical */
+    float color[4];             /* Background, text or border color */
+    float radius[4];            /* topLeft, topRight, bottomLeft, bottomRight */
+    uint16_t u16[5];
+    uint16_t reserved;
+    uint32_t text_offset;       /* Into the surface's text bytes */
+    uint32_t text_length;
+    uint32_t reserved2;
+    uint64_t user_data;
+    uint64_t pointer;           /* imageData / customData */
+} _CelClayRecordCommand;
+
+static size_t pad8(size_t size) {
+    return (size + 7u) & ~(size_t)7u;
+}
+
+/* ============================================================================
+ * Recorder
+ * ============================================================================ */
+
+static FILE* g_record_file = NULL;
+static unsigned char* g_record_buffer = NULL;
+static size_t g_record_capacity = 0;
+
+bool cel_clay_recording(void) {
+    return g_record_file != NULL;
+}
+
+/* End of the last complete frame of an existing recording, walked the way
+ * replay_index does; anything after it is a frame cut short by a crash */
+static long record_complete_end(FILE* file, long size) {
+    long offset = (long)sizeof(_CelClayRecordHeader);
+    _CelClayRecordFrame frame;
+    while (offset + (long)sizeof(frame) <= size &&
+           fseek(file, offset, SEEK_SET) == 0 &&
+           fread(&frame, sizeof(frame), 1, file) == 1) {
+        if (frame.magic != CEL_CLAY_RECORD_FRAME_MAGIC ||
+            frame.size < sizeof(_CelClayRecordFrame) ||
+            (long)frame.size > size - offset) {
+            break;
+        }
+        offset += (long)frame.size;
+    }
+    return offset < size ? offset : size;
+}
+
+bool cel_clay_record_start(const char* path) {
+    cel_clay_record_stop();
+
+    /* An existing file must be a recording of this version */
+    long existing_size = 0;
+    long complete = 0;
+    FILE* existing = fopen(path, "rb");
+    if (existing) {
+        _CelClayRecordHeader header;
+        size_t read = fread(&header, 1, sizeof(header), existing);
+        if (read > 0 &&
+            (read < sizeof(header) ||
+             memcmp(header.magic, g_record_magic, sizeof(g_record_magic)) != 0 ||
+             header.version != CEL_CLAY_RECORD_VERSION ||
+             header.command_size != sizeof(_CelClayRecordCommand))) {
+            fprintf(stderr, "[cels-clay] record: '%s' is not a compatible recording\n", path);
+            fclose(existing);
+            return false;
+        }
+        if (read > 0) {
+            fseek(existing, 0, SEEK_END);
+            existing_size = ftell(existing);
+            complete = record_complete_end(existing, existing_size);
+        }
+        fclose(existing);
+    }
+
+    FILE* file = fopen(path, "ab");
+    if (!file) {
+        fprintf(stderr, "[cels-clay] record: cannot open '%s'\n", path);
+        return false;
+    }
+
+    /* Frames appended after a torn one would never be replayed: cut it */
+    if (complete < existing_size) {
+#ifdef CEL_CLAY_HAS_MMAP
+        if (fflush(file) != 0 || ftruncate(fileno(file), (off_t)complete) != 0) {
+            fprintf(stderr, "[cels-clay] record: cannot truncate '%s'\n", path);
+            fclose(file);
+            return false;
+        }
+        fprintf(stderr, "[cels-clay] record: dropped %ld bytes of an incomplete frame from '%s'\n",
+                existing_size - complete, path);
+#else
+        fprintf(stderr, "[cels-clay] record: '%s' ends in an incomplete frame\n", path);
+        fclose(file);
+        return false;
+#endif
+    }
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0) {
+        _CelClayRecordHeader header = {
+            .version = CEL_CLAY_RECORD_VERSION,
+            .command_size = (uint32_t)sizeof(_CelClayRecordCommand)
+        };
+        memcpy(header.magic, g_record_magic, sizeof(g_record_magic));
+        if (fwrite(&header, sizeof(header), 1, file) != 1) {
+            fprintf(stderr, "[cels-clay] record: cannot write '%s'\n", path);
+            fclose(file);
+            return false;
+        }
+    }
+    g_record_file = file;
+    return true;
+}
+
+void cel_clay_record_stop(void) {
+    if (g_record_file) {
+        fclose(g_record_file);
+        g_record_file = NULL;
+    }
+    free(g_record_buffer);
+    g_record_buffer = NULL;
+    g_record_capacity = 0;
+}
+
+static void record_command(_CelClayRecordCommand* out, const Clay_RenderCommand* command,
+                           uint32_t text_offset) {
+    const Clay_RenderData* data = &command->renderData;
+    *out = (_CelClayRecordCommand){
+        .x = command->boundingBox.x,
+        .y = command->boundingBox.y,
+        .width = command->boundingBox.width,
+        .height = command->boundingBox.height,
+        .id = command->id,
+        .z_index = command->zIndex,
+        .type = (uint8_t)command->commandType,
+        .user_data = (uint64_t)(uintptr_t)command->userData
+    };
+
+    Clay_Color color = {0};
+    Clay_CornerRadius radius = {0};
+    switch (command->commandType) {
+        case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+            color = data->rectangle.backgroundColor;
+            radius = data->rectangle.cornerRadius;
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_BORDER:
+            color = data->border.color;
+            radius = data->border.cornerRadius;
+            out->u16[0] = data->border.width.left;
+            out->u16[1] = data->border.width.right;
+            out->u16[2] = data->border.width.top;
+            out->u16[3] = data->border.width.bottom;
+            out->u16[4] = data->border.width.betweenChildren;
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_TEXT:
+            color = data->text.textColor;
+            out->u16[0] = data->text.fontId;
+            out->u16[1] = data->text.fontSize;
+            out->u16[2] = data->text.letterSpacing;
+            out->u16[3] = data->text.lineHeight;
+            out->text_offset = text_offset;
+            out->text_length = (uint32_t)data->text.stringContents.length;
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+            color = data->image.backgroundColor;
+            radius = data->image.cornerRadius;
+            out->pointer = (uint64_t)(uintptr_t)data->image.imageData;
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_CUSTOM:
+            color = data->custom.backgroundColor;
+            radius = data->custom.cornerRadius;
+            out->pointer = (uint64_t)(uintptr_t)data->custom.customData;
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+            out->clip = (uint8_t)((data->clip.horizontal ? 1u : 0u) |
+                                  (data->clip.vertical ? 2u : 0u));
+            break;
+        default:
+            break;
+    }
+    out->color[0] = color.r;
+    out->color[1] = color.g;
+    out->color[2] = color.b;
+    out->color[3] = color.a;
+    out->radius[0] = radius.topLeft;
+    out->radius[1] = radius.topRight;
+    out->radius[2] = radius.bottomLeft;
+    out->radius[3] = radius.bottomRight;
+}
+
+static size_t surface_text_size(Clay_RenderCommandArray commands) {
+    size_t size = 0;
+    for (int32_t c = 0; c < commands.length; c++) {
+        const Clay_RenderCommand* command = &commands.internalArray[c];
+        if (command->commandType == CLAY_RENDER_COMMAND_TYPE_TEXT) {
+            size += (size_t)command->renderData.text.stringContents.length;
+        }
+    }
+    return pad8(size);
+}
+
+void _cel_clay_record_frame(const ClayRenderableData* surfaces, int32_t count) {
+    if (!g_record_file) return;
+
+    size_t size = sizeof(_CelClayRecordFrame);
+    for (int32_t i = 0; i < count; i++) {
+        Clay_RenderCommandArray commands = surfaces[i].render_commands;
+        size += sizeof(_CelClayRecordSurface) +
+                sizeof(_CelClayRecordCommand) * (size_t)commands.length +
+                surface_text_size(commands);
+    }
+    if (size > UINT32_MAX) {
+        fprintf(stderr, "[cels-clay] record: frame %u too large, skipped\n",
+                count > 0 ? surfaces[0].frame_number : 0u);
+        return;
+    }
+    if (size > g_record_capacity) {
+        unsigned char* buffer = (unsigned char*)realloc(g_record_buffer, size);
+        if (!buffer) {
+            fprintf(stderr, "[cels-clay] record: out of memory, frame skipped\n");
+            return;
+        }
+        g_record_buffer = buffer;
+        g_record_capacity = size;
+    }
+
+    unsigned char* cursor = g_record_buffer;
+    _CelClayRecordFrame* frame = (_CelClayRecordFrame*)cursor;
+    *frame = (_CelClayRecordFrame){
+        .magic = CEL_CLAY_RECORD_FRAME_MAGIC,
+        .size = (uint32_t)size,
+        .frame_number = count > 0 ? surfaces[0].frame_number : 0,
+        .delta_time = count > 0 ? surfaces[0].delta_time : 0.0f,
+        .surface_count = (uint32_t)count
+    };
+    cursor += sizeof(_CelClayRecordFrame);
+
+    for (int32_t i = 0; i < count; i++) {
+        Clay_RenderCommandArray commands = surfaces[i].render_commands;
+        size_t text_size = surface_text_size(commands);
+        *(_CelClayRecordSurface*)cursor = (_CelClayRecordSurface){
+            .surface = (uint64_t)surfaces[i].surface,
+            .layout_width = surfaces[i].layout_width,
+            .layout_height = surfaces[i].layout_height,
+            .command_count = (uint32_t)commands.length,
+            .text_size = (uint32_t)text_size
+        };
+        cursor += sizeof(_CelClayRecordSurface);
+
+        _CelClayRecordCommand* records = (_CelClayRecordCommand*)cursor;
+        unsigned char* text = cursor + sizeof(_CelClayRecordCommand) * (size_t)commands.length;
+        uint32_t text_offset = 0;
+        for (int32_t c = 0; c < commands.length; c++) {
+            const Clay_RenderCommand* command = &commands.internalArray[c];
+            record_command(&records[c], command, text_offset);
+            if (command->commandType == CLAY_RENDER_COMMAND_TYPE_TEXT &&
+                command->renderData.text.stringContents.length > 0) {
+                memcpy(text + text_offset, command->renderData.text.stringContents.chars,
+                       (size_t)command->renderData.text.stringContents.length);
+                text_offset += (uint32_t)command->renderData.text.stringContents.length;
+            }
+        }
+        memset(text + text_offset, 0, text_size - text_offset);
+        cursor = text + text_size;
+    }
+
+    if (fwrite(g_record_buffer, size, 1, g_record_file) != 1) {
+        fprintf(stderr, "[cels-clay] record: write failed, recording stopped\n");
+        cel_clay_record_stop();
+    }
+}
+
+/* ============================================================================
+ * Replayer
+ * ============================================================================ */
+
+struct ClayReplay {
+    const unsigned char* data;
+    size_t size;
+    bool mapped;                /* data is an mmap of the file */
+    uint32_t flags;
+    size_t* frames;             /* Offset of each complete frame record */
+    int32_t frame_count;
+    ClayRenderSnapshotSurface* surfaces;
+    int32_t surface_capacity;
+    Clay_RenderCommand* commands;
+    int32_t command_capacity;
+};
+
+static bool replay_load(ClayReplay* replay, const char* path) {
+#ifdef CEL_CLAY_HAS_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* memory = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (memory != MAP_FAILED) {
+        replay->data = (const unsigned char*)memory;
+        replay->size = (size_t)st.st_size;
+        replay->mapped = true;
+        return true;
+    }
+    fprintf(stderr, "[cels-clay] replay: mmap of '%s' failed, reading it\n", path);
+#endif
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = size > 0 ? (unsigned char*)malloc((size_t)size) : NULL;
+    if (!data || fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    replay->data = data;
+    replay->size = (size_t)size;
+    return true;
+}
+
+static void replay_unload(ClayReplay* replay) {
+    if (!replay->data) return;
+#ifdef CEL_CLAY_HAS_MMAP
+    if (replay->mapped) {
+        munmap((void*)replay->data, replay->size);
+        replay->data = NULL;
+        return;
+    }
+#endif
+    free((void*)replay->data);
+    replay->data = NULL;
+}
+
+/* Index complete frames; a truncated or corrupt tail ends the index */
+static bool replay_index(ClayReplay* replay) {
+    int32_t capacity = 0;
+    size_t offset = sizeof(_CelClayRecordHeader);
+    while (offset + sizeof(_CelClayRecordFrame) <= replay->size) {
+        const _CelClayRecordFrame* frame = (const _CelClayRecordFrame*)(replay->data + offset);
+        if (frame->magic != CEL_CLAY_RECORD_FRAME_MAGIC ||
+            frame->size < sizeof(_CelClayRecordFrame) ||
+            frame->size > replay->size - offset) {
+            break;
+        }
+        if (replay->frame_count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            size_t* frames = (size_t*)realloc(replay->frames, sizeof(size_t) * (size_t)capacity);
+            if (!frames) return false;
+            replay->frames = frames;
+        }
+        replay->frames[replay->frame_count++] = offset;
+        offset += frame->size;
+    }
+    if (offset != replay->size) {
+        fprintf(stderr, "[cels-clay] replay: ignoring %zu trailing bytes\n",
+                replay->size - offset);
+    }
+    return true;
+}
+
+ClayReplay* cel_clay_replay_open(const char* path, uint32_t flags) {
+    ClayReplay* replay = (ClayReplay*)calloc(1, sizeof(ClayReplay));
+    if (!replay) return NULL;
+    replay->flags = flags;
+
+    if (!replay_load(replay, path)) {
+        fprintf(stderr, "[cels-clay] replay: cannot read '%s'\n", path);
+        free(replay);
+        return NULL;
+    }
+
+    const _CelClayRecordHeader* header = (const _CelClayRecordHeader*)replay->data;
+    if (replay->size < sizeof(_CelClayRecordHeader) ||
+        memcmp(header->magic, g_record_magic, sizeof(g_record_magic)) != 0 ||
+        header->version != CEL_CLAY_RECORD_VERSION ||
+        header->command_size != sizeof(_CelClayRecordCommand)) {
+        fprintf(stderr, "[cels-clay] replay: '%s' is not a compatible recording\n", path);
+        cel_clay_replay_close(replay);
+        return NULL;
+    }
+    if (!replay_index(replay)) {
+        fprintf(stderr, "[cels-clay] replay: out of memory indexing '%s'\n", path);
+        cel_clay_replay_close(replay);
+        return NULL;
+    }
+    return replay;
+}
+
+int32_t cel_clay_replay_frame_count(const ClayReplay* replay) {
+    return replay ? replay->frame_count : 0;
+}
+
+static Clay_RenderCommand replay_command(const ClayReplay* replay,
+                                         const _CelClayRecordCommand* in,
+                                         const char* text, uint32_t text_size) {
+    bool pointers = (replay->flags & CEL_CLAY_REPLAY_KEEP_POINTERS) != 0;
+    Clay_RenderCommand command = {
+        .boundingBox = { in->x, in->y, in->width, in->height },
+        .userData = pointers ? (void*)(uintptr_t)in->user_data : NULL,
+        .id = in->id,
+        .zIndex = in->z_index,
+        .commandType = (Clay_RenderCommandType)in->type
+    };
+    Clay_Color color = { in->color[0], in->color[1], in->color[2], in->color[3] };
+    Clay_CornerRadius radius = { in->radius[0], in->radius[1], in->radius[2], in->radius[3] };
+    void* pointer = pointers ? (void*)(uintptr_t)in->pointer : NULL;
+
+    switch (command.commandType) {
+        case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+            command.renderData.rectangle.backgroundColor = color;
+            command.renderData.rectangle.cornerRadius = radius;
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_BORDER:
+            command.renderData.border.color = color;
+            command.renderData.border.cornerRadius = radius;
+            command.renderData.border.width.left = in->u16[0];
+            command.renderData.border.width.right = in->u16[1];
+            command.renderData.border.width.top = in->u16[2];
+            command.renderData.border.width.bottom = in->u16[3];
+            command.renderData.border.width.betweenChildren = in->u16[4];
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+            uint32_t length = in->text_length;
+            if (in->text_offset > text_size || length > text_size - in->text_offset) {
+                length = 0;  /* Corrupt record: draw nothing */
+            }
+            command.renderData.text.stringContents.length = (int32_t)length;
+            command.renderData.text.stringContents.chars = length ? text + in->text_offset : text;
+            command.renderData.text.stringContents.baseChars =
+                command.renderData.text.stringContents.chars;
+            command.renderData.text.textColor = color;
+            command.renderData.text.fontId = in->u16[0];
+            command.renderData.text.fontSize = in->u16[1];
+            command.renderData.text.letterSpacing = in->u16[2];
+            command.renderData.text.lineHeight = in->u16[3];
+            break;
+        }
+        case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+            command.renderData.image.backgroundColor = color;
+            command.renderData.image.cornerRadius = radius;
+            command.renderData.image.imageData = pointer;
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_CUSTOM:
+            command.renderData.custom.backgroundColor = color;
+            command.renderData.custom.cornerRadius = radius;
+            command.renderData.custom.customData = pointer;
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+            command.renderData.clip.horizontal = (in->clip & 1u) != 0;
+            command.renderData.clip.vertical = (in->clip & 2u) != 0;
+            break;
+        default:
+            break;
+    }
+    return command;
+}
+
+bool cel_clay_replay_frame(ClayReplay* replay, int32_t index, ClayRenderSnapshot* out) {
+    if (!replay || index < 0 || index >= replay->frame_count) return false;
+
+    const unsigned char* start = replay->data + replay->frames[index];
+    const _CelClayRecordFrame* frame = (const _CelClayRecordFrame*)start;
+    const unsigned char* end = start + frame->size;
+
+    /* Pass 1: validate sections and count commands */
+    int32_t surface_count = (int32_t)frame->surface_count;
+    int32_t total = 0;
+    const unsigned char* cursor = start + sizeof(_CelClayRecordFrame);
+    for (int32_t s = 0; s < surface_count; s++) {
+        if ((size_t)(end - cursor) < sizeof(_CelClayRecordSurface)) return false;
+        const _CelClayRecordSurface* surface = (const _CelClayRecordSurface*)cursor;
+        size_t body = sizeof(_CelClayRecordCommand) * (size_t)surface->command_count +
+                      surface->text_size;
+        cursor += sizeof(_CelClayRecordSurface);
+        if ((size_t)(end - cursor) < body || surface->command_count > INT32_MAX - (uint32_t)total) {
+            fprintf(stderr, "[cels-clay] replay: frame %d is corrupt\n", index);
+            return false;
+        }
+        total += (int32_t)surface->command_count;
+        cursor += body;
+    }
+
+    if (surface_count > replay->surface_capacity) {
+        ClayRenderSnapshotSurface* surfaces = (ClayRenderSnapshotSurface*)realloc(
+            replay->surfaces, sizeof(ClayRenderSnapshotSurface) * (size_t)surface_count);
+        if (!surfaces) return false;
+        replay->surfaces = surfaces;
+        replay->surface_capacity = surface_count;
+    }
+    if (total > replay->command_capacity) {
+        Clay_RenderCommand* commands = (Clay_RenderCommand*)realloc(
+            replay->commands, sizeof(Clay_RenderCommand) * (size_t)total);
+        if (!commands) return false;
+        replay->commands = commands;
+        replay->command_capacity = total;
+    }
+
+    /* Pass 2: decode */
+    int32_t offset = 0;
+    cursor = start + sizeof(_CelClayRecordFrame);
+    for (int32_t s = 0; s < surface_count; s++) {
+        const _CelClayRecordSurface* surface = (const _CelClayRecordSurface*)cursor;
+        const _CelClayRecordCommand* records =
+            (const _CelClayRecordCommand*)(cursor + sizeof(_CelClayRecordSurface));
+        int32_t count = (int32_t)surface->command_count;
+        const char* text = (const char*)(records + count);
+
+        Clay_RenderCommand* commands = replay->commands + offset;
+        for (int32_t c = 0; c < count; c++) {
+            commands[c] = replay_command(replay, &records[c], text, surface->text_size);
+        }
+        replay->surfaces[s] = (ClayRenderSnapshotSurface){
+            .surface = (cels_entity_t)surface->surface,
+            .render_commands = { .capacity = count, .length = count,
+                                 .internalArray = commands },
+            .layout_width = surface->layout_width,
+            .layout_height = surface->layout_height
+        };
+        offset += count;
+        cursor = (const unsigned char*)text + surface->text_size;
+    }
+
+    *out = (ClayRenderSnapshot){
+        .frame_number = frame->frame_number,
+        .delta_time = frame->delta_time,
+        .surface_count = surface_count,
+        .surfaces = replay->surfaces
+    };
+    return true;
+}
+
+void cel_clay_replay_close(ClayReplay* replay) {
+    if (!replay) return;
+    replay_unload(replay);
+    free(replay->frames);
+    free(replay->surfaces);
+    free(replay->commands);
+    free(replay);
+}
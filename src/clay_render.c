@@ -20,8 +20,16 @@
  * Implements the render bridge subsystem:
  * - ClayRenderableData component registration
  * - Singleton ClayRenderTarget entity creation
- * - Render dispatch system that updates the singleton each frame
+ * - Render dispatch system that publishes one ClayRenderableData per
+ *   surface each frame and mirrors the first surface onto the singleton
+ * - Culling of commands outside the surface or the active scissor clip
+ * - Content hash and render diff (added/removed/moved/restyled commands
+ *   and damage rectangles) per surface
  * - Public getter API for advanced users
+ * - Optional render snapshots: self-contained copies of each frame's
+ *   commands for rendering on another thread
+ * - Hooks for recording published frames and publishing replayed ones
+ *   (clay_record.c)
  *
  * Phase ordering:
  *   PreStore  -> ClayLayoutSystem (BeginLayout -> tree walk -> EndLayout)
@@ -32,12 +40,19 @@
  */
 
 #include "cels-clay/clay_render.h"
+#include "cels-clay/clay_engine.h"
 #include "cels-clay/clay_layout.h"
+#include "cels-clay/clay_record.h"
+#include "cels-clay/clay_profile.h"
+#include "cels-clay/clay_trace.h"
 #include "clay.h"
 #include <cels/cels.h>
 #include <flecs.h>
+#include <stdatomic.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 
 /* ============================================================================
  * Component Registration
@@ -59,32 +74,844 @@ void ClayRenderableData_register(void) {
 static cels_entity_t g_render_target = 0;
 static uint32_t g_frame_number = 0;
 
+/* Frame to publish instead of the layout output (cel_clay_render_publish_snapshot) */
+static const ClayRenderSnapshot* g_publish_snapshot = NULL;
+static bool g_published_last = false;     /* Last dispatch published a snapshot */
+
+/* Per-surface renderable data, rebuilt by every dispatch */
+static ClayRenderableData* g_surface_data = NULL;
+static int32_t g_surface_data_count = 0;
+static int32_t g_surface_data_capacity = 0;
+
+/* ============================================================================
+ * Content Hash
+ * ============================================================================
+ *
+ * A 64-bit multiply-rotate hash fed 8 bytes at a time. Commands are hashed
+ * field by field rather than as raw structs: render data unions and slices
+ * contain padding, and text is hashed by its bytes, not its (frame arena)
+ * pointer. Non-text commands are a few dozen bytes each, so hashing a
+ * surface costs about as much as copying its command array.
+ *
+ * Each command gets a style hash (everything but its bounding box), which
+ * the diff compares per element; the surface's content hash folds in the
+ * style hashes and bounding boxes in command order.
+ */
+
+#define CEL_CLAY_HASH_SEED 0x243F6A8885A308D3ull
+
+static inline uint64_t hash_mix(uint64_t h, uint64_t v) {
+    h ^= v * 0x9E3779B97F4A7C15ull;
+    h = (h << 27) | (h >> 37);
+    return h * 0xC2B2AE3D27D4EB4Full + 0x165667B19E3779F9ull;
+}
+
+static uint64_t hash_bytes(uint64_t h, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    while (size >= 8) {
+        uint64_t v;
+        memcpy(&v, bytes, 8);
+        h = hash_mix(h, v);
+        bytes += 8;
+        size -= 8;
+    }
+    if (size > 0) {
+        uint64_t v = 0;
+        memcpy(&v, bytes, size);
+        h = hash_mix(h, v ^ ((uint64_t)size << 56));
+    }
+    return h;
+}
+
+static uint64_t hash_command_style(const Clay_RenderCommand* command) {
+    const Clay_RenderData* data = &command->renderData;
+    uint64_t h = hash_mix(CEL_CLAY_HASH_SEED,
+                          ((uint64_t)command->id << 32) |
+                          ((uint64_t)(uint16_t)command->zIndex << 8) |
+                          (uint64_t)command->commandType);
+    h = hash_mix(h, (uint64_t)(uintptr_t)command->userData);
+
+    switch (command->commandType) {
+        case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+            h = hash_bytes(h, &data->rectangle.backgroundColor, sizeof(Clay_Color));
+            h = hash_bytes(h, &data->rectangle.cornerRadius, sizeof(Clay_CornerRadius));
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_BORDER:
+            h = hash_bytes(h, &data->border.color, sizeof(Clay_Color));
+            h = hash_bytes(h, &data->border.cornerRadius, sizeof(Clay_CornerRadius));
+            h = hash_mix(h, ((uint64_t)data->border.width.left << 48) |
+                            ((uint64_t)data->border.width.right << 32) |
+                            ((uint64_t)data->border.width.top << 16) |
+                            (uint64_t)data->border.width.bottom);
+            h = hash_mix(h, (uint64_t)data->border.width.betweenChildren);
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_TEXT:
+            h = hash_bytes(h, &data->text.textColor, sizeof(Clay_Color));
+            h = hash_mix(h, ((uint64_t)data->text.fontId << 48) |
+                            ((uint64_t)data->text.fontSize << 32) |
+                            ((uint64_t)data->text.letterSpacing << 16) |
+                            (uint64_t)data->text.lineHeight);
+            h = hash_mix(h, (uint64_t)(uint32_t)data->text.stringContents.length);
+            if (data->text.stringContents.length > 0) {
+                h = hash_bytes(h, data->text.stringContents.chars,
+                               (size_t)data->text.stringContents.length);
+            }
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+            h = hash_bytes(h, &data->image.backgroundColor, sizeof(Clay_Color));
+            h = hash_bytes(h, &data->image.cornerRadius, sizeof(Clay_CornerRadius));
+            h = hash_mix(h, (uint64_t)(uintptr_t)data->image.imageData);
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_CUSTOM:
+            h = hash_bytes(h, &data->custom.backgroundColor, sizeof(Clay_Color));
+            h = hash_bytes(h, &data->custom.cornerRadius, sizeof(Clay_CornerRadius));
+            h = hash_mix(h, (uint64_t)(uintptr_t)data->custom.customData);
+            break;
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+            h = hash_mix(h, ((uint64_t)data->clip.horizontal << 1) |
+                            (uint64_t)data->clip.vertical);
+            break;
+        default:
+            break;
+    }
+    return h;
+}
+
+/* ============================================================================
+ * Surface Tracks
+ * ============================================================================
+ *
+ * One track per live surface, matched by entity across dispatches. A track
+ * keeps the command keys of the surface's last published frame -- (id,
+ * command type), style hash and bounding box per command -- which is all
+ * the diff needs: the commands themselves do not outlive the next layout
+ * pass. Keys are double-buffered: the frame being keyed is written next to
+ * the previous one and becomes current once diffed.
+ *
+ * A track also owns the surface's culled command list, which is what
+ * gets published, keyed and diffed.
+ *
+ * Tracks are allocated individually: ClayRenderableData.diff and
+ * render_commands point into them, so they must not move when the track
+ * list changes.
+ */
+
+#define CEL_CLAY_MAX_DAMAGE_RECTS 8
+
+typedef struct {
+    uint64_t key;               /* id << 8 | command type */
+    uint64_t style;             /* hash_command_style */
+    Clay_BoundingBox bounds;
+    int32_t matched;            /* Index matched in the next frame, -1 = none */
+} _CelClayCommandKey;
+
+typedef struct {
+    ClayRenderChange* items;
+    int32_t count;
+    int32_t capacity;
+} _CelClayChangeList;
+
+typedef struct {
+    cels_entity_t surface;
+    int32_t position;               /* Surface index in the last dispatch */
+    bool seen;                      /* Published by the current dispatch */
+    bool primed;                    /* keys[keys_current] holds a frame */
+    uint32_t revision;              /* _CelClaySurfaceOutput.revision keyed */
+    uint64_t hash;
+    Clay_Dimensions dimensions;
+    _CelClayCommandKey* keys[2];
+    int32_t key_count[2];
+    int32_t key_capacity[2];
+    int32_t keys_current;
+    int32_t* slots;                 /* Key -> previous frame index */
+    int32_t slot_capacity;          /* Power of two */
+    _CelClayChangeList changes[4];  /* Indexed by ClayRenderChangeKind */
+    Clay_BoundingBox damage[CEL_CLAY_MAX_DAMAGE_RECTS];
+    ClayRenderDiff diff;
+    Clay_RenderCommand* culled;     /* Culled copy of the commands */
+    int32_t culled_capacity;
+    Clay_RenderCommandArray commands;   /* Published: culled, or the source */
+    int32_t culled_commands;
+    int32_t culled_ranges;
+} _CelClaySurfaceTrack;
+
+static _CelClaySurfaceTrack** g_tracks = NULL;
+static int32_t g_track_count = 0;
+static int32_t g_track_capacity = 0;
+
+static _CelClaySurfaceTrack* track_for(cels_entity_t surface, int32_t index) {
+    if (index < g_track_count && g_tracks[index]->surface == surface) {
+        return g_tracks[index];
+    }
+    for (int32_t i = 0; i < g_track_count; i++) {
+        if (g_tracks[i]->surface == surface) return g_tracks[i];
+    }
+
+    if (g_track_count == g_track_capacity) {
+        int32_t capacity = g_track_capacity ? g_track_capacity * 2 : 4;
+        _CelClaySurfaceTrack** tracks = (_CelClaySurfaceTrack**)realloc(
+            g_tracks, sizeof(_CelClaySurfaceTrack*) * (size_t)capacity);
+        if (!tracks) return NULL;
+        g_tracks = tracks;
+        g_track_capacity = capacity;
+    }
+    _CelClaySurfaceTrack* track = (_CelClaySurfaceTrack*)calloc(1, sizeof(_CelClaySurfaceTrack));
+    if (!track) return NULL;
+    track->surface = surface;
+    track->position = -1;
+    g_tracks[g_track_count++] = track;
+    return track;
+}
+
+static void track_free(_CelClaySurfaceTrack* track) {
+    free(track->keys[0]);
+    free(track->keys[1]);
+    free(track->slots);
+    for (int32_t k = 0; k < 4; k++) free(track->changes[k].items);
+    free(track->culled);
+    free(track);
+}
+
+/* ============================================================================
+ * Culling
+ * ============================================================================
+ *
+ * Walks a surface's commands with a stack of clip rectangles, starting
+ * from the surface's layout area: SCISSOR_START pushes its intersection
+ * with the current clip, SCISSOR_END pops. A drawing command whose
+ * bounding box does not touch the current clip is dropped. A scissor
+ * range whose clip is empty is dropped whole, START to matching END.
+ * Boxes that only touch the clip edge are kept: the cell renderers round
+ * edges outward.
+ *
+ * Scissor nesting past CEL_CLAY_MAX_CULL_DEPTH keeps the deepest tracked
+ * clip (culls less, never more).
+ */
+
+#define CEL_CLAY_MAX_CULL_DEPTH 64
+
+static inline bool box_touches(Clay_BoundingBox a, Clay_BoundingBox b);
+
+static Clay_BoundingBox box_intersect(Clay_BoundingBox a, Clay_BoundingBox b) {
+    float x0 = a.x > b.x ? a.x : b.x;
+    float y0 = a.y > b.y ? a.y : b.y;
+    float x1 = a.x + a.width < b.x + b.width ? a.x + a.width : b.x + b.width;
+    float y1 = a.y + a.height < b.y + b.height ? a.y + a.height : b.y + b.height;
+    return (Clay_BoundingBox){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+/* Cull `commands` into the track's list and publish it. Out of memory:
+ * publish the commands unculled. */
+static void cull_commands(_CelClaySurfaceTrack* track, Clay_RenderCommandArray commands,
+                          Clay_Dimensions dimensions) {
+    track->culled_commands = 0;
+    track->culled_ranges = 0;
+    track->commands = commands;
+
+    if (commands.length > track->culled_capacity) {
+        Clay_RenderCommand* culled = (Clay_RenderCommand*)realloc(
+            track->culled, sizeof(Clay_RenderCommand) * (size_t)commands.length);
+        if (!culled) {
+            fprintf(stderr, "[cels-clay] render bridge: out of memory culling %d commands\n",
+                    commands.length);
+            return;
+        }
+        track->culled = culled;
+        track->culled_capacity = commands.length;
+    }
+
+    Clay_BoundingBox clips[CEL_CLAY_MAX_CULL_DEPTH];
+    int32_t depth = 0;
+    Clay_BoundingBox clip = { 0, 0, dimensions.width, dimensions.height };
+    int32_t kept = 0;
+
+    for (int32_t i = 0; i < commands.length; i++) {
+        const Clay_RenderCommand* command = &commands.internalArray[i];
+
+        switch (command->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
+                Clay_BoundingBox inner = box_intersect(clip, command->boundingBox);
+                if (inner.width <= 0 || inner.height <= 0) {
+                    /* Nothing in the range can show: skip to its END */
+                    int32_t nested = 0;
+                    int32_t j = i + 1;
+                    for (; j < commands.length; j++) {
+                        Clay_RenderCommandType type = commands.internalArray[j].commandType;
+                        if (type == CLAY_RENDER_COMMAND_TYPE_SCISSOR_START) nested++;
+                        if (type == CLAY_RENDER_COMMAND_TYPE_SCISSOR_END && nested-- == 0) break;
+                    }
+                    if (j == commands.length) j--;  /* Unterminated: to the end */
+                    track->culled_commands += j - i + 1;
+                    track->culled_ranges++;
+                    i = j;
+                    continue;
+                }
+                if (depth < CEL_CLAY_MAX_CULL_DEPTH) {
+                    clips[depth] = clip;
+                    clip = inner;
+                }
+                depth++;
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+                if (depth > 0) {
+                    depth--;
+                    if (depth < CEL_CLAY_MAX_CULL_DEPTH) clip = clips[depth];
+                }
+                break;
+            default:
+                if (!box_touches(command->boundingBox, clip)) {
+                    track->culled_commands++;
+                    continue;
+                }
+                break;
+        }
+        track->culled[kept++] = *command;
+    }
+
+    track->commands = (Clay_RenderCommandArray){
+        .capacity = kept,
+        .length = kept,
+        .internalArray = track->culled
+    };
+}
+
+/* ============================================================================
+ * Render Diff
+ * ============================================================================
+ *
+ * Matches a surface's commands to its previous frame by (element id,
+ * command type). A matched command whose bounding box changed is moved;
+ * one whose style hash changed -- or that now draws before a command it
+ * used to follow -- is restyled. Unmatched commands are added or removed.
+ * Each change damages its old and new bounds; damage rectangles that
+ * touch are merged, and past CEL_CLAY_MAX_DAMAGE_RECTS the new rectangle
+ * is merged into the one it grows least.
+ *
+ * A surface without a usable previous frame (new surface, resize, surface
+ * set changed, out of memory) gets a full diff: its whole layout area.
+ */
+
+static inline float box_area(Clay_BoundingBox box) {
+    return box.width * box.height;
+}
+
+static inline bool box_equal(Clay_BoundingBox a, Clay_BoundingBox b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static inline bool box_touches(Clay_BoundingBox a, Clay_BoundingBox b) {
+    return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+           a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+static Clay_BoundingBox box_union(Clay_BoundingBox a, Clay_BoundingBox b) {
+    float x0 = a.x < b.x ? a.x : b.x;
+    float y0 = a.y < b.y ? a.y : b.y;
+    float x1 = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+    float y1 = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+    return (Clay_BoundingBox){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+static void damage_add(_CelClaySurfaceTrack* track, Clay_BoundingBox box) {
+    if (box.width <= 0 || box.height <= 0) return;
+    ClayRenderDiff* diff = &track->diff;
+    diff->damage_bounds = diff->damage_count > 0
+        ? box_union(diff->damage_bounds, box) : box;
+
+    for (;;) {
+        int32_t merge = -1;
+        for (int32_t i = 0; i < diff->damage_count; i++) {
+            if (box_touches(track->damage[i], box)) {
+                merge = i;
+                break;
+            }
+        }
+        if (merge < 0 && diff->damage_count == CEL_CLAY_MAX_DAMAGE_RECTS) {
+            float best = 0.0f;
+            for (int32_t i = 0; i < diff->damage_count; i++) {
+                float growth = box_area(box_union(track->damage[i], box)) -
+                               box_area(track->damage[i]);
+                if (merge < 0 || growth < best) {
+                    merge = i;
+                    best = growth;
+                }
+            }
+        }
+        if (merge < 0) break;
+        /* The merged rectangle may now touch others: take it out, retry */
+        box = box_union(track->damage[merge], box);
+        track->damage[merge] = track->damage[--diff->damage_count];
+    }
+    track->damage[diff->damage_count++] = box;
+}
+
+static void diff_reset(_CelClaySurfaceTrack* track) {
+    for (int32_t k = 0; k < 4; k++) track->changes[k].count = 0;
+    track->diff = (ClayRenderDiff){ .damage = track->damage };
+}
+
+static void diff_full(_CelClaySurfaceTrack* track) {
+    diff_reset(track);
+    track->diff.full = true;
+    damage_add(track, (Clay_BoundingBox){ 0, 0, track->dimensions.width,
+                                          track->dimensions.height });
+}
+
+static bool diff_push(_CelClaySurfaceTrack* track, ClayRenderChangeKind kind,
+                      const _CelClayCommandKey* key, int32_t index,
+                      Clay_BoundingBox previous_bounds) {
+    _CelClayChangeList* list = &track->changes[kind];
+    if (list->count == list->capacity) {
+        int32_t capacity = list->capacity ? list->capacity * 2 : 16;
+        ClayRenderChange* items = (ClayRenderChange*)realloc(
+            list->items, sizeof(ClayRenderChange) * (size_t)capacity);
+        if (!items) return false;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = (ClayRenderChange){
+        .id = (uint32_t)(key->key >> 8),
+        .command_type = (Clay_RenderCommandType)(key->key & 0xFF),
+        .index = index,
+        .bounds = key->bounds,
+        .previous_bounds = previous_bounds
+    };
+    damage_add(track, key->bounds);
+    if (kind == CLAY_RENDER_CHANGE_MOVED) damage_add(track, previous_bounds);
+    return true;
+}
+
+static int32_t* diff_slot(_CelClaySurfaceTrack* track, const _CelClayCommandKey* keys,
+                          uint64_t key) {
+    uint32_t mask = (uint32_t)track->slot_capacity - 1;
+    uint32_t slot = (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    while (track->slots[slot] >= 0 && keys[track->slots[slot]].key != key) {
+        slot = (slot + 1) & mask;
+    }
+    return &track->slots[slot];
+}
+
+/* Diff `current` against `previous`; false if out of memory */
+static bool diff_compute(_CelClaySurfaceTrack* track,
+                         _CelClayCommandKey* previous, int32_t previous_count,
+                         const _CelClayCommandKey* current, int32_t current_count) {
+    int32_t capacity = 16;
+    while (capacity < previous_count * 2) capacity *= 2;
+    if (capacity > track->slot_capacity) {
+        int32_t* slots = (int32_t*)realloc(track->slots, sizeof(int32_t) * (size_t)capacity);
+        if (!slots) return false;
+        track->slots = slots;
+        track->slot_capacity = capacity;
+    }
+    memset(track->slots, 0xFF, sizeof(int32_t) * (size_t)track->slot_capacity);
+    for (int32_t p = 0; p < previous_count; p++) {
+        int32_t* slot = diff_slot(track, previous, previous[p].key);
+        if (*slot < 0) *slot = p;  /* Duplicate keys after the first stay unmatched */
+    }
+
+    int32_t last_matched = -1;
+    for (int32_t c = 0; c < current_count; c++) {
+        const _CelClayCommandKey* key = &current[c];
+        int32_t p = *diff_slot(track, previous, key->key);
+        bool ok = true;
+        if (p < 0 || previous[p].matched >= 0) {
+            ok = diff_push(track, CLAY_RENDER_CHANGE_ADDED, key, c, key->bounds);
+        } else {
+            previous[p].matched = c;
+            if (!box_equal(previous[p].bounds, key->bounds)) {
+                ok = diff_push(track, CLAY_RENDER_CHANGE_MOVED, key, c, previous[p].bounds);
+            } else if (previous[p].style != key->style || p < last_matched) {
+                ok = diff_push(track, CLAY_RENDER_CHANGE_RESTYLED, key, c, key->bounds);
+            }
+            if (p > last_matched) last_matched = p;
+        }
+        if (!ok) return false;
+    }
+    for (int32_t p = 0; p < previous_count; p++) {
+        if (previous[p].matched >= 0) continue;
+        if (!diff_push(track, CLAY_RENDER_CHANGE_REMOVED, &previous[p], -1,
+                       previous[p].bounds)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void diff_publish(_CelClaySurfaceTrack* track) {
+    ClayRenderDiff* diff = &track->diff;
+    diff->added = track->changes[CLAY_RENDER_CHANGE_ADDED].items;
+    diff->added_count = track->changes[CLAY_RENDER_CHANGE_ADDED].count;
+    diff->removed = track->changes[CLAY_RENDER_CHANGE_REMOVED].items;
+    diff->removed_count = track->changes[CLAY_RENDER_CHANGE_REMOVED].count;
+    diff->moved = track->changes[CLAY_RENDER_CHANGE_MOVED].items;
+    diff->moved_count = track->changes[CLAY_RENDER_CHANGE_MOVED].count;
+    diff->restyled = track->changes[CLAY_RENDER_CHANGE_RESTYLED].items;
+    diff->restyled_count = track->changes[CLAY_RENDER_CHANGE_RESTYLED].count;
+}
+
+/* Key, hash and diff this frame's output of a surface. Returns whether
+ * its content differs from the previous frame (dirty). Surfaces whose
+ * revision did not move since the last dispatch are clean without being
+ * looked at, unless `rekey` is set. */
+static bool track_update(_CelClaySurfaceTrack* track, const _CelClaySurfaceOutput* output,
+                         bool rekey) {
+    if (track->primed && !rekey && track->revision == output->revision) {
+        diff_reset(track);
+        return false;
+    }
+    track->revision = output->revision;
+
+    cull_commands(track, output->commands, output->dimensions);
+    Clay_RenderCommandArray commands = track->commands;
+    int32_t next = 1 - track->keys_current;
+    if (commands.length > track->key_capacity[next]) {
+        _CelClayCommandKey* keys = (_CelClayCommandKey*)realloc(
+            track->keys[next], sizeof(_CelClayCommandKey) * (size_t)commands.length);
+        if (!keys) {
+            fprintf(stderr, "[cels-clay] render bridge: out of memory diffing %d commands\n",
+                    commands.length);
+            track->primed = false;
+            track->dimensions = output->dimensions;
+            diff_full(track);
+            return true;
+        }
+        track->keys[next] = keys;
+        track->key_capacity[next] = commands.length;
+    }
+
+    _CelClayCommandKey* keys = track->keys[next];
+    uint64_t hash = hash_mix(CEL_CLAY_HASH_SEED, (uint64_t)(uint32_t)commands.length);
+    for (int32_t i = 0; i < commands.length; i++) {
+        const Clay_RenderCommand* command = &commands.internalArray[i];
+        keys[i] = (_CelClayCommandKey){
+            .key = ((uint64_t)command->id << 8) | (uint64_t)command->commandType,
+            .style = hash_command_style(command),
+            .bounds = command->boundingBox,
+            .matched = -1
+        };
+        hash = hash_mix(hash, keys[i].style);
+        hash = hash_bytes(hash, &keys[i].bounds, sizeof(Clay_BoundingBox));
+    }
+    track->key_count[next] = commands.length;
+
+    bool resized = track->dimensions.width != output->dimensions.width ||
+                   track->dimensions.height != output->dimensions.height;
+    bool changed = !track->primed || resized || hash != track->hash;
+    track->hash = hash;
+    track->dimensions = output->dimensions;
+
+    diff_reset(track);
+    if (!changed) return false;  /* Same content: keep the current keys */
+
+    if (!track->primed || resized ||
+        !diff_compute(track, track->keys[track->keys_current],
+                      track->key_count[track->keys_current],
+                      keys, commands.length)) {
+        diff_full(track);
+    } else {
+        diff_publish(track);
+    }
+    track->keys_current = next;
+    track->primed = true;
+    return true;
+}
+
+/* ============================================================================
+ * Render Snapshots
+ * ============================================================================
+ *
+ * A ring of 2-3 buffers, each holding one frame: per-surface entries, all
+ * surfaces' commands in one array, and the bytes of every text command.
+ * The dispatch copies into a buffer no reader holds and then publishes it
+ * as the latest; readers take a reference on the latest. Buffer states
+ * change under a spinlock -- only a few instructions; copying happens
+ * outside it (a buffer being written is neither the latest nor held).
+ */
+
+#define CEL_CLAY_MAX_RENDER_BUFFERS 3
+
+typedef struct {
+    ClayRenderSnapshot snapshot;          /* Handed out to readers */
+    ClayRenderSnapshotSurface* surfaces;
+    int32_t surface_capacity;
+    Clay_RenderCommand* commands;
+    int32_t command_capacity;
+    char* strings;
+    size_t string_capacity;
+    int32_t readers;                      /* Under g_snapshot_lock */
+} _CelClaySnapshotBuffer;
+
+static _CelClaySnapshotBuffer g_snapshots[CEL_CLAY_MAX_RENDER_BUFFERS];
+static int32_t g_snapshot_count = 0;      /* 0 = snapshots off */
+static int32_t g_snapshot_latest = -1;    /* Under g_snapshot_lock */
+static atomic_flag g_snapshot_lock = ATOMIC_FLAG_INIT;
+
+static void snapshot_lock(void) {
+    while (atomic_flag_test_and_set_explicit(&g_snapshot_lock, memory_order_acquire)) {
+    }
+}
+
+static void snapshot_unlock(void) {
+    atomic_flag_clear_explicit(&g_snapshot_lock, memory_order_release);
+}
+
+/* Buffer to write the next frame into: one that is neither held nor the
+ * latest, else the unread latest (dropping it). -1 if all are held. */
+static int32_t snapshot_claim(void) {
+    int32_t claimed = -1;
+    snapshot_lock();
+    for (int32_t i = 0; i < g_snapshot_count; i++) {
+        if (g_snapshots[i].readers == 0 && i != g_snapshot_latest) {
+            claimed = i;
+            break;
+        }
+    }
+    if (claimed < 0 && g_snapshot_latest >= 0 &&
+        g_snapshots[g_snapshot_latest].readers == 0) {
+        claimed = g_snapshot_latest;
+        g_snapshot_latest = -1;
+    }
+    snapshot_unlock();
+    return claimed;
+}
+
+/* Copy the published surface data into `buffer`. False if out of memory
+ * (the buffer is then left unpublished). */
+static bool snapshot_fill(_CelClaySnapshotBuffer* buffer, int32_t count,
+                          float delta_time) {
+    int32_t total = 0;
+    size_t text_size = 0;
+    for (int32_t i = 0; i < count; i++) {
+        Clay_RenderCommandArray commands = g_surface_data[i].render_commands;
+        total += commands.length;
+        for (int32_t c = 0; c < commands.length; c++) {
+            if (commands.internalArray[c].commandType == CLAY_RENDER_COMMAND_TYPE_TEXT) {
+                text_size += (size_t)commands.internalArray[c].renderData.text.stringContents.length;
+            }
+        }
+    }
+
+    if (count > buffer->surface_capacity) {
+        ClayRenderSnapshotSurface* surfaces = (ClayRenderSnapshotSurface*)realloc(
+            buffer->surfaces, sizeof(ClayRenderSnapshotSurface) * (size_t)count);
+        if (!surfaces) return false;
+        buffer->surfaces = surfaces;
+        buffer->surface_capacity = count;
+    }
+    if (total > buffer->command_capacity) {
+        Clay_RenderCommand* commands = (Clay_RenderCommand*)realloc(
+            buffer->commands, sizeof(Clay_RenderCommand) * (size_t)total);
+        if (!commands) return false;
+        buffer->commands = commands;
+        buffer->command_capacity = total;
+    }
+    if (text_size > buffer->string_capacity) {
+        char* strings = (char*)realloc(buffer->strings, text_size);
+        if (!strings) return false;
+        buffer->strings = strings;
+        buffer->string_capacity = text_size;
+    }
+
+    int32_t offset = 0;
+    size_t text_offset = 0;
+    for (int32_t i = 0; i < count; i++) {
+        const ClayRenderableData* data = &g_surface_data[i];
+        Clay_RenderCommandArray commands = data->render_commands;
+        Clay_RenderCommand* copy = buffer->commands + offset;
+        if (commands.length > 0) {
+            memcpy(copy, commands.internalArray,
+                   sizeof(Clay_RenderCommand) * (size_t)commands.length);
+        }
+        for (int32_t c = 0; c < commands.length; c++) {
+            if (copy[c].commandType != CLAY_RENDER_COMMAND_TYPE_TEXT) continue;
+            Clay_StringSlice* string = &copy[c].renderData.text.stringContents;
+            if (string->length > 0) {
+                memcpy(buffer->strings + text_offset, string->chars, (size_t)string->length);
+            }
+            string->chars = buffer->strings + text_offset;
+            string->baseChars = string->chars;
+            text_offset += (size_t)string->length;
+        }
+
+        buffer->surfaces[i] = (ClayRenderSnapshotSurface){
+            .surface = data->surface,
+            .render_commands = {
+                .capacity = commands.length,
+                .length = commands.length,
+                .internalArray = copy
+            },
+            .layout_width = data->layout_width,
+            .layout_height = data->layout_height
+        };
+        offset += commands.length;
+    }
+
+    buffer->snapshot = (ClayRenderSnapshot){
+        .frame_number = g_frame_number,
+        .delta_time = delta_time,
+        .surface_count = count,
+        .surfaces = buffer->surfaces
+    };
+    return true;
+}
+
+static void snapshot_publish(float delta_time) {
+    int32_t index = snapshot_claim();
+    if (index < 0) return;  /* Every buffer is held: drop this frame */
+
+    if (!snapshot_fill(&g_snapshots[index], g_surface_data_count, delta_time)) {
+        fprintf(stderr, "[cels-clay] render bridge: out of memory for snapshot\n");
+        return;
+    }
+
+    snapshot_lock();
+    g_snapshot_latest = index;
+    snapshot_unlock();
+}
+
+const ClayRenderSnapshot* cel_clay_snapshot_acquire(void) {
+    const ClayRenderSnapshot* snapshot = NULL;
+    snapshot_lock();
+    if (g_snapshot_latest >= 0) {
+        g_snapshots[g_snapshot_latest].readers++;
+        snapshot = &g_snapshots[g_snapshot_latest].snapshot;
+    }
+    snapshot_unlock();
+    return snapshot;
+}
+
+void cel_clay_snapshot_release(const ClayRenderSnapshot* snapshot) {
+    if (snapshot == NULL) return;
+    snapshot_lock();
+    for (int32_t i = 0; i < g_snapshot_count; i++) {
+        if (&g_snapshots[i].snapshot == snapshot && g_snapshots[i].readers > 0) {
+            g_snapshots[i].readers--;
+            break;
+        }
+    }
+    snapshot_unlock();
+}
+
 /* ============================================================================
  * Render Dispatch System
  * ============================================================================
  *
- * Runs each frame at OnStore phase. Reads the most recent render commands
- * and layout dimensions from the layout subsystem, packages them into
- * ClayRenderableData, and updates the singleton entity's component.
+ * Runs each frame at OnStore phase. Reads every surface's most recent render
+ * commands and layout dimensions from the layout subsystem and packages
+ * them into ClayRenderableData (one per surface, see
+ * cel_clay_get_surface_render_data). The first surface is also written to
+ * the singleton entity's component for single-surface consumers.
+ *
+ * A surface is keyed, hashed and diffed only when the layout touched it
+ * (its output revision moved); otherwise it is clean with an empty diff.
+ * The singleton is written in place and marked modified only when
+ * its content changed.
  */
 static void ClayRenderDispatch_callback(ecs_iter_t* it) {
+    CEL_CLAY_PROFILE_BEGIN(dispatch);
+    bool traced = CEL_CLAY_TRACE_BEGIN("dispatch", -1);
     g_frame_number++;
 
     ecs_world_t* world = cels_get_world(cels_get_context());
-    Clay_RenderCommandArray commands = _cel_clay_get_render_commands();
-    Clay_Dimensions dims = _cel_clay_get_layout_dimensions();
+    const ClayRenderSnapshot* source = g_publish_snapshot;
+    g_publish_snapshot = NULL;
+    float delta_time = source ? source->delta_time : it->delta_time;
+    int32_t count = source ? source->surface_count : _cel_clay_surface_count();
 
-    ClayRenderableData data = {
-        .render_commands = commands,
-        .layout_width = dims.width,
-        .layout_height = dims.height,
-        .frame_number = g_frame_number,
-        .delta_time = it->delta_time,
-        .dirty = (commands.length > 0)
-    };
+    if (count > g_surface_data_capacity) {
+        ClayRenderableData* data = (ClayRenderableData*)realloc(
+            g_surface_data, sizeof(ClayRenderableData) * (size_t)count);
+        if (!data) {
+            fprintf(stderr, "[cels-clay] render bridge: out of memory for %d surfaces\n",
+                    count);
+            count = g_surface_data_capacity;
+        } else {
+            g_surface_data = data;
+            g_surface_data_capacity = count;
+        }
+    }
 
-    ecs_set_id(world, g_render_target, ClayRenderableData_id,
-               sizeof(ClayRenderableData), &data);
+    cels_entity_t previous_primary = g_surface_data_count > 0 ? g_surface_data[0].surface : 0;
+
+    for (int32_t t = 0; t < g_track_count; t++) g_tracks[t]->seen = false;
+
+    /* A surface that appeared, vanished or moved in the surface order
+     * changes what is under every other surface: all get a full diff */
+    bool surfaces_changed = false;
+    for (int32_t i = 0; i < count; i++) {
+        _CelClaySurfaceOutput published;
+        const _CelClaySurfaceOutput* output = &published;
+        if (source) {
+            const ClayRenderSnapshotSurface* surface = &source->surfaces[i];
+            published = (_CelClaySurfaceOutput){
+                .surface = surface->surface,
+                .commands = surface->render_commands,
+                .dimensions = { surface->layout_width, surface->layout_height }
+            };
+        } else {
+            output = _cel_clay_surface_output(i);
+        }
+        _CelClaySurfaceTrack* track = track_for(output->surface, i);
+        bool dirty = true;
+        if (track) {
+            if (track->position != i) surfaces_changed = true;
+            track->position = i;
+            track->seen = true;
+            /* Revisions only order layout passes: rekey around snapshots */
+            dirty = track_update(track, output, source != NULL || g_published_last);
+        } else {
+            fprintf(stderr, "[cels-clay] render bridge: out of memory tracking surface\n");
+        }
+        g_surface_data[i] = (ClayRenderableData){
+            .render_commands = track ? track->commands : output->commands,
+            .layout_width = output->dimensions.width,
+            .layout_height = output->dimensions.height,
+            .frame_number = g_frame_number,
+            .delta_time = delta_time,
+            .dirty = dirty,
+            .surface = output->surface,
+            .content_hash = track ? track->hash : 0,
+            .diff = track ? &track->diff : NULL,
+            .culled_commands = track ? track->culled_commands : 0,
+            .culled_ranges = track ? track->culled_ranges : 0
+        };
+    }
+    g_surface_data_count = count;
+    g_published_last = source != NULL;
+
+    for (int32_t t = 0; t < g_track_count; ) {
+        if (g_tracks[t]->seen) {
+            t++;
+            continue;
+        }
+        track_free(g_tracks[t]);
+        g_tracks[t] = g_tracks[--g_track_count];
+        surfaces_changed = true;
+    }
+    if (surfaces_changed) {
+        for (int32_t t = 0; t < g_track_count; t++) diff_full(g_tracks[t]);
+        for (int32_t i = 0; i < count; i++) g_surface_data[i].dirty = true;
+    }
+
+    ClayRenderableData primary = { .frame_number = g_frame_number,
+                                   .delta_time = delta_time };
+    if (count > 0) primary = g_surface_data[0];
+
+    /* Update the singleton in place; signal only content changes */
+    ClayRenderableData* target = (ClayRenderableData*)ecs_get_mut_id(
+        world, g_render_target, ClayRenderableData_id);
+    if (target) {
+        bool modified = primary.dirty || primary.surface != previous_primary;
+        *target = primary;
+        if (modified) ecs_modified_id(world, g_render_target, ClayRenderableData_id);
+    }
+
+    if (g_snapshot_count > 0) snapshot_publish(delta_time);
+    _cel_clay_record_frame(g_surface_data, g_surface_data_count);
+    CEL_CLAY_PROFILE_END(dispatch, CEL_CLAY_PHASE_DISPATCH);
+    if (traced) CEL_CLAY_TRACE_END();
 }
 
 /* ============================================================================
@@ -92,12 +919,25 @@ static void ClayRenderDispatch_callback(ecs_iter_t* it) {
  * ============================================================================
  *
  * For advanced users who want raw render commands. Delegates to the layout
- * subsystem's internal getter.
+ * subsystem's internal getter (first surface).
  */
 Clay_RenderCommandArray cel_clay_get_render_commands(void) {
     return _cel_clay_get_render_commands();
 }
 
+void cel_clay_render_publish_snapshot(const ClayRenderSnapshot* snapshot) {
+    g_publish_snapshot = snapshot;
+}
+
+int32_t cel_clay_surface_count(void) {
+    return g_surface_data_count;
+}
+
+const ClayRenderableData* cel_clay_get_surface_render_data(int32_t index) {
+    if (index < 0 || index >= g_surface_data_count) return NULL;
+    return &g_surface_data[index];
+}
+
 /* ============================================================================
  * Init (called from clay_engine.c during module init)
  * ============================================================================
@@ -117,6 +957,42 @@ void _cel_clay_render_init(void) {
     ClayRenderableData initial = {0};
     ecs_set_id(world, g_render_target, ClayRenderableData_id,
                sizeof(ClayRenderableData), &initial);
+
+    /* Snapshot ring size from Clay_Engine_configure */
+    uint32_t buffers = _cel_clay_engine_config()->render_buffers;
+    if (buffers == 1) buffers = 2;
+    if (buffers > CEL_CLAY_MAX_RENDER_BUFFERS) buffers = CEL_CLAY_MAX_RENDER_BUFFERS;
+    g_snapshot_count = (int32_t)buffers;
+    g_snapshot_latest = -1;
+}
+
+void _cel_clay_render_cleanup(void) {
+    cel_clay_record_stop();
+#ifdef CELS_CLAY_TRACE
+    cel_clay_trace_stop();
+#endif
+    g_publish_snapshot = NULL;
+    g_published_last = false;
+
+    free(g_surface_data);
+    g_surface_data = NULL;
+    g_surface_data_count = 0;
+    g_surface_data_capacity = 0;
+
+    for (int32_t t = 0; t < g_track_count; t++) track_free(g_tracks[t]);
+    free(g_tracks);
+    g_tracks = NULL;
+    g_track_count = 0;
+    g_track_capacity = 0;
+
+    for (int32_t i = 0; i < CEL_CLAY_MAX_RENDER_BUFFERS; i++) {
+        free(g_snapshots[i].surfaces);
+        free(g_snapshots[i].commands);
+        free(g_snapshots[i].strings);
+        g_snapshots[i] = (_CelClaySnapshotBuffer){0};
+    }
+    g_snapshot_count = 0;
+    g_snapshot_latest = -1;
 }
 
 /* ============================================================================
@@ -26,6 +26,8 @@
  *     (window may not exist at module init time)
  *   - TTF_CreateRendererTextEngine for SDL3_ttf text engine API
  *   - Scissor stack for nested clip region support
+ *   - Optional retained canvas repainted only where the render diff
+ *     reports damage (ClaySDL3Config.retained)
  *   - Corner radius: skipped for v1 (filled rects only)
  *
  * Anti-patterns avoided:
@@ -39,6 +41,9 @@
 
 #include "cels-clay/clay_sdl3_renderer.h"
 #include "cels-clay/clay_render.h"
+#include "cels-clay/clay_layout.h"
+#include "cels-clay/clay_profile.h"
+#include "cels-clay/clay_trace.h"
 #include "clay.h"
 #include <cels/cels.h>
 #include <cels_sdl3.h>
@@ -155,6 +160,9 @@ static bool ensure_renderer_initialized(void) {
         if (!g_font) {
             SDL_Log("Clay_SDL3: TTF_OpenFont('%s') failed: %s",
                     g_sdl3_config.font_path, SDL_GetError());
+        } else {
+            /* Words measured before the font existed were cached as 0x0 */
+            cel_clay_invalidate_text_measurements();
         }
     } else {
         SDL_Log("Clay_SDL3: No font_path configured. "
@@ -168,7 +176,7 @@ static bool ensure_renderer_initialized(void) {
  * Text Measurement Callback (pixel-based)
  * ============================================================================
  *
- * Provides pixel-accurate text dimensions for Clay_SetMeasureTextFunction.
+ * Provides pixel-accurate text dimensions for cel_clay_set_measure_text_function.
  * Uses TTF_GetStringSize for width/height measurement in pixels.
  *
  * Unlike the NCurses renderer (which measures in cell columns), this
@@ -288,81 +296,204 @@ static void render_sdl3_border(Clay_RenderCommand* cmd) {
  * Render Callback
  * ============================================================================
  *
- * Main render system callback. Reads ClayRenderableData from the singleton
- * entity and iterates the Clay_RenderCommandArray, dispatching each command
- * to the appropriate SDL3 draw function.
+ * Main render system callback. Iterates every surface's ClayRenderableData
+ * (published by ClayRenderDispatch, in surface order) and dispatches each
+ * render command to the appropriate SDL3 draw function.
  *
  * Called each frame at OnRender phase after ClayRenderDispatch has updated
- * the ClayRenderableData singleton.
+ * the per-surface render data.
  */
 
-static void clay_sdl3_render(cels_iter_t* it) {
-    (void)it;
-    /* Read render commands directly from the layout system getter */
-    Clay_RenderCommandArray cmds = cel_clay_get_render_commands();
-    if (cmds.length <= 0) return;
-    if (!ensure_renderer_initialized()) return;
+static void render_sdl3_commands(Clay_RenderCommandArray cmds, const SDL_Rect* area) {
+    bool traced = CEL_CLAY_TRACE_BEGIN("draw", -1);
+    if (traced) CEL_CLAY_TRACE_ARG("commands", cmds.length);
+
+    for (int32_t j = 0; j < cmds.length; j++) {
+        Clay_RenderCommand* cmd = Clay_RenderCommandArray_Get(&cmds, j);
+        Clay_BoundingBox bb = cmd->boundingBox;
+        SDL_FRect rect = {
+            .x = bb.x, .y = bb.y,
+            .w = bb.width, .h = bb.height
+        };
+
+        /* Outside the repainted area: only scissors matter */
+        if (area &&
+            cmd->commandType != CLAY_RENDER_COMMAND_TYPE_SCISSOR_START &&
+            cmd->commandType != CLAY_RENDER_COMMAND_TYPE_SCISSOR_END) {
+            SDL_FRect clip = { (float)area->x, (float)area->y,
+                               (float)area->w, (float)area->h };
+            if (!SDL_HasRectIntersectionFloat(&rect, &clip)) continue;
+        }
+
+        switch (cmd->commandType) {
+            case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
+                Clay_Color c = cmd->renderData.rectangle.backgroundColor;
+                SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
+                SDL_SetRenderDrawColor(g_renderer,
+                    (uint8_t)c.r, (uint8_t)c.g,
+                    (uint8_t)c.b, (uint8_t)c.a);
+                /* Clamp rect to reasonable size for SDL */
+                if (rect.w > 10000) rect.w = 10000;
+                if (rect.h > 10000) rect.h = 10000;
+                SDL_RenderFillRect(g_renderer, &rect);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_TEXT: {
+                render_sdl3_text(cmd);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_BORDER: {
+                render_sdl3_border(cmd);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
+                SDL_Rect clip = {
+                    .x = (int)bb.x, .y = (int)bb.y,
+                    .w = (int)bb.width, .h = (int)bb.height
+                };
+                scissor_push(clip);
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
+                scissor_pop();
+                break;
+            }
+            case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
+                /* Cast imageData to SDL_Texture* (user provides texture) */
+                if (cmd->renderData.image.imageData) {
+                    SDL_Texture* tex =
+                        (SDL_Texture*)cmd->renderData.image.imageData;
+                    SDL_RenderTexture(g_renderer, tex, NULL, &rect);
+                }
+                break;
+            }
+            default:
+                break;  /* CUSTOM, NONE -- skip silently */
+        }
+    }
 
-    /* Reset scissor stack at start of each render pass */
+    if (traced) CEL_CLAY_TRACE_END();
+}
+
+/* ============================================================================
+ * Retained Canvas
+ * ============================================================================
+ *
+ * With ClaySDL3Config.retained the surfaces are drawn into a target
+ * texture that outlives the frame. A frame whose surfaces all carry a
+ * partial render diff only repaints the damage: each damage rectangle is
+ * cleared and every surface's commands intersecting it are drawn again,
+ * clipped to it. The canvas is then copied to the render target, which
+ * the application clears and presents as usual.
+ */
+
+static SDL_Texture* g_canvas = NULL;
+static int g_canvas_w = 0;
+static int g_canvas_h = 0;
+
+/* (Re)create the canvas at the output size. True if its content is lost. */
+static bool canvas_prepare(int w, int h) {
+    if (g_canvas && g_canvas_w == w && g_canvas_h == h) return false;
+    if (g_canvas) SDL_DestroyTexture(g_canvas);
+    g_canvas = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_RGBA8888,
+                                 SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!g_canvas) {
+        SDL_Log("Clay_SDL3: canvas creation failed: %s", SDL_GetError());
+        g_canvas_w = g_canvas_h = 0;
+        return true;
+    }
+    SDL_SetTextureBlendMode(g_canvas, SDL_BLENDMODE_BLEND);
+    g_canvas_w = w;
+    g_canvas_h = h;
+    return true;
+}
+
+static void canvas_clear(const SDL_Rect* area) {
+    SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 0);
+    if (area) {
+        SDL_FRect rect = { (float)area->x, (float)area->y,
+                           (float)area->w, (float)area->h };
+        SDL_RenderFillRect(g_renderer, &rect);
+    } else {
+        SDL_RenderClear(g_renderer);
+    }
+    SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
+}
+
+static void render_surfaces(int32_t surface_count, const SDL_Rect* area) {
+    for (int32_t i = 0; i < surface_count; i++) {
+        Clay_RenderCommandArray cmds = cel_clay_get_surface_render_data(i)->render_commands;
+        if (cmds.length <= 0) continue;
+
+        /* Reset scissor stack at start of each surface's pass */
+        scissor_reset();
+        if (area) scissor_push(*area);
+        render_sdl3_commands(cmds, area);
+    }
     scissor_reset();
+}
 
-    {
-
-        for (int32_t j = 0; j < cmds.length; j++) {
-            Clay_RenderCommand* cmd = Clay_RenderCommandArray_Get(&cmds, j);
-            Clay_BoundingBox bb = cmd->boundingBox;
-            SDL_FRect rect = {
-                .x = bb.x, .y = bb.y,
-                .w = bb.width, .h = bb.height
-            };
-
-            switch (cmd->commandType) {
-                case CLAY_RENDER_COMMAND_TYPE_RECTANGLE: {
-                    Clay_Color c = cmd->renderData.rectangle.backgroundColor;
-                    SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
-                    SDL_SetRenderDrawColor(g_renderer,
-                        (uint8_t)c.r, (uint8_t)c.g,
-                        (uint8_t)c.b, (uint8_t)c.a);
-                    /* Clamp rect to reasonable size for SDL */
-                    if (rect.w > 10000) rect.w = 10000;
-                    if (rect.h > 10000) rect.h = 10000;
-                    SDL_RenderFillRect(g_renderer, &rect);
-                    break;
-                }
-                case CLAY_RENDER_COMMAND_TYPE_TEXT: {
-                    render_sdl3_text(cmd);
-                    break;
-                }
-                case CLAY_RENDER_COMMAND_TYPE_BORDER: {
-                    render_sdl3_border(cmd);
-                    break;
-                }
-                case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START: {
-                    SDL_Rect clip = {
-                        .x = (int)bb.x, .y = (int)bb.y,
-                        .w = (int)bb.width, .h = (int)bb.height
+static void render_retained(int32_t surface_count) {
+    int w = 0, h = 0;
+    SDL_GetCurrentRenderOutputSize(g_renderer, &w, &h);
+    if (w <= 0 || h <= 0) return;
+
+    bool full = canvas_prepare(w, h);
+    if (!g_canvas) {
+        render_surfaces(surface_count, NULL);  /* Fall back to direct drawing */
+        return;
+    }
+    bool dirty = full;
+    for (int32_t i = 0; i < surface_count; i++) {
+        const ClayRenderableData* data = cel_clay_get_surface_render_data(i);
+        dirty = dirty || data->dirty;
+        full = full || data->diff == NULL || data->diff->full;
+    }
+
+    if (dirty) {
+        SDL_SetRenderTarget(g_renderer, g_canvas);
+        if (full) {
+            canvas_clear(NULL);
+            render_surfaces(surface_count, NULL);
+        } else {
+            for (int32_t i = 0; i < surface_count; i++) {
+                const ClayRenderDiff* diff = cel_clay_get_surface_render_data(i)->diff;
+                for (int32_t d = 0; d < diff->damage_count; d++) {
+                    Clay_BoundingBox box = diff->damage[d];
+                    int x0 = (int)floorf(box.x);
+                    int y0 = (int)floorf(box.y);
+                    SDL_Rect area = {
+                        .x = x0, .y = y0,
+                        .w = (int)ceilf(box.x + box.width) - x0,
+                        .h = (int)ceilf(box.y + box.height) - y0
                     };
-                    scissor_push(clip);
-                    break;
-                }
-                case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END: {
-                    scissor_pop();
-                    break;
+                    canvas_clear(&area);
+                    render_surfaces(surface_count, &area);
                 }
-                case CLAY_RENDER_COMMAND_TYPE_IMAGE: {
-                    /* Cast imageData to SDL_Texture* (user provides texture) */
-                    if (cmd->renderData.image.imageData) {
-                        SDL_Texture* tex =
-                            (SDL_Texture*)cmd->renderData.image.imageData;
-                        SDL_RenderTexture(g_renderer, tex, NULL, &rect);
-                    }
-                    break;
-                }
-                default:
-                    break;  /* CUSTOM, NONE -- skip silently */
             }
         }
+        SDL_SetRenderTarget(g_renderer, NULL);
     }
+
+    SDL_RenderTexture(g_renderer, g_canvas, NULL, NULL);
+}
+
+static void clay_sdl3_render(cels_iter_t* it) {
+    (void)it;
+    int32_t surface_count = cel_clay_surface_count();
+    if (surface_count <= 0) return;
+    if (!ensure_renderer_initialized()) return;
+
+    /* Presenting is the app's (SDL_RenderPresent after the frame); wrap it
+     * in CEL_CLAY_PROFILE_BEGIN/END to time it */
+    CEL_CLAY_PROFILE_BEGIN(draw);
+    if (g_sdl3_config.retained) {
+        render_retained(surface_count);
+    } else {
+        render_surfaces(surface_count, NULL);
+    }
+    CEL_CLAY_PROFILE_END(draw, CEL_CLAY_PHASE_DRAW);
 }
 
 /* ============================================================================
@@ -385,7 +516,11 @@ CEL_Module(Clay_SDL3, init) {
         }
     }
 
-    Clay_SetMeasureTextFunction(clay_sdl3_measure_text, NULL);
+    cel_clay_set_measure_text_function(clay_sdl3_measure_text, NULL);
+
+    /* The measure callback resizes the shared TTF font: keep layout on
+     * one thread */
+    _cel_clay_layout_require_serial();
 
     /* Register render system at OnRender phase */
     ClayRenderableData_register();
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Text Width - Implementation
+ *
+ * Text is scanned as alternating printable-ASCII runs and "other" bytes.
+ * ASCII runs are 1 column per byte and make up nearly all of typical UI
+ * text, so they are found with a vector compare where available. Other
+ * bytes are newlines, controls (0 columns) or UTF-8 sequences, which are
+ * decoded and looked up in the built-in width table below.
+ *
+ * NOTE: This file compiles in the CONSUMER's context (INTERFACE library):
+ * the SIMD path follows the consumer's target flags (-mavx2, x86-64 SSE2).
+ */
+
+#include "cels-clay/clay_text_width.h"
+#include <stddef.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* ============================================================================
+ * Width Table (generated, two-stage)
+ * ============================================================================
+ *
+ * clay_text_width_table.h is generated by tools/gen_text_width_table.py
+ * from the Unicode Character Database (East Asian Width, general category)
+ * and compiled into the library, so widths do not depend on the host's
+ * libc or locale. Stage 1 maps the 256-code-point block of a code point to
+ * a deduplicated stage-2 block of 2-bit widths: a lookup is two loads, a
+ * shift and a mask.
+ */
+
+#include "clay_text_width_table.h"
+
+int _cel_clay_codepoint_width(uint32_t codepoint) {
+    if (codepoint >= 0x110000) return 1;
+    uint32_t block = k_width_stage1[codepoint >> 8];
+    uint32_t bits = k_width_stage2[block][(codepoint & 0xFF) >> 2];
+    return (int)((bits >> ((codepoint & 3) * 2)) & 3);
+}
+
+/* ============================================================================
+ * UTF-8 Decoding
+ * ============================================================================
+ *
+ * Strict decoder: rejects overlong forms, surrogates and code points past
+ * U+10FFFF. A rejected lead byte is consumed alone so decoding resyncs on
+ * the next byte.
+ */
+
+int32_t _cel_clay_utf8_decode(const char* text, int32_t length, uint32_t* out_codepoint) {
+    const unsigned char* s = (const unsigned char*)text;
+    *out_codepoint = 0xFFFD;
+    if (length <= 0) return 0;
+
+    uint32_t b0 = s[0];
+    if (b0 < 0x80) {
+        *out_codepoint = b0;
+        return 1;
+    }
+
+    int32_t need;
+    uint32_t cp, min;
+    if ((b0 & 0xE0) == 0xC0) {
+        need = 1; cp = b0 & 0x1F; min = 0x80;
+    } else if ((b0 & 0xF0) == 0xE0) {
+        need = 2; cp = b0 & 0x0F; min = 0x800;
+    } else if ((b0 & 0xF8) == 0xF0) {
+        need = 3; cp = b0 & 0x07; min = 0x10000;
+    } else {
+        return 1;  /* Continuation or invalid lead byte */
+    }
+    if (need >= length) return 1;
+
+    for (int32_t i = 1; i <= need; i++) {
+        if ((s[i] & 0xC0) != 0x80) return 1;
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 1;
+
+    *out_codepoint = cp;
+    return need + 1;
+}
+
+/* ============================================================================
+ * Printable ASCII Run Detection
+ * ============================================================================
+ *
+ * ascii_run returns the number of leading bytes in [0x20, 0x7E]. Bytes are
+ * compared as signed: 0x80-0xFF are negative, so `b > 0x1F` selects
+ * 0x20-0x7F in one compare and 0x7F is masked out separately.
+ */
+
+static size_t ascii_run(const unsigned char* s, size_t length) {
+    size_t n = 0;
+
+#if defined(__AVX2__)
+    const __m256i space_1 = _mm256_set1_epi8(0x1F);
+    const __m256i del_32 = _mm256_set1_epi8(0x7F);
+    while (n + 32 <= length) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + n));
+        __m256i ok = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, del_32),
+                                         _mm256_cmpgt_epi8(v, space_1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(ok);
+        if (mask != 0xFFFFFFFFu) return n + (size_t)__builtin_ctz(~mask);
+        n += 32;
+    }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+    const __m128i space_16 = _mm_set1_epi8(0x1F);
+    const __m128i del_16 = _mm_set1_epi8(0x7F);
+    while (n + 16 <= length) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + n));
+        __m128i ok = _mm_andnot_si128(_mm_cmpeq_epi8(v, del_16),
+                                      _mm_cmpgt_epi8(v, space_16));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(ok);
+        if (mask != 0xFFFFu) return n + (size_t)__builtin_ctz(~mask & 0xFFFFu);
+        n += 16;
+    }
+#endif
+
+    /* Scalar tail (and portable fallback) */
+    while (n < length && s[n] >= 0x20 && s[n] < 0x7F) n++;
+    return n;
+}
+
+/* ============================================================================
+ * Measurement
+ * ============================================================================ */
+
+_CelClayTextExtent _cel_clay_text_extent(const char* text, int32_t length) {
+    _CelClayTextExtent extent = { 0, 0 };
+    if (text == NULL || length <= 0) return extent;
+
+    const unsigned char* s = (const unsigned char*)text;
+    size_t n = (size_t)length;
+    size_t i = 0;
+    int32_t line = 0;
+    extent.lines = 1;
+
+    while (i < n) {
+        size_t run = ascii_run(s + i, n - i);
+        line += (int32_t)run;
+        i += run;
+        if (i >= n) break;
+
+        unsigned char b = s[i];
+        if (b == '\n') {
+            if (line > extent.columns) extent.columns = line;
+            line = 0;
+            extent.lines++;
+            i++;
+        } else if (b < 0x80) {
+            i++;  /* Control character: zero width */
+        } else {
+            uint32_t cp;
+            i += (size_t)_cel_clay_utf8_decode(text + i, (int32_t)(n - i), &cp);
+            line += _cel_clay_codepoint_width(cp);
+        }
+    }
+
+    if (line > extent.columns) extent.columns = line;
+    return extent;
+}
+
+int32_t _cel_clay_text_fit(const char* text, int32_t length, int32_t max_columns) {
+    if (text == NULL || length <= 0 || max_columns <= 0) return 0;
+
+    const unsigned char* s = (const unsigned char*)text;
+    size_t n = (size_t)length;
+    size_t i = 0;
+    int32_t columns = 0;
+
+    while (i < n) {
+        size_t run = ascii_run(s + i, n - i);
+        if (columns + (int32_t)run > max_columns) {
+            return (int32_t)(i + (size_t)(max_columns - columns));
+        }
+        columns += (int32_t)run;
+        i += run;
+        if (i >= n || s[i] == '\n') break;
+
+        uint32_t cp;
+        int32_t bytes = _cel_clay_utf8_decode(text + i, (int32_t)(n - i), &cp);
+        int width = s[i] < 0x80 ? 0 : _cel_clay_codepoint_width(cp);
+        if (columns + width > max_columns) break;
+        columns += width;
+        i += (size_t)bytes;
+    }
+    return (int32_t)i;
+}
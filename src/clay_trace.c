@@ -0,0 +1,393 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Trace - Implementation
+ *
+ * Every thread that opens a span gets a _CelClayTraceThread: its open-span
+ * stack and a single-producer / single-consumer ring of finished events.
+ * The thread is the only producer; the writer thread is the only consumer
+ * (after it is joined, cel_clay_trace_stop drains what is left). The
+ * writer sleeps on a condition variable between drains; a producer whose
+ * ring crosses half full raises g_trace_drain_requested and signals it
+ * without taking the mutex (a signal lost to the race with the writer
+ * going to sleep only delays the drain to the interval). The mutex is for
+ * the writer's wait and cel_clay_trace_stop alone.
+ *
+ * Thread records are pushed onto a lock-free list the first time a thread
+ * traces and are freed by cel_clay_trace_stop; a trace generation number
+ * tells a thread that its cached record belongs to a stopped trace.
+ *
+ * Compiled only with CELS_CLAY_TRACE (see CMakeLists.txt).
+ *
+ * NOTE: This file compiles in the CONSUMER's context (INTERFACE library).
+ */
+
+/* clock_gettime, pthread_cond_timedwait under strict -std */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#ifdef CELS_CLAY_TRACE
+
+#include "cels-clay/clay_trace.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CEL_CLAY_TRACE_MAX_ARGS 4
+#define CEL_CLAY_TRACE_MAX_DEPTH 64
+
+/* ============================================================================
+ * State
+ * ============================================================================ */
+
+typedef struct _CelClayTraceEvent {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t dur_ns;
+    int32_t key;
+    int32_t arg_count;
+    const char* arg_names[CEL_CLAY_TRACE_MAX_ARGS];
+    uint64_t args[CEL_CLAY_TRACE_MAX_ARGS];
+} _CelClayTraceEvent;
+
+typedef struct _CelClayTraceThread {
+    struct _CelClayTraceThread* next;
+    uint32_t tid;
+    bool named;                          /* thread_name metadata written */
+
+    /* Ring: written by the owning thread, drained by the flush */
+    _CelClayTraceEvent* ring;
+    uint32_t mask;
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    _Atomic uint32_t dropped;
+
+    /* Owning thread only */
+    _CelClayTraceEvent spans[CEL_CLAY_TRACE_MAX_DEPTH];
+    int32_t depth;
+    uint64_t measure_calls;
+    uint64_t measure_ns;
+} _CelClayTraceThread;
+
+atomic_bool _cel_clay_trace_on = false;
+int32_t _cel_clay_trace_subtree_threshold = 64;
+
+static FILE* g_trace_file = NULL;    /* Written only by the writer thread while tracing */
+static bool g_trace_first_event = true;
+static uint64_t g_trace_origin = 0;
+static uint32_t g_trace_capacity = 0;
+static _Atomic uint32_t g_trace_generation = 0;
+static _Atomic uint32_t g_trace_next_tid = 0;
+static _CelClayTraceThread* _Atomic g_trace_threads = NULL;
+
+static pthread_t g_trace_writer;
+static pthread_mutex_t g_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_trace_wake = PTHREAD_COND_INITIALIZER;
+static bool g_trace_stopping = false;
+static atomic_bool g_trace_drain_requested = false;
+static int32_t g_trace_interval_ms = 100;
+
+static _Thread_local _CelClayTraceThread* t_thread = NULL;
+static _Thread_local uint32_t t_generation = 0;
+
+/* ============================================================================
+ * Thread Records
+ * ============================================================================ */
+
+static _CelClayTraceThread* thread_state(void) {
+    uint32_t generation = atomic_load_explicit(&g_trace_generation, memory_order_acquire);
+    if (t_thread && t_generation == generation) return t_thread;
+
+    _CelClayTraceThread* thread = (_CelClayTraceThread*)calloc(1, sizeof(_CelClayTraceThread));
+    if (!thread) return NULL;
+    thread->ring = (_CelClayTraceEvent*)malloc(sizeof(_CelClayTraceEvent) * g_trace_capacity);
+    if (!thread->ring) {
+        free(thread);
+        return NULL;
+    }
+    thread->mask = g_trace_capacity - 1;
+    thread->tid = atomic_fetch_add(&g_trace_next_tid, 1) + 1;
+
+    _CelClayTraceThread* list = atomic_load(&g_trace_threads);
+    do {
+        thread->next = list;
+    } while (!atomic_compare_exchange_weak(&g_trace_threads, &list, thread));
+
+    t_thread = thread;
+    t_generation = generation;
+    return thread;
+}
+
+/* The calling thread's record, if it has one in the running trace */
+static _CelClayTraceThread* thread_current(void) {
+    if (t_generation != atomic_load_explicit(&g_trace_generation, memory_order_acquire)) {
+        return NULL;
+    }
+    return t_thread;
+}
+
+static void threads_free(void) {
+    _CelClayTraceThread* thread = atomic_exchange(&g_trace_threads, NULL);
+    while (thread) {
+        _CelClayTraceThread* next = thread->next;
+        free(thread->ring);
+        free(thread);
+        thread = next;
+    }
+}
+
+/* ============================================================================
+ * Span Hooks
+ * ============================================================================ */
+
+uint64_t _cel_clay_trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool _cel_clay_trace_begin(const char* name, int32_t key) {
+    _CelClayTraceThread* thread = thread_state();
+    if (!thread || thread->depth >= CEL_CLAY_TRACE_MAX_DEPTH) return false;
+
+    _CelClayTraceEvent* span = &thread->spans[thread->depth++];
+    span->name = name;
+    span->key = key;
+    span->arg_count = 0;
+    span->start_ns = _cel_clay_trace_now();
+    return true;
+}
+
+void _cel_clay_trace_arg(const char* name, uint64_t value) {
+    _CelClayTraceThread* thread = thread_current();
+    if (!thread || thread->depth == 0) return;
+
+    _CelClayTraceEvent* span = &thread->spans[thread->depth - 1];
+    if (span->arg_count >= CEL_CLAY_TRACE_MAX_ARGS) return;
+    span->arg_names[span->arg_count] = name;
+    span->args[span->arg_count] = value;
+    span->arg_count++;
+}
+
+void _cel_clay_trace_end(void) {
+    _CelClayTraceThread* thread = thread_current();
+    if (!thread || thread->depth == 0) return;
+
+    _CelClayTraceEvent* span = &thread->spans[--thread->depth];
+    span->dur_ns = _cel_clay_trace_now() - span->start_ns;
+
+    uint32_t head = atomic_load_explicit(&thread->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&thread->tail, memory_order_acquire);
+    if (head - tail > thread->mask) {
+        atomic_fetch_add_explicit(&thread->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    thread->ring[head & thread->mask] = *span;
+    atomic_store_explicit(&thread->head, head + 1, memory_order_release);
+
+    /* Crossing half full: drain now rather than at the next interval */
+    if (head + 1 - tail == (thread->mask + 1) / 2 &&
+        !atomic_exchange_explicit(&g_trace_drain_requested, true, memory_order_relaxed)) {
+        pthread_cond_signal(&g_trace_wake);
+    }
+}
+
+void _cel_clay_trace_end_key(int32_t key) {
+    _CelClayTraceThread* thread = thread_current();
+    if (!thread || thread->depth == 0) return;
+    if (thread->spans[thread->depth - 1].key != key) return;
+    _cel_clay_trace_end();
+}
+
+void _cel_clay_trace_measure(uint64_t ns) {
+    _CelClayTraceThread* thread = thread_state();
+    if (!thread) return;
+    thread->measure_calls++;
+    thread->measure_ns += ns;
+}
+
+void _cel_clay_trace_measure_args(void) {
+    _CelClayTraceThread* thread = thread_current();
+    if (!thread) return;
+    _cel_clay_trace_arg("measure_calls", thread->measure_calls);
+    _cel_clay_trace_arg("measure_us", thread->measure_ns / 1000);
+    thread->measure_calls = 0;
+    thread->measure_ns = 0;
+}
+
+/* ============================================================================
+ * Writer
+ * ============================================================================
+ *
+ * Chrome trace event format: complete events ("ph":"X") with microsecond
+ * timestamps relative to cel_clay_trace_start, one pid, the thread
+ * record's number as tid.
+ */
+
+static void write_separator(void) {
+    if (!g_trace_first_event) fputs(",\n", g_trace_file);
+    g_trace_first_event = false;
+}
+
+static double to_us(uint64_t ns) {
+    return (double)ns / 1000.0;
+}
+
+static void write_event(const _CelClayTraceThread* thread, const _CelClayTraceEvent* event) {
+    write_separator();
+    uint64_t start = event->start_ns > g_trace_origin ? event->start_ns - g_trace_origin : 0;
+    fprintf(g_trace_file,
+            "{\"name\":\"%s\",\"cat\":\"cels-clay\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+            "\"pid\":1,\"tid\":%u,\"args\":{",
+            event->name, to_us(start), to_us(event->dur_ns), thread->tid);
+    for (int32_t a = 0; a < event->arg_count; a++) {
+        fprintf(g_trace_file, "%s\"%s\":%llu", a > 0 ? "," : "",
+                event->arg_names[a], (unsigned long long)event->args[a]);
+    }
+    fputs("}}", g_trace_file);
+}
+
+static void trace_drain(void) {
+    for (_CelClayTraceThread* thread = atomic_load(&g_trace_threads); thread; thread = thread->next) {
+        if (!thread->named) {
+            write_separator();
+            fprintf(g_trace_file,
+                    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                    "\"args\":{\"name\":\"cels-clay %u\"}}",
+                    thread->tid, thread->tid);
+            thread->named = true;
+        }
+
+        uint32_t tail = atomic_load_explicit(&thread->tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&thread->head, memory_order_acquire);
+        for (; tail != head; tail++) {
+            write_event(thread, &thread->ring[tail & thread->mask]);
+        }
+        atomic_store_explicit(&thread->tail, tail, memory_order_release);
+
+        uint32_t dropped = atomic_exchange_explicit(&thread->dropped, 0, memory_order_relaxed);
+        if (dropped > 0) {
+            write_separator();
+            fprintf(g_trace_file,
+                    "{\"name\":\"events_dropped\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,"
+                    "\"pid\":1,\"tid\":%u,\"args\":{\"count\":%u}}",
+                    to_us(_cel_clay_trace_now() - g_trace_origin), thread->tid, dropped);
+        }
+    }
+    fflush(g_trace_file);
+}
+
+static void* trace_writer_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_trace_mutex);
+    while (!g_trace_stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += g_trace_interval_ms / 1000;
+        deadline.tv_nsec += (long)(g_trace_interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        if (!atomic_load_explicit(&g_trace_drain_requested, memory_order_relaxed)) {
+            pthread_cond_timedwait(&g_trace_wake, &g_trace_mutex, &deadline);
+        }
+        if (g_trace_stopping) break;
+
+        pthread_mutex_unlock(&g_trace_mutex);
+        atomic_store_explicit(&g_trace_drain_requested, false, memory_order_relaxed);
+        trace_drain();
+        pthread_mutex_lock(&g_trace_mutex);
+    }
+    pthread_mutex_unlock(&g_trace_mutex);
+    return NULL;
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+bool cel_clay_trace_start(const char* path, const ClayTraceConfig* config) {
+    if (g_trace_file) {
+        fprintf(stderr, "[cels-clay] trace: already tracing\n");
+        return false;
+    }
+    if (!path) return false;
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "[cels-clay] trace: cannot create %s\n", path);
+        return false;
+    }
+
+    int32_t threshold = config && config->subtree_threshold > 0 ? config->subtree_threshold : 64;
+    int32_t events = config && config->events_per_thread > 0 ? config->events_per_thread : 16384;
+    int32_t interval = config && config->flush_interval_ms > 0 ? config->flush_interval_ms : 100;
+    uint32_t capacity = 64;
+    while (capacity < (uint32_t)events && capacity < (1u << 24)) capacity <<= 1;
+
+    g_trace_file = file;
+    g_trace_first_event = true;
+    g_trace_capacity = capacity;
+    g_trace_interval_ms = interval;
+    g_trace_stopping = false;
+    atomic_store(&g_trace_drain_requested, false);
+    _cel_clay_trace_subtree_threshold = threshold < 2 ? 2 : threshold;
+    atomic_store(&g_trace_next_tid, 0);
+    atomic_fetch_add_explicit(&g_trace_generation, 1, memory_order_release);
+    g_trace_origin = _cel_clay_trace_now();
+
+    fputs("[\n", g_trace_file);
+    if (pthread_create(&g_trace_writer, NULL, trace_writer_main, NULL) != 0) {
+        fprintf(stderr, "[cels-clay] trace: cannot start writer thread\n");
+        fclose(g_trace_file);
+        g_trace_file = NULL;
+        return false;
+    }
+    atomic_store(&_cel_clay_trace_on, true);
+    return true;
+}
+
+void cel_clay_trace_stop(void) {
+    if (!g_trace_file) return;
+
+    atomic_store(&_cel_clay_trace_on, false);
+    pthread_mutex_lock(&g_trace_mutex);
+    g_trace_stopping = true;
+    pthread_cond_signal(&g_trace_wake);
+    pthread_mutex_unlock(&g_trace_mutex);
+    pthread_join(g_trace_writer, NULL);
+
+    trace_drain();
+    fputs("\n]\n", g_trace_file);
+    fclose(g_trace_file);
+    g_trace_file = NULL;
+
+    /* Every thread's cached record goes stale with the generation */
+    atomic_fetch_add_explicit(&g_trace_generation, 1, memory_order_release);
+    threads_free();
+}
+
+bool cel_clay_trace_active(void) {
+    return g_trace_file != NULL;
+}
+
+#endif /* CELS_CLAY_TRACE */
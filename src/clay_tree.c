@@ -0,0 +1,1006 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Clay Layout Tree Cache - Implementation
+ *
+ * Implements the flattened layout node array:
+ * - Entity -> node index map (open addressing, rebuilt with the array)
+ * - Per-parent sorted child lists, maintained incrementally as children
+ *   are added, removed or reordered
+ * - Depth-first flatten of every ClaySurface subtree in sibling order
+ * - On-demand materialization of child windows (windowed containers and
+ *   the CEL_Clay_Children family) into a transient node region
+ * - Observers that classify ECS events as structural (rebuild) or value
+ *   (patch the node copy in place) changes
+ *
+ * NOTE: This file compiles in the CONSUMER's context (INTERFACE library).
+ */
+
+#include "cels-clay/clay_tree.h"
+#include "cels-clay/clay_layout.h"
+#include "cels-clay/clay_primitives.h"
+#include <flecs.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+/* ============================================================================
+ * Entity -> Node Index Map
+ * ============================================================================
+ *
+ * Linear-probing hash map keyed by entity id. Entity 0 is never a valid
+ * flecs entity, so it marks empty slots. The map is cleared and refilled
+ * on every rebuild, so it needs no deletion support.
+ */
+
+typedef struct {
+    ecs_entity_t* keys;
+    int32_t* values;
+    int32_t capacity;   /* Power of two (0 = unallocated) */
+    int32_t count;
+} _CelClayEntityMap;
+
+static uint32_t _entity_hash(ecs_entity_t e) {
+    /* 64-bit finalizer (murmur3 fmix64) -- entity ids are sequential */
+    e ^= e >> 33;
+    e *= 0xff51afd7ed558ccdULL;
+    e ^= e >> 33;
+    return (uint32_t)e;
+}
+
+static void _entity_map_clear(_CelClayEntityMap* map) {
+    if (map->keys) memset(map->keys, 0, sizeof(ecs_entity_t) * (size_t)map->capacity);
+    map->count = 0;
+}
+
+/* Ensure room for `n` entries at <= 50% load. Clears the map. */
+static bool _entity_map_reset(_CelClayEntityMap* map, int32_t n) {
+    int32_t want = 16;
+    while (want < n * 2) want *= 2;
+    if (want > map->capacity) {
+        ecs_entity_t* keys = (ecs_entity_t*)malloc(sizeof(ecs_entity_t) * (size_t)want);
+        int32_t* values = (int32_t*)malloc(sizeof(int32_t) * (size_t)want);
+        if (!keys || !values) {
+            free(keys);
+            free(values);
+            return false;
+        }
+        free(map->keys);
+        free(map->values);
+        map->keys = keys;
+        map->values = values;
+        map->capacity = want;
+    }
+    _entity_map_clear(map);
+    return true;
+}
+
+static void _entity_map_put(_CelClayEntityMap* map, ecs_entity_t key, int32_t value) {
+    uint32_t mask = (uint32_t)map->capacity - 1;
+    uint32_t slot = _entity_hash(key) & mask;
+    while (map->keys[slot] != 0 && map->keys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+    if (map->keys[slot] == 0) map->count++;
+    map->keys[slot] = key;
+    map->values[slot] = value;
+}
+
+static int32_t _entity_map_get(const _CelClayEntityMap* map, ecs_entity_t key) {
+    if (map->capacity == 0 || key == 0) return -1;
+    uint32_t mask = (uint32_t)map->capacity - 1;
+    uint32_t slot = _entity_hash(key) & mask;
+    while (map->keys[slot] != 0) {
+        if (map->keys[slot] == key) return map->values[slot];
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+/* Insert, growing (and rehashing) past 50% load. Used for maps that
+ * persist across rebuilds. */
+static bool _entity_map_insert(_CelClayEntityMap* map, ecs_entity_t key, int32_t value) {
+    if ((map->count + 1) * 2 > map->capacity) {
+        _CelClayEntityMap grown = {0};
+        if (!_entity_map_reset(&grown, map->count + 1)) return false;
+        for (int32_t i = 0; i < map->capacity; i++) {
+            if (map->keys[i] != 0) _entity_map_put(&grown, map->keys[i], map->values[i]);
+        }
+        free(map->keys);
+        free(map->values);
+        *map = grown;
+    }
+    _entity_map_put(map, key, value);
+    return true;
+}
+
+static void _entity_map_free(_CelClayEntityMap* map) {
+    free(map->keys);
+    free(map->values);
+    memset(map, 0, sizeof(*map));
+}
+
+/* ============================================================================
+ * Static State
+ * ============================================================================ */
+
+/* Nodes [0, g_tree_node_count) are the cached tree. Nodes past it are
+ * transient: materialized child windows, discarded at the next sync. The
+ * child slot table is split the same way. */
+static _CelClayNode* g_nodes = NULL;
+static int32_t g_node_count = 0;
+static int32_t g_node_capacity = 0;
+static int32_t g_tree_node_count = 0;
+static _CelClayEntityMap g_node_index = {0};
+
+/* World of the last sync (windows are materialized during the layout pass) */
+static const ecs_world_t* g_tree_world = NULL;
+
+/* Incremented by every sync: a node's prepared window is valid while its
+ * window_sync matches */
+static uint32_t g_sync_generation = 1;
+
+/* Structure changed: the array must be rebuilt before the next walk */
+static bool g_structure_dirty = true;
+/* A node copy was patched since the last sync */
+static bool g_values_dirty = false;
+
+/* Surfaces touched by changes since the last sync (pending), and the set
+ * published by the last sync for the current layout pass (frame). */
+static ecs_entity_t* g_pending_surfaces = NULL;
+static int32_t g_pending_count = 0;
+static int32_t g_pending_capacity = 0;
+static bool g_all_surfaces_changed = true;
+static ecs_entity_t* g_frame_surfaces = NULL;
+static int32_t g_frame_count = 0;
+static int32_t g_frame_capacity = 0;
+static bool g_frame_all_changed = true;
+
+/* Entities of the nodes touched by changes since the last sync. The sync
+ * stamps them and their ancestors with its generation (change_sync). */
+static ecs_entity_t* g_changed_nodes = NULL;
+static int32_t g_changed_count = 0;
+static int32_t g_changed_capacity = 0;
+
+/* Entities whose last change was paint-only (colors), pending and
+ * published like the surface sets. Their surfaces are not marked. */
+static ecs_entity_t* g_pending_paint = NULL;
+static int32_t g_pending_paint_count = 0;
+static int32_t g_pending_paint_capacity = 0;
+static ecs_entity_t* g_frame_paint = NULL;
+static int32_t g_frame_paint_count = 0;
+static int32_t g_frame_paint_capacity = 0;
+
+/* Child slots: node indices of every node's direct children, in sibling
+ * order. Node i's children are g_child_slots[first_child, +child_count). */
+static int32_t* g_child_slots = NULL;
+static int32_t g_child_slot_count = 0;
+static int32_t g_child_slot_capacity = 0;
+static int32_t g_tree_slot_count = 0;
+
+/* ============================================================================
+ * Node Loading
+ * ============================================================================
+ *
+ * Reads the Clay property components of an entity into a node. Component
+ * priority matches the walker: container > text > spacer > image.
+ */
+
+static void tree_node_load(const ecs_world_t* world, _CelClayNode* node) {
+    const void* c;
+    node->kind = CEL_CLAY_NODE_PASSTHROUGH;
+    node->has_border = false;
+    node->windowed = false;
+
+    if ((c = ecs_get_id(world, node->entity, ClayContainerConfig_id)) != NULL) {
+        node->kind = CEL_CLAY_NODE_CONTAINER;
+        node->config.container = *(const ClayContainerConfig*)c;
+        node->windowed = node->config.container.child_limit > 0;
+        const ClayBorderStyle* border = (const ClayBorderStyle*)
+            ecs_get_id(world, node->entity, ClayBorderStyle_id);
+        if (border) {
+            node->has_border = true;
+            node->border = *border;
+        }
+    } else if ((c = ecs_get_id(world, node->entity, ClayTextConfig_id)) != NULL) {
+        node->kind = CEL_CLAY_NODE_TEXT;
+        node->config.text = *(const ClayTextConfig*)c;
+        /* Stable text: measure once per set, not per pass */
+        ClayTextConfig* text = &node->config.text;
+        if (text->stable && text->length == 0 && text->text) {
+            text->length = (int32_t)strlen(text->text);
+        }
+    } else if ((c = ecs_get_id(world, node->entity, ClaySpacerConfig_id)) != NULL) {
+        node->kind = CEL_CLAY_NODE_SPACER;
+        node->config.spacer = *(const ClaySpacerConfig*)c;
+    } else if ((c = ecs_get_id(world, node->entity, ClayImageConfig_id)) != NULL) {
+        node->kind = CEL_CLAY_NODE_IMAGE;
+        node->config.image = *(const ClayImageConfig*)c;
+    }
+}
+
+/* ============================================================================
+ * Per-Parent Child Lists
+ * ============================================================================
+ *
+ * Every parent visited by the last rebuild owns a child list sorted by
+ * (CELS_SIBLING_ORDER, insertion order). The hierarchy observer keeps the
+ * lists current: an added child is inserted at its sorted position
+ * (binary search, O(1) when appended at the end), a removed child is
+ * erased, and a reordered child is moved. Cases it cannot resolve (e.g. a
+ * sibling order removed) mark the list dirty, and dirty lists are
+ * re-collected and re-sorted (qsort, O(n log n)) on next use. Clean lists
+ * are reused as-is, so a rebuild does not touch ecs_children for them.
+ *
+ * Lists whose parent was not reached by a rebuild (deleted or detached
+ * subtrees) are released at the end of that rebuild.
+ */
+
+typedef struct {
+    ecs_entity_t entity;
+    uint32_t order;
+    int32_t seq;        /* Collection order -- tie-break keeps the sort stable */
+} _CelClayChildRef;
+
+typedef struct {
+    ecs_entity_t parent;
+    _CelClayChildRef* children;
+    int32_t count;
+    int32_t capacity;
+    int32_t next_seq;   /* Insertion counter (order of children without one) */
+    bool dirty;
+    bool visited;       /* Reached by the current rebuild */
+} _CelClayChildList;
+
+static _CelClayChildList* g_lists = NULL;
+static int32_t g_list_count = 0;
+static int32_t g_list_capacity = 0;
+static _CelClayEntityMap g_list_index = {0};
+
+static int child_ref_compare(const void* a, const void* b) {
+    const _CelClayChildRef* ca = (const _CelClayChildRef*)a;
+    const _CelClayChildRef* cb = (const _CelClayChildRef*)b;
+    if (ca->order != cb->order) return ca->order < cb->order ? -1 : 1;
+    return (ca->seq > cb->seq) - (ca->seq < cb->seq);
+}
+
+static bool child_list_push(_CelClayChildList* list, ecs_entity_t entity,
+                            uint32_t order, int32_t seq) {
+    if (list->count >= list->capacity) {
+        int32_t cap = list->capacity ? list->capacity * 2 : 8;
+        _CelClayChildRef* c = (_CelClayChildRef*)realloc(list->children, sizeof(_CelClayChildRef) * (size_t)cap);
+        if (!c) return false;
+        list->children = c;
+        list->capacity = cap;
+    }
+    list->children[list->count++] = (_CelClayChildRef){ entity, order, seq };
+    return true;
+}
+
+/* Re-collect and sort a parent's children */
+static void child_list_collect(const ecs_world_t* world, _CelClayChildList* list) {
+    ecs_entity_t so_id = (ecs_entity_t)CELS_SIBLING_ORDER;
+
+    list->count = 0;
+    int32_t seq = 0;
+    ecs_iter_t it = ecs_children(world, list->parent);
+    while (ecs_children_next(&it)) {
+        for (int i = 0; i < it.count; i++) {
+            const cels_sibling_order_t* so = (const cels_sibling_order_t*)
+                ecs_get_id(world, it.entities[i], so_id);
+            if (!child_list_push(list, it.entities[i], so ? so->order : (uint32_t)seq, seq)) {
+                fprintf(stderr, "[cels-clay] layout tree: out of memory collecting children\n");
+                break;
+            }
+            seq++;
+        }
+    }
+
+    qsort(list->children, (size_t)list->count, sizeof(_CelClayChildRef),
+          child_ref_compare);
+    list->next_seq = seq;
+    list->dirty = false;
+}
+
+/* Insert a child at its sorted position. Children without a sibling order
+ * sort by insertion, i.e. they append. */
+static bool child_list_insert(const ecs_world_t* world, _CelClayChildList* list,
+                              ecs_entity_t entity) {
+    const cels_sibling_order_t* so = (const cels_sibling_order_t*)
+        ecs_get_id(world, entity, (ecs_entity_t)CELS_SIBLING_ORDER);
+    int32_t seq = list->next_seq++;
+    _CelClayChildRef ref = { entity, so ? so->order : (uint32_t)seq, seq };
+
+    if (!child_list_push(list, ref.entity, ref.order, ref.seq)) return false;
+
+    /* Fast path: ordered after the current last child */
+    int32_t last = list->count - 1;
+    if (last == 0 || child_ref_compare(&list->children[last - 1], &ref) <= 0) {
+        return true;
+    }
+
+    /* Upper bound over [0, last) */
+    int32_t lo = 0, hi = last;
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (child_ref_compare(&list->children[mid], &ref) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    memmove(&list->children[lo + 1], &list->children[lo],
+            sizeof(_CelClayChildRef) * (size_t)(last - lo));
+    list->children[lo] = ref;
+    return true;
+}
+
+/* Erase a child. Scans from the back: recently added children are the
+ * most likely to go again. */
+static bool child_list_remove(_CelClayChildList* list, ecs_entity_t entity) {
+    for (int32_t i = list->count - 1; i >= 0; i--) {
+        if (list->children[i].entity != entity) continue;
+        memmove(&list->children[i], &list->children[i + 1],
+                sizeof(_CelClayChildRef) * (size_t)(list->count - i - 1));
+        list->count--;
+        return true;
+    }
+    return false;
+}
+
+/* Sorted child list of a parent, created (dirty) on first use. Returns the
+ * list index (not a pointer: g_lists moves when it grows), or -1. */
+static int32_t child_list_get(const ecs_world_t* world, ecs_entity_t parent) {
+    int32_t index = _entity_map_get(&g_list_index, parent);
+    if (index < 0) {
+        if (g_list_count >= g_list_capacity) {
+            int32_t cap = g_list_capacity ? g_list_capacity * 2 : 64;
+            _CelClayChildList* lists = (_CelClayChildList*)realloc(g_lists, sizeof(_CelClayChildList) * (size_t)cap);
+            if (!lists) return -1;
+            g_lists = lists;
+            g_list_capacity = cap;
+        }
+        index = g_list_count;
+        if (!_entity_map_insert(&g_list_index, parent, index)) return -1;
+        g_list_count++;
+        g_lists[index] = (_CelClayChildList){ .parent = parent, .dirty = true };
+    }
+
+    _CelClayChildList* list = &g_lists[index];
+    if (list->dirty) child_list_collect(world, list);
+    list->visited = true;
+    return index;
+}
+
+/* Apply a hierarchy event to the parent's cached list (if any) */
+static void child_list_update(ecs_iter_t* it, ecs_entity_t parent,
+                              ecs_entity_t entity, bool child_of) {
+    int32_t index = _entity_map_get(&g_list_index, parent);
+    if (index < 0) return;
+    _CelClayChildList* list = &g_lists[index];
+    if (list->dirty) return;
+
+    bool ok;
+    if (child_of) {
+        ok = it->event == EcsOnAdd
+            ? child_list_insert(it->world, list, entity)
+            : child_list_remove(list, entity);
+    } else if (it->event == EcsOnSet) {
+        /* Reordered: move to the new position */
+        ok = child_list_remove(list, entity) &&
+             child_list_insert(it->world, list, entity);
+    } else {
+        ok = false;  /* Order removed: its insertion position is unknown */
+    }
+    if (!ok) list->dirty = true;
+}
+
+/* Release lists the last rebuild did not reach and reindex the rest */
+static void child_lists_collect_garbage(void) {
+    int32_t kept = 0;
+    for (int32_t i = 0; i < g_list_count; i++) {
+        if (g_lists[i].visited) {
+            g_lists[i].visited = false;
+            g_lists[kept++] = g_lists[i];
+        } else {
+            free(g_lists[i].children);
+        }
+    }
+    if (kept == g_list_count) return;
+
+    g_list_count = kept;
+    if (_entity_map_reset(&g_list_index, g_list_count)) {
+        for (int32_t i = 0; i < g_list_count; i++) {
+            _entity_map_put(&g_list_index, g_lists[i].parent, i);
+        }
+    }
+}
+
+/* ============================================================================
+ * Rebuild (depth-first flatten)
+ * ============================================================================ */
+
+static int32_t tree_push_node(ecs_entity_t entity, int32_t parent) {
+    if (g_node_count >= g_node_capacity) {
+        int32_t cap = g_node_capacity ? g_node_capacity * 2 : 256;
+        _CelClayNode* nodes = (_CelClayNode*)realloc(g_nodes, sizeof(_CelClayNode) * (size_t)cap);
+        if (!nodes) return -1;
+        g_nodes = nodes;
+        g_node_capacity = cap;
+    }
+    int32_t index = g_node_count++;
+    _CelClayNode* node = &g_nodes[index];
+    memset(node, 0, sizeof(*node));
+    node->entity = entity;
+    node->parent = parent;
+    node->surface = parent < 0 ? index : g_nodes[parent].surface;
+    node->end = index + 1;
+    return index;
+}
+
+static int32_t tree_reserve_child_slots(int32_t count) {
+    if (g_child_slot_count + count > g_child_slot_capacity) {
+        int32_t cap = g_child_slot_capacity ? g_child_slot_capacity : 256;
+        while (cap < g_child_slot_count + count) cap *= 2;
+        int32_t* slots = (int32_t*)realloc(g_child_slots, sizeof(int32_t) * (size_t)cap);
+        if (!slots) return -1;
+        g_child_slots = slots;
+        g_child_slot_capacity = cap;
+    }
+    int32_t first = g_child_slot_count;
+    g_child_slot_count += count;
+    return first;
+}
+
+static void tree_flatten_children(const ecs_world_t* world, int32_t parent_index) {
+    int32_t list_index = child_list_get(world, g_nodes[parent_index].entity);
+    if (list_index < 0) {
+        fprintf(stderr, "[cels-clay] layout tree: out of memory caching children\n");
+        return;
+    }
+    int32_t count = g_lists[list_index].count;
+    if (g_nodes[parent_index].windowed) {
+        /* Children are materialized per window during the layout pass */
+        g_nodes[parent_index].child_count = count;
+        return;
+    }
+    if (count == 0) return;
+
+    /* Reserve this parent's slots before recursing, so they stay contiguous */
+    int32_t first = tree_reserve_child_slots(count);
+    if (first < 0) {
+        fprintf(stderr, "[cels-clay] layout tree: out of memory adding children\n");
+        return;
+    }
+    g_nodes[parent_index].first_child = first;
+
+    for (int32_t i = 0; i < count; i++) {
+        /* Re-read through the index: recursion may grow g_lists */
+        ecs_entity_t child = g_lists[list_index].children[i].entity;
+        int32_t index = tree_push_node(child, parent_index);
+        if (index < 0) {
+            fprintf(stderr, "[cels-clay] layout tree: out of memory adding node\n");
+            break;
+        }
+        g_child_slots[first + i] = index;
+        g_nodes[parent_index].child_count = i + 1;
+        tree_node_load(world, &g_nodes[index]);
+        tree_flatten_children(world, index);
+        g_nodes[index].end = g_node_count;
+    }
+}
+
+static void tree_rebuild(const ecs_world_t* world) {
+    g_node_count = 0;
+    g_child_slot_count = 0;
+    g_tree_node_count = 0;
+    g_tree_slot_count = 0;
+
+    ecs_iter_t it = ecs_each_id(world, ClaySurfaceConfig_id);
+    while (ecs_each_next(&it)) {
+        for (int i = 0; i < it.count; i++) {
+            const ClaySurfaceConfig* config = (const ClaySurfaceConfig*)
+                ecs_get_id(world, it.entities[i], ClaySurfaceConfig_id);
+            if (!config) continue;
+
+            int32_t index = tree_push_node(it.entities[i], -1);
+            if (index < 0) break;
+            g_nodes[index].kind = CEL_CLAY_NODE_SURFACE;
+            g_nodes[index].config.surface = *config;
+            tree_flatten_children(world, index);
+            g_nodes[index].end = g_node_count;
+        }
+    }
+
+    g_tree_node_count = g_node_count;
+    g_tree_slot_count = g_child_slot_count;
+
+    child_lists_collect_garbage();
+
+    /* Index every node for observer lookups */
+    if (_entity_map_reset(&g_node_index, g_node_count)) {
+        for (int32_t i = 0; i < g_node_count; i++) {
+            _entity_map_put(&g_node_index, g_nodes[i].entity, i);
+        }
+    }
+}
+
+/* ============================================================================
+ * Observers
+ * ============================================================================
+ *
+ * Structural events (component add/remove, hierarchy, sibling order) mark
+ * the array for rebuild. Hierarchy and sibling-order events additionally
+ * update the affected parent's child list. A new subtree is discovered
+ * through the ChildOf event of its root (whose parent is in the tree).
+ *
+ * Every change is also attributed to the surface that owns the affected
+ * node, so the layout can skip surfaces that did not change.
+ *
+ * Entities below a windowed container are not in the node array. Events
+ * on them (or on the windowed container's child list) cannot change the
+ * cached tree, only the window's contents, so they just mark the values
+ * dirty -- the next layout pass materializes the window again. Events on
+ * entities outside every surface are ignored.
+ *
+ * OnSet of a Clay property component on a cached node patches the node's
+ * copy in place -- no rebuild needed.
+ */
+
+/* Node index of the nearest ancestor of `entity` (inclusive) in the
+ * cached tree, or -1 if the entity is outside every surface. */
+static int32_t tree_find_attached(const ecs_world_t* world, ecs_entity_t entity) {
+    for (ecs_entity_t e = entity; e != 0; e = ecs_get_parent(world, e)) {
+        int32_t index = _entity_map_get(&g_node_index, e);
+        if (index >= 0) return index;
+    }
+    return -1;
+}
+
+/* Record that node `index` changed, for _cel_clay_tree_subtree_changed */
+static void tree_mark_node(int32_t index) {
+    if (g_changed_count >= g_changed_capacity) {
+        int32_t cap = g_changed_capacity ? g_changed_capacity * 2 : 32;
+        ecs_entity_t* list = (ecs_entity_t*)realloc(g_changed_nodes, sizeof(ecs_entity_t) * (size_t)cap);
+        if (!list) {
+            g_all_surfaces_changed = true;  /* Cannot attribute: all changed */
+            return;
+        }
+        g_changed_nodes = list;
+        g_changed_capacity = cap;
+    }
+    g_changed_nodes[g_changed_count++] = g_nodes[index].entity;
+}
+
+/* Record that the surface owning node `index` must be laid out again */
+static void tree_mark_surface(int32_t index) {
+    if (index < 0 || g_all_surfaces_changed) return;
+    tree_mark_node(index);
+    ecs_entity_t surface = g_nodes[g_nodes[index].surface].entity;
+    for (int32_t i = 0; i < g_pending_count; i++) {
+        if (g_pending_surfaces[i] == surface) return;
+    }
+    if (g_pending_count >= g_pending_capacity) {
+        int32_t cap = g_pending_capacity ? g_pending_capacity * 2 : 8;
+        ecs_entity_t* list = (ecs_entity_t*)realloc(g_pending_surfaces, sizeof(ecs_entity_t) * (size_t)cap);
+        if (!list) {
+            g_all_surfaces_changed = true;  /* Cannot attribute: relayout all */
+            return;
+        }
+        g_pending_surfaces = list;
+        g_pending_capacity = cap;
+    }
+    g_pending_surfaces[g_pending_count++] = surface;
+}
+
+/* Record a paint-only change of node `index`. Falls back to a layout
+ * change of its surface if the entity cannot be queued. */
+static void tree_mark_paint(int32_t index) {
+    if (g_all_surfaces_changed) return;
+    if (g_pending_paint_count >= g_pending_paint_capacity) {
+        int32_t cap = g_pending_paint_capacity ? g_pending_paint_capacity * 2 : 16;
+        ecs_entity_t* list = (ecs_entity_t*)realloc(g_pending_paint, sizeof(ecs_entity_t) * (size_t)cap);
+        if (!list) {
+            tree_mark_surface(index);
+            g_values_dirty = true;
+            return;
+        }
+        g_pending_paint = list;
+        g_pending_paint_capacity = cap;
+    }
+    g_pending_paint[g_pending_paint_count++] = g_nodes[index].entity;
+    tree_mark_node(index);
+}
+
+/* Whether a node reload changed only colors: a container's bg (without
+ * becoming or ceasing to be transparent -- that adds or drops its
+ * rectangle command) or a text's color. Only stable text qualifies: a
+ * non-stable buffer may have been rewritten in place behind the same
+ * pointer, so a set on it always relays out. */
+static bool tree_paint_only(const _CelClayNode* before, const _CelClayNode* after) {
+    if (before->kind != after->kind || before->has_border != after->has_border ||
+        before->windowed != after->windowed) {
+        return false;
+    }
+    if (before->has_border && memcmp(&before->border, &after->border, sizeof(before->border)) != 0) {
+        return false;
+    }
+    if (after->kind == CEL_CLAY_NODE_CONTAINER) {
+        ClayContainerConfig a = before->config.container;
+        const ClayContainerConfig* b = &after->config.container;
+        if ((a.bg.a > 0.0f) != (b->bg.a > 0.0f)) return false;
+        a.bg = b->bg;
+        return memcmp(&a, b, sizeof(a)) == 0;
+    }
+    if (after->kind == CEL_CLAY_NODE_TEXT) {
+        if (!before->config.text.stable || !after->config.text.stable) return false;
+        ClayTextConfig a = before->config.text;
+        a.color = after->config.text.color;
+        return memcmp(&a, &after->config.text, sizeof(a)) == 0;
+    }
+    return false;
+}
+
+/* Classify a change to `entity` (child of `parent`) */
+static void tree_mark_changed(const ecs_world_t* world, ecs_entity_t entity,
+                              ecs_entity_t parent) {
+    int32_t entity_index = _entity_map_get(&g_node_index, entity);
+    int32_t parent_index = _entity_map_get(&g_node_index, parent);
+
+    if (parent_index >= 0 && g_nodes[parent_index].windowed) {
+        g_values_dirty = true;  /* Window contents changed */
+        tree_mark_surface(parent_index);
+    } else if (parent_index >= 0 || entity_index >= 0) {
+        g_structure_dirty = true;
+        tree_mark_surface(parent_index);
+        tree_mark_surface(entity_index);  /* Previous owner, if moved */
+    } else {
+        int32_t attached = tree_find_attached(world, parent);
+        if (attached >= 0) {
+            g_values_dirty = true;
+            tree_mark_surface(attached);
+        }
+    }
+}
+
+static void ClayTreeStructure_observer(ecs_iter_t* it) {
+    if (it->event_id == ClaySurfaceConfig_id) {
+        /* Surfaces are tree roots; new surfaces start dirty on their own */
+        g_structure_dirty = true;
+        return;
+    }
+    for (int i = 0; i < it->count; i++) {
+        ecs_entity_t e = it->entities[i];
+        tree_mark_changed(it->world, e, ecs_get_parent(it->world, e));
+    }
+}
+
+static void ClayTreeHierarchy_observer(ecs_iter_t* it) {
+    /* ChildOf events carry the parent in the pair; sibling order events
+     * are resolved through the entity's current parent */
+    bool child_of = it->event_id != (ecs_id_t)CELS_SIBLING_ORDER;
+
+    for (int i = 0; i < it->count; i++) {
+        ecs_entity_t e = it->entities[i];
+        ecs_entity_t parent = child_of
+            ? ecs_pair_second(it->world, it->event_id)
+            : ecs_get_parent(it->world, e);
+
+        child_list_update(it, parent, e, child_of);
+        tree_mark_changed(it->world, e, parent);
+    }
+}
+
+static void ClayTreeValue_observer(ecs_iter_t* it) {
+    for (int i = 0; i < it->count; i++) {
+        ecs_entity_t e = it->entities[i];
+        int32_t index = _entity_map_get(&g_node_index, e);
+        if (index < 0) {
+            /* Below a windowed container: re-read when materialized */
+            int32_t attached = tree_find_attached(it->world, ecs_get_parent(it->world, e));
+            if (attached >= 0) {
+                g_values_dirty = true;
+                tree_mark_surface(attached);
+            }
+            continue;
+        }
+
+        if (g_structure_dirty) {
+            tree_mark_surface(index);
+            continue;  /* The rebuild reloads every node */
+        }
+
+        _CelClayNode* node = &g_nodes[index];
+        if (node->kind == CEL_CLAY_NODE_SURFACE) {
+            const ClaySurfaceConfig* config = (const ClaySurfaceConfig*)
+                ecs_get_id(it->world, node->entity, ClaySurfaceConfig_id);
+            if (config) node->config.surface = *config;
+        } else {
+            _CelClayNode before = *node;
+            tree_node_load(it->world, node);
+            if (node->windowed != before.windowed) {
+                /* Children move into or out of the node array */
+                g_structure_dirty = true;
+                tree_mark_surface(index);
+                continue;
+            }
+            if (tree_paint_only(&before, node)) {
+                tree_mark_paint(index);
+                continue;
+            }
+        }
+        tree_mark_surface(index);
+        g_values_dirty = true;
+    }
+}
+
+static void tree_observe(ecs_world_t* world, ecs_id_t id,
+                          ecs_entity_t event_a, ecs_entity_t event_b,
+                          ecs_iter_action_t callback) {
+    if (id == 0) return;
+
+    ecs_observer_desc_t desc = {0};
+    desc.query.terms[0].id = id;
+    desc.events[0] = event_a;
+    desc.events[1] = event_b;
+    desc.callback = callback;
+
+    ecs_observer_init(world, &desc);
+}
+
+void _cel_clay_tree_observers_register(ecs_world_t* world) {
+    ecs_id_t value_ids[] = {
+        ClaySurfaceConfig_id, ClayContainerConfig_id, ClayTextConfig_id,
+        ClaySpacerConfig_id, ClayImageConfig_id, ClayBorderStyle_id
+    };
+    for (size_t i = 0; i < sizeof(value_ids) / sizeof(value_ids[0]); i++) {
+        tree_observe(world, value_ids[i], EcsOnAdd, EcsOnRemove,
+                     ClayTreeStructure_observer);
+        tree_observe(world, value_ids[i], EcsOnSet, 0,
+                     ClayTreeValue_observer);
+    }
+
+    tree_observe(world, ecs_pair(EcsChildOf, EcsWildcard), EcsOnAdd, EcsOnRemove,
+                 ClayTreeHierarchy_observer);
+    tree_observe(world, (ecs_id_t)CELS_SIBLING_ORDER, EcsOnSet, EcsOnRemove,
+                 ClayTreeHierarchy_observer);
+
+    g_structure_dirty = true;
+}
+
+/* ============================================================================
+ * Public (module-internal) API
+ * ============================================================================ */
+
+void _cel_clay_tree_invalidate(void) {
+    g_structure_dirty = true;
+}
+
+bool _cel_clay_tree_sync(ecs_world_t* world) {
+    /* Drop windows materialized by the previous pass */
+    g_node_count = g_tree_node_count;
+    g_child_slot_count = g_tree_slot_count;
+    g_tree_world = world;
+    g_sync_generation++;
+
+    bool changed = g_values_dirty;
+    if (g_structure_dirty) {
+        tree_rebuild(world);
+        g_structure_dirty = false;
+        changed = true;
+    }
+    g_values_dirty = false;
+
+    /* Stamp changed nodes and their ancestors (indices of the array as
+     * rebuilt; removed entities are gone, their parents were marked too) */
+    for (int32_t i = 0; i < g_changed_count; i++) {
+        int32_t index = _entity_map_get(&g_node_index, g_changed_nodes[i]);
+        while (index >= 0 && g_nodes[index].change_sync != g_sync_generation) {
+            g_nodes[index].change_sync = g_sync_generation;
+            index = g_nodes[index].parent;
+        }
+    }
+    g_changed_count = 0;
+
+    /* Publish the changed-surface set: swap pending <-> frame buffers */
+    ecs_entity_t* list = g_frame_surfaces;
+    int32_t capacity = g_frame_capacity;
+    g_frame_surfaces = g_pending_surfaces;
+    g_frame_count = g_pending_count;
+    g_frame_capacity = g_pending_capacity;
+    g_frame_all_changed = g_all_surfaces_changed;
+    g_pending_surfaces = list;
+    g_pending_count = 0;
+    g_pending_capacity = capacity;
+    g_all_surfaces_changed = false;
+
+    /* Publish the paint-only set the same way */
+    ecs_entity_t* paint = g_frame_paint;
+    int32_t paint_capacity = g_frame_paint_capacity;
+    g_frame_paint = g_pending_paint;
+    g_frame_paint_count = g_pending_paint_count;
+    g_frame_paint_capacity = g_pending_paint_capacity;
+    g_pending_paint = paint;
+    g_pending_paint_count = 0;
+    g_pending_paint_capacity = paint_capacity;
+
+    return changed;
+}
+
+bool _cel_clay_tree_surface_changed(ecs_entity_t surface) {
+    if (g_frame_all_changed) return true;
+    for (int32_t i = 0; i < g_frame_count; i++) {
+        if (g_frame_surfaces[i] == surface) return true;
+    }
+    return false;
+}
+
+const ecs_entity_t* _cel_clay_tree_paint_changes(int32_t* out_count) {
+    *out_count = g_frame_all_changed ? 0 : g_frame_paint_count;
+    return g_frame_paint;
+}
+
+bool _cel_clay_tree_subtree_changed(int32_t node) {
+    if (g_frame_all_changed || node < 0 || node >= g_tree_node_count) return true;
+    return g_nodes[node].change_sync == g_sync_generation;
+}
+
+const _CelClayNode* _cel_clay_tree_nodes(int32_t* out_count) {
+    if (out_count) *out_count = g_tree_node_count;
+    return g_nodes;
+}
+
+int32_t _cel_clay_tree_find(ecs_entity_t entity) {
+    return _entity_map_get(&g_node_index, entity);
+}
+
+bool _cel_clay_tree_window(int32_t node, int32_t start, int32_t count,
+                           int32_t* out_first, int32_t* out_end) {
+    if (node < 0 || node >= g_node_count || start < 0 || count <= 0) return false;
+
+    /* Configured window prepared for this pass: read-only, thread-safe */
+    const _CelClayNode* prepared = &g_nodes[node];
+    if (prepared->windowed && prepared->window_sync == g_sync_generation &&
+        (uint32_t)start == prepared->config.container.child_offset &&
+        (uint32_t)count == prepared->config.container.child_limit) {
+        *out_first = prepared->window_first;
+        *out_end = prepared->window_end;
+        return prepared->window_first < prepared->window_end;
+    }
+
+    if (!g_nodes[node].windowed) {
+        /* Children are already flattened: contiguous sibling subtrees */
+        int32_t n = g_nodes[node].child_count;
+        if (start >= n) return false;
+        if (count > n - start) count = n - start;
+        const int32_t* slots = &g_child_slots[g_nodes[node].first_child];
+        *out_first = slots[start];
+        *out_end = g_nodes[slots[start + count - 1]].end;
+        return true;
+    }
+
+    /* Materialize the window's subtrees past the cached tree */
+    int32_t list_index = child_list_get(g_tree_world, g_nodes[node].entity);
+    if (list_index < 0) return false;
+    int32_t n = g_lists[list_index].count;
+    g_nodes[node].child_count = n;
+    if (start >= n) return false;
+    if (count > n - start) count = n - start;
+
+    int32_t first = g_node_count;
+    for (int32_t i = start; i < start + count; i++) {
+        ecs_entity_t child = g_lists[list_index].children[i].entity;
+        int32_t index = tree_push_node(child, node);
+        if (index < 0) {
+            fprintf(stderr, "[cels-clay] layout tree: out of memory materializing window\n");
+            break;
+        }
+        tree_node_load(g_tree_world, &g_nodes[index]);
+        tree_flatten_children(g_tree_world, index);
+        g_nodes[index].end = g_node_count;
+    }
+
+    *out_first = first;
+    *out_end = g_node_count;
+    return first < g_node_count;
+}
+
+bool _cel_clay_tree_window_ready(int32_t node, int32_t start, int32_t count) {
+    if (node < 0 || node >= g_node_count) return true;  /* Nothing to grow */
+    const _CelClayNode* n = &g_nodes[node];
+    if (!n->windowed) return true;
+    return n->window_sync == g_sync_generation &&
+           (uint32_t)start == n->config.container.child_offset &&
+           (uint32_t)count == n->config.container.child_limit;
+}
+
+/* Materialize the configured window of one windowed node and record it */
+static void tree_prepare_window(int32_t node) {
+    const ClayContainerConfig* config = &g_nodes[node].config.container;
+    int32_t first = 0, end = 0;
+    if (!_cel_clay_tree_window(node, (int32_t)config->child_offset,
+                               (int32_t)config->child_limit, &first, &end)) {
+        first = end = 0;
+    }
+    g_nodes[node].window_first = first;
+    g_nodes[node].window_end = end;
+    g_nodes[node].window_sync = g_sync_generation;
+}
+
+void _cel_clay_tree_prepare_windows(int32_t surface) {
+    if (surface < 0 || surface >= g_tree_node_count) return;
+
+    /* Windows inside materialized windows are appended past `scan`, and
+     * picked up by the second loop as the region grows */
+    int32_t scan = g_node_count;
+    for (int32_t i = surface; i < g_nodes[surface].end; i++) {
+        if (g_nodes[i].windowed) tree_prepare_window(i);
+    }
+    for (int32_t i = scan; i < g_node_count; i++) {
+        if (g_nodes[i].windowed) tree_prepare_window(i);
+    }
+}
+
+void _cel_clay_tree_cleanup(void) {
+    free(g_nodes);
+    g_nodes = NULL;
+    g_node_count = 0;
+    g_node_capacity = 0;
+    g_tree_node_count = 0;
+    g_tree_world = NULL;
+
+    free(g_child_slots);
+    g_child_slots = NULL;
+    g_child_slot_count = 0;
+    g_child_slot_capacity = 0;
+    g_tree_slot_count = 0;
+
+    for (int32_t i = 0; i < g_list_count; i++) {
+        free(g_lists[i].children);
+    }
+    free(g_lists);
+    g_lists = NULL;
+    g_list_count = 0;
+    g_list_capacity = 0;
+    _entity_map_free(&g_list_index);
+
+    _entity_map_free(&g_node_index);
+
+    free(g_pending_surfaces);
+    g_pending_surfaces = NULL;
+    g_pending_count = 0;
+    g_pending_capacity = 0;
+    g_all_surfaces_changed = true;
+    free(g_frame_surfaces);
+    g_frame_surfaces = NULL;
+    g_frame_count = 0;
+    g_frame_capacity = 0;
+    g_frame_all_changed = true;
+    free(g_changed_nodes);
+    g_changed_nodes = NULL;
+    g_changed_count = 0;
+    g_changed_capacity = 0;
+    free(g_pending_paint);
+    g_pending_paint = NULL;
+    g_pending_paint_count = 0;
+    g_pending_paint_capacity = 0;
+    free(g_frame_paint);
+    g_frame_paint = NULL;
+    g_frame_paint_count = 0;
+    g_frame_paint_capacity = 0;
+
+    g_structure_dirty = true;
+    g_values_dirty = false;
+}
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# Copyright 2026 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Generate src/clay_text_width_table.h from the Python unicodedata module.
+
+Column width per code point (wcwidth conventions):
+  0  controls, nonspacing/enclosing marks (Mn, Me), format characters (Cf,
+     except U+00AD and the prepended concatenation marks), line/paragraph
+     separators, Hangul medial vowels and final consonants (U+1160-U+11FF)
+  2  East Asian Wide (W) and Fullwidth (F)
+  1  everything else
+
+Unassigned code points take the width of the run around them when both
+neighbours agree (so gaps in CJK blocks stay wide), are wide in planes 2-3
+(UAX #11 default), and narrow otherwise.
+
+The table is two-stage: stage 1 maps each 256-code-point block to a unique
+block in stage 2, which packs four 2-bit widths per byte.
+
+Usage: python3 tools/gen_text_width_table.py > src/clay_text_width_table.h
+"""
+
+import sys
+import unicodedata
+
+MAX_CP = 0x110000
+BLOCK = 256
+PREPENDED_CONCATENATION_MARKS = {
+    0x0600, 0x0601, 0x0602, 0x0603, 0x0604, 0x0605, 0x06DD, 0x070F,
+    0x0890, 0x0891, 0x08E2, 0x110BD, 0x110CD,
+}
+
+
+def classify(cp):
+    ch = chr(cp)
+    cat = unicodedata.category(ch)
+    if cat == "Cn":
+        return None
+    if cp == 0x00AD or cp in PREPENDED_CONCATENATION_MARKS:
+        return 1
+    if cat in ("Mn", "Me", "Cf", "Cc", "Zl", "Zp"):
+        return 0
+    if 0x1160 <= cp <= 0x11FF or cp == 0x200B:
+        return 0
+    if unicodedata.east_asian_width(ch) in ("W", "F"):
+        return 2
+    return 1
+
+
+def widths():
+    w = [classify(cp) for cp in range(MAX_CP)]
+    i = 0
+    while i < MAX_CP:
+        if w[i] is not None:
+            i += 1
+            continue
+        j = i
+        while j < MAX_CP and w[j] is None:
+            j += 1
+        prev = w[i - 1] if i > 0 else 1
+        nxt = w[j] if j < MAX_CP else 1
+        fill = prev if prev == nxt else 1
+        for k in range(i, j):
+            w[k] = 2 if 0x20000 <= k <= 0x3FFFD else fill
+        i = j
+    return w
+
+
+def main():
+    w = widths()
+    blocks = []
+    index = {}
+    stage1 = []
+    for b in range(MAX_CP // BLOCK):
+        packed = bytearray(BLOCK // 4)
+        for i in range(BLOCK):
+            packed[i // 4] |= w[b * BLOCK + i] << ((i % 4) * 2)
+        key = bytes(packed)
+        if key not in index:
+            index[key] = len(blocks)
+            blocks.append(key)
+        stage1.append(index[key])
+    assert len(blocks) <= 256
+
+    out = sys.stdout
+    out.write("/*\n * Copyright 2026 Google LLC\n *\n")
+    out.write(" * Licensed under the Apache License, Version 2.0 (the \"License\");\n")
+    out.write(" * you may not use this file except in compliance with the License.\n")
+    out.write(" * You may obtain a copy of the License at\n *\n")
+    out.write(" *      http://www.apache.org/licenses/LICENSE-2.0\n *\n")
+    out.write(" * Unless required by applicable law or agreed to in writing, software\n")
+    out.write(" * distributed under the License is distributed on an \"AS IS\" BASIS,\n")
+    out.write(" * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n")
+    out.write(" * See the License for the specific language governing permissions and\n")
+    out.write(" * limitations under the License.\n */\n\n")
+    out.write("/*\n * GENERATED by tools/gen_text_width_table.py -- do not edit.\n")
+    out.write(" * Unicode %s, %d stage-2 blocks (%d bytes total).\n */\n\n"
+              % (unicodedata.unidata_version, len(blocks),
+                 len(stage1) + len(blocks) * BLOCK // 4))
+    out.write("#define CEL_CLAY_WIDTH_UNICODE_VERSION \"%s\"\n\n" % unicodedata.unidata_version)
+
+    out.write("static const uint8_t k_width_stage1[%d] = {\n" % len(stage1))
+    for i in range(0, len(stage1), 16):
+        out.write("    " + ", ".join("%3d" % v for v in stage1[i:i + 16]) + ",\n")
+    out.write("};\n\n")
+
+    out.write("static const uint8_t k_width_stage2[%d][%d] = {\n" % (len(blocks), BLOCK // 4))
+    for key in blocks:
+        out.write("    {\n")
+        for i in range(0, len(key), 16):
+            out.write("        " + ", ".join("0x%02x" % v for v in key[i:i + 16]) + ",\n")
+        out.write("    },\n")
+    out.write("};\n")
+
+
+if __name__ == "__main__":
+    main()